@@ -33,7 +33,7 @@ public:
 private:
     AtlasStorage storage;
     std::vector<GlyphBox> layout;
-    std::vector<T> glyphBuffer;
+    std::vector<std::vector<T> > threadScratch;
     GeneratorAttributes attributes;
     int threadCount;
 
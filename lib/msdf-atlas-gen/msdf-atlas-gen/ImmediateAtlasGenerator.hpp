@@ -13,22 +13,21 @@ ImmediateAtlasGenerator<T, N, GEN_FN, AtlasStorage>::ImmediateAtlasGenerator(int
 
 template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
 void ImmediateAtlasGenerator<T, N, GEN_FN, AtlasStorage>::generate(const GlyphGeometry *glyphs, int count) {
-    int maxBoxArea = 0;
-    for (int i = 0; i < count; ++i) {
-        GlyphBox box = glyphs[i];
-        maxBoxArea = std::max(maxBoxArea, box.rect.w*box.rect.h);
-        layout.push_back((GlyphBox &&) box);
-    }
-    int threadBufferSize = N*maxBoxArea;
-    if (threadCount*threadBufferSize > (int) glyphBuffer.size())
-        glyphBuffer.resize(threadCount*threadBufferSize);
+    for (int i = 0; i < count; ++i)
+        layout.push_back((GlyphBox) glyphs[i]);
+    if ((int) threadScratch.size() < threadCount)
+        threadScratch.resize(threadCount);
 
-    Workload([this, &glyphs, threadBufferSize](int i, int threadNo) -> bool {
+    Workload([this, &glyphs](int i, int threadNo) -> bool {
         const GlyphGeometry &glyph = glyphs[i];
         if (!glyph.isWhitespace()) {
             int l, b, w, h;
             glyph.getBoxRect(l, b, w, h);
-            msdfgen::BitmapRef<T, N> glyphBitmap(glyphBuffer.data()+threadNo*threadBufferSize, w, h);
+            // Each thread reuses its own scratch buffer, grown to the largest glyph it has seen
+            std::vector<T> &scratch = threadScratch[threadNo];
+            if ((int) scratch.size() < N*w*h)
+                scratch.resize(N*w*h);
+            msdfgen::BitmapRef<T, N> glyphBitmap(scratch.data(), w, h);
             GEN_FN(glyphBitmap, glyph, attributes);
             storage.put(l, b, msdfgen::BitmapConstRef<T, N>(glyphBitmap));
         }
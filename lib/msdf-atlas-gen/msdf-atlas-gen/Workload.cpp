@@ -1,12 +1,99 @@
 
 #include "Workload.h"
 
+#include <algorithm>
 #include <vector>
 #include <thread>
 #include <atomic>
+#include <mutex>
+#include <condition_variable>
+
+/// Approximate number of batches each thread processes, to balance uneven chunk costs
+#define BATCHES_PER_THREAD 16
 
 namespace msdf_atlas {
 
+namespace {
+
+/// Persistent worker threads shared by all parallel workloads
+class ThreadPool {
+
+public:
+    static ThreadPool & instance();
+    ~ThreadPool();
+    /// Runs job(threadNo) for threadNo in [0, threadCount), with the calling thread as threadNo 0. Returns when all have returned
+    void run(int threadCount, const std::function<void(int)> &job);
+
+private:
+    std::vector<std::thread> threads;
+    std::mutex runMutex;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    const std::function<void(int)> *job = nullptr;
+    int slots = 0;
+    int nextSlot = 0;
+    int active = 0;
+    bool quit = false;
+
+    void workerLoop();
+
+};
+
+ThreadPool & ThreadPool::instance() {
+    static ThreadPool pool;
+    return pool;
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        quit = true;
+    }
+    wake.notify_all();
+    for (std::thread &thread : threads)
+        thread.join();
+}
+
+void ThreadPool::workerLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        wake.wait(lock, [this]() { return quit || nextSlot < slots; });
+        if (quit)
+            return;
+        int threadNo = nextSlot++;
+        const std::function<void(int)> &currentJob = *job;
+        lock.unlock();
+        currentJob(threadNo);
+        lock.lock();
+        if (--active == 0)
+            done.notify_all();
+    }
+}
+
+void ThreadPool::run(int threadCount, const std::function<void(int)> &job) {
+    // One workload at a time; the slots and thread numbers belong to it
+    std::lock_guard<std::mutex> runLock(runMutex);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        while ((int) threads.size() < threadCount-1)
+            threads.emplace_back(&ThreadPool::workerLoop, this);
+        this->job = &job;
+        slots = threadCount;
+        nextSlot = 1;
+        active = threadCount-1;
+    }
+    wake.notify_all();
+    job(0);
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [this]() { return active == 0; });
+    slots = 0;
+    nextSlot = 0;
+    this->job = nullptr;
+}
+
+}
+
 Workload::Workload() : chunks(0) { }
 
 Workload::Workload(const std::function<bool(int, int)> &workerFunction, int chunks) : workerFunction(workerFunction), chunks(chunks) { }
@@ -19,20 +106,23 @@ bool Workload::finishSequential() {
 }
 
 bool Workload::finishParallel(int threadCount) {
-    bool result = true;
+    std::atomic<bool> result(true);
     std::atomic<int> next(0);
-    std::function<void(int)> threadWorker = [this, &result, &next](int threadNo) {
-        for (int i = next++; result && i < chunks; i = next++) {
-            if (!workerFunction(i, threadNo))
-                result = false;
+    int batchSize = std::max(chunks/(threadCount*BATCHES_PER_THREAD), 1);
+    ThreadPool::instance().run(threadCount, [this, &result, &next, batchSize](int threadNo) {
+        while (result) {
+            int start = next.fetch_add(batchSize);
+            if (start >= chunks)
+                return;
+            int end = std::min(start+batchSize, chunks);
+            for (int i = start; i < end; ++i) {
+                if (!workerFunction(i, threadNo)) {
+                    result = false;
+                    return;
+                }
+            }
         }
-    };
-    std::vector<std::thread> threads;
-    threads.reserve(threadCount);
-    for (int i = 0; i < threadCount; ++i)
-        threads.emplace_back(threadWorker, i);
-    for (std::thread &thread : threads)
-        thread.join();
+    });
     return result;
 }
 
@@ -42,7 +132,7 @@ bool Workload::finish(int threadCount) {
     if (threadCount == 1 || chunks == 1)
         return finishSequential();
     if (threadCount > 1)
-        return finishParallel(threadCount);
+        return finishParallel(std::min(threadCount, chunks));
     return false;
 }
 
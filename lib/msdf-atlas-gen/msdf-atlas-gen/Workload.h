@@ -11,6 +11,10 @@ namespace msdf_atlas {
  *     bool FN(int chunk, int threadNo);
  * should process the given chunk (out of chunks) and return true.
  * If false is returned, the process is interrupted.
+ * threadNo is in the range [0, threadCount) and unique among concurrently running calls,
+ * so it may be used to index per-thread scratch memory.
+ * Parallel workloads are executed by a shared pool of threads, which are created on first use
+ * and reused by all subsequent workloads. Chunks are handed out to the threads in small batches.
  */
 class Workload {
 
@@ -79,6 +79,8 @@ DISTANCE FIELD GENERATOR SETTINGS
       Disables the scanline pass, which corrects the distance field's signs according to the non-zero fill rule.
   -seed <N>
       Sets the initial seed for the edge coloring heuristic.
+  -threads <N>
+      Specifies the number of threads for the parallel computation. (0 = auto)
 )";
 
 static char toupper(char c) {
@@ -382,6 +384,14 @@ int main(int argc, const char * const *argv) {
             argPos += 1;
             continue;
         }
+        ARG_CASE("-threads", 1) {
+            unsigned tc;
+            if (!parseUnsigned(tc, argv[argPos+1]) || (int) tc < 0)
+                ABORT("Invalid thread count. Use -threads <N> with N being a non-negative integer.");
+            config.threadCount = (int) tc;
+            argPos += 2;
+            continue;
+        }
         ARG_CASE("-seed", 1) {
             if (!parseUnsignedLL(config.coloringSeed, argv[argPos+1]))
                 ABORT("Invalid seed. Use -seed <N> with N being a non-negative integer.");
@@ -424,6 +434,8 @@ int main(int argc, const char * const *argv) {
         config.miterLimit = 0;
     if (config.emSize > minEmSize)
         minEmSize = config.emSize;
+    if (config.threadCount <= 0)
+        config.threadCount = std::max((int) std::thread::hardware_concurrency(), 1);
     if (!(fixedWidth > 0 && fixedHeight > 0) && !(minEmSize > 0)) {
         puts("Neither atlas size nor glyph size selected, using default...");
         minEmSize = DEFAULT_EM_SIZE;
@@ -565,11 +577,17 @@ int main(int argc, const char * const *argv) {
 
         // Edge coloring
         if (config.imageType == ImageType::MSDF || config.imageType == ImageType::MTSDF) {
+            // Seeds are derived sequentially, so that the result does not depend on the thread count
+            std::vector<unsigned long long> glyphSeeds(glyphs.size());
             unsigned long long glyphSeed = config.coloringSeed;
-            for (GlyphGeometry &glyph : glyphs) {
+            for (unsigned long long &seed : glyphSeeds) {
                 glyphSeed *= MCG_MULTIPLIER;
-                glyph.edgeColoring(config.angleThreshold, glyphSeed);
+                seed = glyphSeed;
             }
+            Workload([&glyphs, &glyphSeeds, &config](int i, int) -> bool {
+                glyphs[i].edgeColoring(config.angleThreshold, glyphSeeds[i]);
+                return true;
+            }, glyphs.size()).finish(config.threadCount);
         }
 
         bool floatingPoint = (
@@ -0,0 +1,247 @@
+
+#include "edge-batch.h"
+
+#include <cmath>
+#include "arithmetics.hpp"
+#include "equation-solver.h"
+
+#define BATCH MSDFGEN_EDGE_BATCH_SIZE
+
+namespace msdfgen {
+
+static void flattenEdge(EdgeBatch::Edge &edge, const EdgeSegment *prev, const EdgeSegment *cur, const EdgeSegment *next) {
+    edge.type = cur->type();
+    edge.segment = cur;
+    edge.prevSegment = prev;
+    edge.nextSegment = next;
+    const Point2 *p = cur->controlPoints();
+    for (int i = 0; i <= edge.type; ++i)
+        edge.p[i] = p[i];
+    edge.dir0 = cur->direction(0);
+    edge.dir1 = cur->direction(1);
+    edge.dir0Dot = dotProduct(edge.dir0, edge.dir0);
+    edge.dir1Dot = dotProduct(edge.dir1, edge.dir1);
+    edge.dir0Normalized = edge.dir0.normalize();
+    edge.dir1Normalized = edge.dir1.normalize();
+    edge.ab = p[1]-p[0];
+    switch (edge.type) {
+        case LinearSegment::EDGE_TYPE:
+            edge.abDot = dotProduct(edge.ab, edge.ab);
+            edge.orthonormal = edge.ab.getOrthonormal(false);
+            break;
+        case QuadraticSegment::EDGE_TYPE:
+            edge.br = p[2]-p[1]-edge.ab;
+            edge.quadA = dotProduct(edge.br, edge.br);
+            edge.quadB = 3*dotProduct(edge.ab, edge.br);
+            edge.quadC = 2*dotProduct(edge.ab, edge.ab);
+            edge.p20 = p[2]-p[0];
+            break;
+        case CubicSegment::EDGE_TYPE:
+            edge.br = p[2]-p[1]-edge.ab;
+            edge.as = (p[3]-p[2])-(p[2]-p[1])-edge.br;
+            edge.ab3 = 3*edge.ab;
+            edge.br6 = 6*edge.br;
+            edge.as3 = 3*edge.as;
+            edge.as6 = 6*edge.as;
+            edge.p20 = p[2]-p[0];
+            edge.p21 = p[2]-p[1];
+            edge.p31 = p[3]-p[1];
+            edge.p32 = p[3]-p[2];
+            break;
+    }
+}
+
+EdgeBatch::EdgeBatch(const Shape &shape) {
+    for (std::vector<Contour>::const_iterator contour = shape.contours.begin(); contour != shape.contours.end(); ++contour) {
+        if (contour->edges.empty())
+            continue;
+        ContourRange range;
+        range.contour = int(contour-shape.contours.begin());
+        range.begin = int(edges.size());
+        // Same visiting order as the scalar generator: starting with the last edge
+        const EdgeSegment *prevEdge = contour->edges.size() >= 2 ? *(contour->edges.end()-2) : *contour->edges.begin();
+        const EdgeSegment *curEdge = contour->edges.back();
+        for (std::vector<EdgeHolder>::const_iterator edge = contour->edges.begin(); edge != contour->edges.end(); ++edge) {
+            const EdgeSegment *nextEdge = *edge;
+            edges.push_back(Edge());
+            flattenEdge(edges.back(), prevEdge, curEdge, nextEdge);
+            prevEdge = curEdge;
+            curEdge = nextEdge;
+        }
+        range.end = int(edges.size());
+        contours.push_back(range);
+    }
+}
+
+void EdgeBatch::signedDistances(const Edge &edge, const double *x, double y, int count, SignedDistance *distances, double *params) const {
+    switch (edge.type) {
+        case LinearSegment::EDGE_TYPE:
+            linearDistances(edge, x, y, count, distances, params);
+            break;
+        case QuadraticSegment::EDGE_TYPE:
+            quadraticDistances(edge, x, y, count, distances, params);
+            break;
+        case CubicSegment::EDGE_TYPE:
+            cubicDistances(edge, x, y, count, distances, params);
+            break;
+    }
+}
+
+/// Equivalent of Vector2::normalize, inlined
+static inline void normalize(double &x, double &y) {
+    double len = sqrt(x*x+y*y);
+    if (len == 0)
+        x = 0, y = 1;
+    else
+        x = x/len, y = y/len;
+}
+
+/// Final alignment term shared by the curve evaluators. q is the vector from the point to the start of the curve, e from the point to its end
+static inline SignedDistance endpointAlignment(const EdgeBatch::Edge &edge, double minDistance, double param, double qx, double qy, double ex, double ey) {
+    if (param >= 0 && param <= 1)
+        return SignedDistance(minDistance, 0);
+    if (param < .5) {
+        normalize(qx, qy);
+        return SignedDistance(minDistance, fabs(edge.dir0Normalized.x*qx+edge.dir0Normalized.y*qy));
+    } else {
+        normalize(ex, ey);
+        return SignedDistance(minDistance, fabs(edge.dir1Normalized.x*ex+edge.dir1Normalized.y*ey));
+    }
+}
+
+void EdgeBatch::linearDistances(const Edge &edge, const double *x, double y, int count, SignedDistance *distances, double *params) {
+    const Point2 &p0 = edge.p[0], &p1 = edge.p[1];
+    const Vector2 &ab = edge.ab;
+    double aqx[BATCH], aqy[BATCH], param[BATCH], eqx[BATCH], eqy[BATCH], endpointDistance[BATCH], orthoDistance[BATCH];
+    for (int i = 0; i < BATCH; ++i) {
+        aqx[i] = x[i]-p0.x;
+        aqy[i] = y-p0.y;
+        param[i] = (aqx[i]*ab.x+aqy[i]*ab.y)/edge.abDot;
+        bool far = param[i] > .5;
+        eqx[i] = (far ? p1.x : p0.x)-x[i];
+        eqy[i] = (far ? p1.y : p0.y)-y;
+        endpointDistance[i] = sqrt(eqx[i]*eqx[i]+eqy[i]*eqy[i]);
+        orthoDistance[i] = edge.orthonormal.x*aqx[i]+edge.orthonormal.y*aqy[i];
+    }
+    for (int i = 0; i < count; ++i) {
+        params[i] = param[i];
+        if (param[i] > 0 && param[i] < 1 && fabs(orthoDistance[i]) < endpointDistance[i]) {
+            distances[i] = SignedDistance(orthoDistance[i], 0);
+            continue;
+        }
+        double nx = eqx[i], ny = eqy[i];
+        normalize(nx, ny);
+        distances[i] = SignedDistance(nonZeroSign(aqx[i]*ab.y-aqy[i]*ab.x)*endpointDistance[i], fabs(edge.dir0Normalized.x*nx+edge.dir0Normalized.y*ny));
+    }
+}
+
+void EdgeBatch::quadraticDistances(const Edge &edge, const double *x, double y, int count, SignedDistance *distances, double *params) {
+    const Point2 &p0 = edge.p[0], &p1 = edge.p[1], &p2 = edge.p[2];
+    const Vector2 &ab = edge.ab, &br = edge.br, &dir0 = edge.dir0, &dir1 = edge.dir1;
+    for (int i = 0; i < count; ++i) {
+        double qax = p0.x-x[i], qay = p0.y-y;
+        double t[3];
+        int solutions = solveCubic(t, edge.quadA, edge.quadB, edge.quadC+(qax*br.x+qay*br.y), qax*ab.x+qay*ab.y);
+
+        double minDistance = nonZeroSign(dir0.x*qay-dir0.y*qax)*sqrt(qax*qax+qay*qay); // distance from A
+        double param = -(qax*dir0.x+qay*dir0.y)/edge.dir0Dot;
+        double ebx = p2.x-x[i], eby = p2.y-y;
+        {
+            double distance = nonZeroSign(dir1.x*eby-dir1.y*ebx)*sqrt(ebx*ebx+eby*eby); // distance from B
+            if (fabs(distance) < fabs(minDistance)) {
+                minDistance = distance;
+                param = ((x[i]-p1.x)*dir1.x+(y-p1.y)*dir1.y)/edge.dir1Dot;
+            }
+        }
+        for (int j = 0; j < solutions; ++j) {
+            if (t[j] > 0 && t[j] < 1) {
+                double qex = p0.x+(2*t[j])*ab.x+(t[j]*t[j])*br.x-x[i];
+                double qey = p0.y+(2*t[j])*ab.y+(t[j]*t[j])*br.y-y;
+                double distance = nonZeroSign(edge.p20.x*qey-edge.p20.y*qex)*sqrt(qex*qex+qey*qey);
+                if (fabs(distance) <= fabs(minDistance)) {
+                    minDistance = distance;
+                    param = t[j];
+                }
+            }
+        }
+        params[i] = param;
+        distances[i] = endpointAlignment(edge, minDistance, param, qax, qay, ebx, eby);
+    }
+}
+
+void EdgeBatch::cubicDistances(const Edge &edge, const double *x, double y, int count, SignedDistance *distances, double *params) {
+    const Point2 &p0 = edge.p[0], &p3 = edge.p[3];
+    const Vector2 &ab = edge.ab, &br = edge.br, &as = edge.as, &dir0 = edge.dir0, &dir1 = edge.dir1;
+    double qax[BATCH], qay[BATCH], ebx[BATCH], eby[BATCH], minDistance[BATCH], param[BATCH];
+
+    // Distances from the endpoints
+    for (int i = 0; i < BATCH; ++i) {
+        qax[i] = p0.x-x[i];
+        qay[i] = p0.y-y;
+        ebx[i] = p3.x-x[i];
+        eby[i] = p3.y-y;
+        double distanceA = nonZeroSign(dir0.x*qay[i]-dir0.y*qax[i])*sqrt(qax[i]*qax[i]+qay[i]*qay[i]);
+        double distanceB = nonZeroSign(dir1.x*eby[i]-dir1.y*ebx[i])*sqrt(ebx[i]*ebx[i]+eby[i]*eby[i]);
+        double paramA = -(qax[i]*dir0.x+qay[i]*dir0.y)/edge.dir0Dot;
+        double paramB = ((dir1.x-ebx[i])*dir1.x+(dir1.y-eby[i])*dir1.y)/edge.dir1Dot;
+        bool closerToB = fabs(distanceB) < fabs(distanceA);
+        minDistance[i] = closerToB ? distanceB : distanceA;
+        param[i] = closerToB ? paramB : paramA;
+    }
+
+    // Iterative minimum distance search. Points whose parameter leaves the curve stop iterating,
+    // which is tracked per point with the active flags
+    for (int start = 0; start <= MSDFGEN_CUBIC_SEARCH_STARTS; ++start) {
+        double t[BATCH];
+        bool active[BATCH];
+        for (int i = 0; i < BATCH; ++i) {
+            t[i] = (double) start/MSDFGEN_CUBIC_SEARCH_STARTS;
+            active[i] = i < count;
+        }
+        for (int step = 0;; ++step) {
+            double qex[BATCH], qey[BATCH];
+            for (int i = 0; i < BATCH; ++i) {
+                double ti = t[i];
+                qex[i] = p0.x+(3*ti)*ab.x+(3*ti*ti)*br.x+(ti*ti*ti)*as.x-x[i]; // do not simplify with qa !!!
+                qey[i] = p0.y+(3*ti)*ab.y+(3*ti*ti)*br.y+(ti*ti*ti)*as.y-y;
+                // direction(t)
+                double mx = (1-ti)*((1-ti)*ab.x+ti*edge.p21.x)+ti*((1-ti)*edge.p21.x+ti*edge.p32.x);
+                double my = (1-ti)*((1-ti)*ab.y+ti*edge.p21.y)+ti*((1-ti)*edge.p21.y+ti*edge.p32.y);
+                if (!mx && !my) {
+                    if (ti == 0)
+                        mx = edge.p20.x, my = edge.p20.y;
+                    else if (ti == 1)
+                        mx = edge.p31.x, my = edge.p31.y;
+                }
+                double distance = nonZeroSign(mx*qey[i]-my*qex[i])*sqrt(qex[i]*qex[i]+qey[i]*qey[i]);
+                bool closer = active[i] && fabs(distance) < fabs(minDistance[i]);
+                minDistance[i] = closer ? distance : minDistance[i];
+                param[i] = closer ? ti : param[i];
+            }
+            if (step == MSDFGEN_CUBIC_SEARCH_STEPS)
+                break;
+            // Improve t
+            bool anyActive = false;
+            for (int i = 0; i < BATCH; ++i) {
+                double ti = t[i];
+                double d1x = edge.as3.x*ti*ti+edge.br6.x*ti+edge.ab3.x;
+                double d1y = edge.as3.y*ti*ti+edge.br6.y*ti+edge.ab3.y;
+                double d2x = edge.as6.x*ti+edge.br6.x;
+                double d2y = edge.as6.y*ti+edge.br6.y;
+                ti -= (qex[i]*d1x+qey[i]*d1y)/((d1x*d1x+d1y*d1y)+(qex[i]*d2x+qey[i]*d2y));
+                t[i] = ti;
+                active[i] = active[i] && !(ti < 0 || ti > 1);
+                anyActive |= active[i];
+            }
+            if (!anyActive)
+                break;
+        }
+    }
+
+    for (int i = 0; i < count; ++i) {
+        params[i] = param[i];
+        distances[i] = endpointAlignment(edge, minDistance[i], param[i], qax[i], qay[i], ebx[i], eby[i]);
+    }
+}
+
+}
@@ -0,0 +1,69 @@
+
+#pragma once
+
+#include <vector>
+#include "Vector2.h"
+#include "SignedDistance.h"
+#include "edge-segments.h"
+#include "Shape.h"
+
+/// Number of points on a scanline whose distances to an edge are evaluated together.
+#define MSDFGEN_EDGE_BATCH_SIZE 8
+
+namespace msdfgen {
+
+/**
+ * A shape's edges, flattened into a plain array in the order in which the distance field generator visits them,
+ * together with all per-edge values that EdgeSegment::signedDistance would otherwise recompute for every pixel.
+ * Distances are evaluated for a batch of up to MSDFGEN_EDGE_BATCH_SIZE points on one scanline at a time,
+ * without virtual calls. The inner loops run across the batch with per-point data in separate arrays,
+ * so that the compiler can vectorize them, and perform the same floating-point operations in the same order
+ * as the scalar path, producing identical results.
+ */
+class EdgeBatch {
+
+public:
+    /// A flattened edge segment.
+    struct Edge {
+        int type;
+        /// The original segments, for the edge selectors
+        const EdgeSegment *segment, *prevSegment, *nextSegment;
+        /// Control points
+        Point2 p[4];
+        /// Endpoint directions, their squared lengths and normalized forms
+        Vector2 dir0, dir1;
+        double dir0Dot, dir1Dot;
+        Vector2 dir0Normalized, dir1Normalized;
+        /// Polynomial coefficients (in the same form as the scalar evaluators)
+        Vector2 ab, br, as;
+        Vector2 ab3, br6, as3, as6;
+        /// Linear: squared length and unit normal. Quadratic: cubic equation coefficients
+        double abDot;
+        Vector2 orthonormal;
+        double quadA, quadB, quadC;
+        /// Chords used by the quadratic / cubic evaluators
+        Vector2 p20, p21, p31, p32;
+    };
+
+    /// A contour's range of edges.
+    struct ContourRange {
+        int contour;
+        int begin, end;
+    };
+
+    explicit EdgeBatch(const Shape &shape);
+    /// Computes the signed distances and parameters between a given edge and count points (x[i], y)
+    void signedDistances(const Edge &edge, const double *x, double y, int count, SignedDistance *distances, double *params) const;
+
+    std::vector<Edge> edges;
+    /// Non-empty contours, in shape order
+    std::vector<ContourRange> contours;
+
+private:
+    static void linearDistances(const Edge &edge, const double *x, double y, int count, SignedDistance *distances, double *params);
+    static void quadraticDistances(const Edge &edge, const double *x, double y, int count, SignedDistance *distances, double *params);
+    static void cubicDistances(const Edge &edge, const double *x, double y, int count, SignedDistance *distances, double *params);
+
+};
+
+}
@@ -21,6 +21,10 @@ public:
     virtual ~EdgeSegment() { }
     /// Creates a copy of the edge segment.
     virtual EdgeSegment * clone() const = 0;
+    /// Returns the numeric code of the edge segment's type (its EDGE_TYPE).
+    virtual int type() const = 0;
+    /// Returns the array of control points, of length type()+1.
+    virtual const Point2 * controlPoints() const = 0;
     /// Returns the point on the edge specified by the parameter (between 0 and 1).
     virtual Point2 point(double param) const = 0;
     /// Returns the direction the edge has at the point specified by the parameter.
@@ -47,10 +51,14 @@ public:
 class LinearSegment : public EdgeSegment {
 
 public:
+    static const int EDGE_TYPE = 1;
+
     Point2 p[2];
 
     LinearSegment(Point2 p0, Point2 p1, EdgeColor edgeColor = WHITE);
     LinearSegment * clone() const;
+    int type() const;
+    const Point2 * controlPoints() const;
     Point2 point(double param) const;
     Vector2 direction(double param) const;
     SignedDistance signedDistance(Point2 origin, double &param) const;
@@ -67,10 +75,14 @@ public:
 class QuadraticSegment : public EdgeSegment {
 
 public:
+    static const int EDGE_TYPE = 2;
+
     Point2 p[3];
 
     QuadraticSegment(Point2 p0, Point2 p1, Point2 p2, EdgeColor edgeColor = WHITE);
     QuadraticSegment * clone() const;
+    int type() const;
+    const Point2 * controlPoints() const;
     Point2 point(double param) const;
     Vector2 direction(double param) const;
     SignedDistance signedDistance(Point2 origin, double &param) const;
@@ -87,10 +99,14 @@ public:
 class CubicSegment : public EdgeSegment {
 
 public:
+    static const int EDGE_TYPE = 3;
+
     Point2 p[4];
 
     CubicSegment(Point2 p0, Point2 p1, Point2 p2, Point2 p3, EdgeColor edgeColor = WHITE);
     CubicSegment * clone() const;
+    int type() const;
+    const Point2 * controlPoints() const;
     Point2 point(double param) const;
     Vector2 direction(double param) const;
     SignedDistance signedDistance(Point2 origin, double &param) const;
@@ -8,6 +8,10 @@ TrueDistanceSelector::TrueDistanceSelector(const Point2 &p) : p(p) { }
 void TrueDistanceSelector::addEdge(const EdgeSegment *prevEdge, const EdgeSegment *edge, const EdgeSegment *nextEdge) {
     double dummy;
     SignedDistance distance = edge->signedDistance(p, dummy);
+    addEdge(prevEdge, edge, nextEdge, distance, dummy);
+}
+
+void TrueDistanceSelector::addEdge(const EdgeSegment *prevEdge, const EdgeSegment *edge, const EdgeSegment *nextEdge, SignedDistance distance, double param) {
     if (distance < minDistance)
         minDistance = distance;
 }
@@ -85,6 +89,10 @@ PseudoDistanceSelector::PseudoDistanceSelector(const Point2 &p) : p(p) { }
 void PseudoDistanceSelector::addEdge(const EdgeSegment *prevEdge, const EdgeSegment *edge, const EdgeSegment *nextEdge) {
     double param;
     SignedDistance distance = edge->signedDistance(p, param);
+    addEdge(prevEdge, edge, nextEdge, distance, param);
+}
+
+void PseudoDistanceSelector::addEdge(const EdgeSegment *prevEdge, const EdgeSegment *edge, const EdgeSegment *nextEdge, SignedDistance distance, double param) {
     addEdgeTrueDistance(edge, distance, param);
     if (pointFacingEdge(prevEdge, edge, nextEdge, p, param)) {
         edge->distanceToPseudoDistance(distance, p, param);
@@ -101,6 +109,10 @@ MultiDistanceSelector::MultiDistanceSelector(const Point2 &p) : p(p) { }
 void MultiDistanceSelector::addEdge(const EdgeSegment *prevEdge, const EdgeSegment *edge, const EdgeSegment *nextEdge) {
     double param;
     SignedDistance distance = edge->signedDistance(p, param);
+    addEdge(prevEdge, edge, nextEdge, distance, param);
+}
+
+void MultiDistanceSelector::addEdge(const EdgeSegment *prevEdge, const EdgeSegment *edge, const EdgeSegment *nextEdge, SignedDistance distance, double param) {
     if (edge->color&RED)
         r.addEdgeTrueDistance(edge, distance, param);
     if (edge->color&GREEN)
@@ -22,6 +22,8 @@ public:
 
     explicit TrueDistanceSelector(const Point2 &p = Point2());
     void addEdge(const EdgeSegment *prevEdge, const EdgeSegment *edge, const EdgeSegment *nextEdge);
+    /// Adds an edge whose signed distance and parameter have already been computed for the selector's point.
+    void addEdge(const EdgeSegment *prevEdge, const EdgeSegment *edge, const EdgeSegment *nextEdge, SignedDistance distance, double param);
     void merge(const TrueDistanceSelector &other);
     DistanceType distance() const;
 
@@ -60,6 +62,8 @@ public:
 
     explicit PseudoDistanceSelector(const Point2 &p = Point2());
     void addEdge(const EdgeSegment *prevEdge, const EdgeSegment *edge, const EdgeSegment *nextEdge);
+    /// Adds an edge whose signed distance and parameter have already been computed for the selector's point.
+    void addEdge(const EdgeSegment *prevEdge, const EdgeSegment *edge, const EdgeSegment *nextEdge, SignedDistance distance, double param);
     DistanceType distance() const;
 
 private:
@@ -75,6 +79,8 @@ public:
 
     explicit MultiDistanceSelector(const Point2 &p = Point2());
     void addEdge(const EdgeSegment *prevEdge, const EdgeSegment *edge, const EdgeSegment *nextEdge);
+    /// Adds an edge whose signed distance and parameter have already been computed for the selector's point.
+    void addEdge(const EdgeSegment *prevEdge, const EdgeSegment *edge, const EdgeSegment *nextEdge, SignedDistance distance, double param);
     void merge(const MultiDistanceSelector &other);
     DistanceType distance() const;
     SignedDistance trueDistance() const;
@@ -4,6 +4,7 @@
 #include <vector>
 #include "edge-selectors.h"
 #include "contour-combiners.h"
+#include "edge-batch.h"
 
 namespace msdfgen {
 
@@ -42,6 +43,8 @@ public:
     }
 };
 
+#ifdef MSDFGEN_NO_EDGE_BATCH
+
 template <class ContourCombiner>
 void generateDistanceField(const typename DistancePixelConversion<typename ContourCombiner::DistanceType>::BitmapRefType &output, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate) {
 #ifdef MSDFGEN_USE_OPENMP
@@ -85,6 +88,60 @@ void generateDistanceField(const typename DistancePixelConversion<typename Conto
     }
 }
 
+#else
+
+template <class ContourCombiner>
+void generateDistanceField(const typename DistancePixelConversion<typename ContourCombiner::DistanceType>::BitmapRefType &output, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate) {
+    typedef typename ContourCombiner::EdgeSelectorType EdgeSelector;
+    // Flattened once per shape, shared by all threads
+    EdgeBatch batch(shape);
+#ifdef MSDFGEN_USE_OPENMP
+    #pragma omp parallel
+#endif
+    {
+        std::vector<ContourCombiner> contourCombiners(MSDFGEN_EDGE_BATCH_SIZE, ContourCombiner(shape));
+        EdgeSelector edgeSelectors[MSDFGEN_EDGE_BATCH_SIZE];
+        double px[MSDFGEN_EDGE_BATCH_SIZE];
+        SignedDistance distances[MSDFGEN_EDGE_BATCH_SIZE];
+        double params[MSDFGEN_EDGE_BATCH_SIZE];
+#ifdef MSDFGEN_USE_OPENMP
+        #pragma omp for
+#endif
+        for (int y = 0; y < output.height; ++y) {
+            int row = shape.inverseYAxis ? output.height-y-1 : y;
+            double py = (y+.5)/scale.y-translate.y;
+            for (int x0 = 0; x0 < output.width; x0 += MSDFGEN_EDGE_BATCH_SIZE) {
+                int count = output.width-x0 < MSDFGEN_EDGE_BATCH_SIZE ? output.width-x0 : MSDFGEN_EDGE_BATCH_SIZE;
+                // Unused lanes repeat the last pixel, so that they still hold valid coordinates
+                for (int i = 0; i < MSDFGEN_EDGE_BATCH_SIZE; ++i)
+                    px[i] = (x0+(i < count ? i : count-1)+.5)/scale.x-translate.x;
+                for (int i = 0; i < count; ++i)
+                    contourCombiners[i].reset(Point2(px[i], py));
+
+                for (std::vector<EdgeBatch::ContourRange>::const_iterator contour = batch.contours.begin(); contour != batch.contours.end(); ++contour) {
+                    for (int i = 0; i < count; ++i)
+                        edgeSelectors[i] = EdgeSelector(Point2(px[i], py));
+                    for (int e = contour->begin; e < contour->end; ++e) {
+                        const EdgeBatch::Edge &edge = batch.edges[e];
+                        batch.signedDistances(edge, px, py, count, distances, params);
+                        for (int i = 0; i < count; ++i)
+                            edgeSelectors[i].addEdge(edge.prevSegment, edge.segment, edge.nextSegment, distances[i], params[i]);
+                    }
+                    for (int i = 0; i < count; ++i)
+                        contourCombiners[i].setContourEdgeSelection(contour->contour, edgeSelectors[i]);
+                }
+
+                for (int i = 0; i < count; ++i) {
+                    typename ContourCombiner::DistanceType distance = contourCombiners[i].distance();
+                    DistancePixelConversion<typename ContourCombiner::DistanceType>::convert(output(x0+i, row), distance, range);
+                }
+            }
+        }
+    }
+}
+
+#endif
+
 void generateSDF(const BitmapRef<float, 1> &output, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, bool overlapSupport) {
     if (overlapSupport)
         generateDistanceField<OverlappingContourCombiner<TrueDistanceSelector> >(output, shape, range, scale, translate);
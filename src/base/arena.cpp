@@ -0,0 +1,77 @@
+#include "base/arena.hpp"
+
+#include <algorithm>
+#include "base/log.hpp"
+
+namespace minote {
+
+// Round up offset to a multiple of align, which must be a power of 2.
+static auto alignUp(size_t const offset, size_t const align) -> size_t
+{
+	return (offset + align - 1) & ~(align - 1);
+}
+
+Arena::Arena(char const* const _name, size_t const size): name{_name}
+{
+	addBlock(size);
+}
+
+auto Arena::allocate(size_t const size, size_t const align) -> void*
+{
+	ASSERT(align && !(align & (align - 1)));
+	ASSERT(align <= __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+
+	auto start = alignUp(offset, align);
+	if (start + size > blocks.back().size) {
+		addBlock(std::max(size, blocks.back().size * 2));
+		start = 0; // Blocks start at the default new alignment
+	}
+	offset = start + size;
+	return blocks.back().data.get() + start;
+}
+
+auto Arena::extend(void* const ptr, size_t const oldSize, size_t const newSize) -> bool
+{
+	auto& block = blocks.back();
+	auto* const bytes = static_cast<std::byte*>(ptr);
+	if (bytes + oldSize != block.data.get() + offset) return false;
+
+	auto const start = size_t(bytes - block.data.get());
+	if (start + newSize > block.size) return false;
+	offset = start + newSize;
+	return true;
+}
+
+void Arena::reset()
+{
+	highWater = std::max(highWater, used());
+	if (blocks.size() > 1) {
+		auto const size = capacity();
+		blocks.clear();
+		addBlock(size);
+		L.debug(R"(Arena "{}" resized to {} KiB, high-water mark {} KiB)"_fmt,
+			name, size / 1024, highWater / 1024);
+	}
+	offset = 0;
+	retired = 0;
+}
+
+auto Arena::capacity() const -> size_t
+{
+	size_t total = 0;
+	for (auto const& block: blocks)
+		total += block.size;
+	return total;
+}
+
+void Arena::addBlock(size_t const size)
+{
+	if (!blocks.empty())
+		retired += offset;
+	blocks.push_back({
+		.data = std::make_unique_for_overwrite<std::byte[]>(size),
+		.size = size});
+	offset = 0;
+}
+
+}
@@ -0,0 +1,175 @@
+// Minote - base/arena.hpp
+// Linear allocator for transient data, such as everything that only lives
+// until the end of a frame. Allocation bumps an offset within a block, and
+// everything is freed at once with reset(). When a block runs out, another one
+// is chained after it. On the next reset() all blocks are merged into one
+// that fits the high-water mark, so that a steady workload stops allocating.
+// Not thread-safe.
+
+#pragma once
+
+#include <type_traits>
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <new>
+#include "base/array.hpp"
+#include "base/util.hpp"
+
+namespace minote {
+
+// Size of the first block of an Arena
+constexpr size_t ArenaDefaultSize = 64 * 1024;
+
+struct Arena {
+
+	// Name shown in log messages
+	char const* name;
+
+	// Create an arena with an initial block of the given size in bytes.
+	explicit Arena(char const* name, size_t size = ArenaDefaultSize);
+
+	// Return memory for size bytes at the given alignment, valid until
+	// the next reset().
+	[[nodiscard]]
+	auto allocate(size_t size, size_t align) -> void*;
+
+	// Grow the most recent allocation in place, if it has room. Returns
+	// false if the allocation must be moved instead.
+	auto extend(void* ptr, size_t oldSize, size_t newSize) -> bool;
+
+	// Free all allocations at once. If more than one block was used,
+	// the blocks are replaced with one that fits all of them.
+	void reset();
+
+	// Number of bytes allocated since the last reset().
+	[[nodiscard]]
+	auto used() const -> size_t { return retired + offset; }
+
+	// Highest used() ever seen.
+	[[nodiscard]]
+	auto peak() const -> size_t { return std::max(highWater, used()); }
+
+	// Total size of all blocks.
+	[[nodiscard]]
+	auto capacity() const -> size_t;
+
+	// Not copyable, not movable
+	Arena(Arena const&) = delete;
+	auto operator=(Arena const&) -> Arena& = delete;
+
+private:
+
+	struct Block {
+
+		std::unique_ptr<std::byte[]> data;
+		size_t size;
+
+	};
+
+	// Blocks in use. Allocations are made from the last one
+	vector<Block> blocks;
+
+	// Bytes used in the last block
+	size_t offset = 0;
+
+	// Bytes used in all blocks before the last
+	size_t retired = 0;
+
+	size_t highWater = 0;
+
+	// Chain a new block that can fit at least size bytes.
+	void addBlock(size_t size);
+
+};
+
+// Vector whose storage is allocated from an Arena. Growing either extends
+// the storage in place or moves it to a new allocation; the old one is only
+// freed with the arena. Elements are never destroyed, so they must be trivial
+// types. The contents are invalid after the arena's reset().
+template<typename T>
+struct ArenaVector {
+
+	static_assert(std::is_trivially_copyable_v<T> && std::is_trivially_destructible_v<T>,
+		"ArenaVector elements are copied with memcpy and never destroyed");
+
+	using value_type = T;
+	using size_type = size_t;
+	using iterator = T*;
+	using const_iterator = T const*;
+
+	// Create an empty vector. It must be assigned one created from an arena
+	// before use.
+	ArenaVector() = default;
+
+	// Create an empty vector allocating from the given arena, with room
+	// for the given number of elements.
+	explicit ArenaVector(Arena& _arena, size_t const _capacity = 0): arena{&_arena} {
+		if (_capacity) reserve(_capacity);
+	}
+
+	[[nodiscard]] auto size() const -> size_t { return length; }
+	[[nodiscard]] auto empty() const -> bool { return length == 0; }
+	[[nodiscard]] auto capacity() const -> size_t { return maxLength; }
+
+	auto data() -> T* { return elements; }
+	auto data() const -> T const* { return elements; }
+	auto begin() -> T* { return elements; }
+	auto begin() const -> T const* { return elements; }
+	auto end() -> T* { return elements + length; }
+	auto end() const -> T const* { return elements + length; }
+
+	auto operator[](size_t const i) -> T& { return elements[i]; }
+	auto operator[](size_t const i) const -> T const& { return elements[i]; }
+	auto back() -> T& { return elements[length - 1]; }
+	auto back() const -> T const& { return elements[length - 1]; }
+
+	// Construct a new element at the end.
+	template<typename... Args>
+	auto emplace_back(Args&&... args) -> T& {
+		if (length == maxLength)
+			reserve(std::max<size_t>(maxLength * 2, 16));
+		auto* const element = new (elements + length) T(std::forward<Args>(args)...);
+		length += 1;
+		return *element;
+	}
+
+	void push_back(T const& value) { emplace_back(value); }
+
+	void pop_back() { length -= 1; }
+
+	// Remove all elements. The storage is kept for reuse.
+	void clear() { length = 0; }
+
+	// Change the number of elements. New elements are value-initialized.
+	void resize(size_t const newLength) {
+		reserve(newLength);
+		for (size_t i = length; i < newLength; i += 1)
+			new (elements + i) T();
+		length = newLength;
+	}
+
+	// Ensure room for at least the given number of elements.
+	void reserve(size_t const newCapacity) {
+		ASSERT(arena);
+		if (newCapacity <= maxLength) return;
+
+		if (!elements || !arena->extend(elements, maxLength * sizeof(T), newCapacity * sizeof(T))) {
+			auto* const newElements = static_cast<T*>(arena->allocate(newCapacity * sizeof(T), alignof(T)));
+			if (length)
+				std::memcpy(newElements, elements, length * sizeof(T));
+			elements = newElements;
+		}
+		maxLength = newCapacity;
+	}
+
+private:
+
+	Arena* arena = nullptr;
+	T* elements = nullptr;
+	size_t length = 0;
+	size_t maxLength = 0;
+
+};
+
+}
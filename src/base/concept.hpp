@@ -28,4 +28,7 @@ using std::copy_constructible;
 // An instance can be constructed with zero arguments
 using std::default_initializable;
 
+// Can be copied, default-constructed and compared for equality, like a plain value
+using std::regular;
+
 }
@@ -240,7 +240,7 @@ constexpr auto elasticEaseInOut(T const p) -> T {
 // Modeled after the overshooting cubic y = x^3-x*sin(x*pi)
 template<floating_point T>
 [[maybe_unused]]
-constexpr auto eackEaseIn(T const p) -> T {
+constexpr auto backEaseIn(T const p) -> T {
 	return p * p * p - p * sin(p * Tau_v<T> / 2);
 }
 
@@ -267,12 +267,6 @@ constexpr auto backEaseInOut(T const p) -> T {
 	}
 }
 
-template<floating_point T>
-[[maybe_unused]]
-constexpr auto bounceEaseIn(T const p) -> T {
-	return 1 - bounceEaseOut(1 - p);
-}
-
 template<floating_point T>
 [[maybe_unused]]
 constexpr auto bounceEaseOut(T const p) -> T {
@@ -286,6 +280,12 @@ constexpr auto bounceEaseOut(T const p) -> T {
 		return (54 / 5.0 * p * p) - (513 / 25.0 * p) + 268 / 25.0;
 }
 
+template<floating_point T>
+[[maybe_unused]]
+constexpr auto bounceEaseIn(T const p) -> T {
+	return 1 - bounceEaseOut(1 - p);
+}
+
 template<floating_point T>
 [[maybe_unused]]
 constexpr auto bounceEaseInOut(T const p) -> T {
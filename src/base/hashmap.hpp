@@ -10,4 +10,7 @@ namespace minote {
 template<typename Key, typename T>
 using hashmap = robin_hood::unordered_flat_map<Key, T>;
 
+template<typename Key>
+using hashset = robin_hood::unordered_flat_set<Key>;
+
 }
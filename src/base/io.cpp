@@ -2,6 +2,16 @@
 
 #include <system_error>
 #include <cstdio>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else //_WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif //_WIN32
 #include "base/util.hpp"
 
 namespace minote {
@@ -57,4 +67,106 @@ auto file::operator=(file&& other) noexcept -> file& {
 
 }
 
+void mapped_file::open(path const& path) {
+	if (map) close();
+
+	pathStr = path.string();
+
+#ifdef _WIN32
+	HANDLE const handle = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+		OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (handle == INVALID_HANDLE_VALUE)
+		throw system_error{static_cast<int>(GetLastError()), std::system_category(),
+		                   format(R"(Failed to open "{}")", pathStr)};
+	defer { CloseHandle(handle); };
+
+	LARGE_INTEGER size = {};
+	if (!GetFileSizeEx(handle, &size))
+		throw system_error{static_cast<int>(GetLastError()), std::system_category(),
+		                   format(R"(Failed to query size of "{}")", pathStr)};
+	if (size.QuadPart == 0)
+		throw system_error{EINVAL, std::generic_category(),
+		                   format(R"(Failed to map "{}": file is empty)", pathStr)};
+
+	mapping = CreateFileMappingW(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!mapping)
+		throw system_error{static_cast<int>(GetLastError()), std::system_category(),
+		                   format(R"(Failed to map "{}")", pathStr)};
+	map = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (!map) {
+		auto const err = GetLastError();
+		CloseHandle(mapping);
+		mapping = nullptr;
+		throw system_error{static_cast<int>(err), std::system_category(),
+		                   format(R"(Failed to map "{}")", pathStr)};
+	}
+	length = size.QuadPart;
+#else //_WIN32
+	int const fd = ::open(pathStr.c_str(), O_RDONLY);
+	if (fd == -1)
+		throw system_error{errno, std::generic_category(),
+		                   format(R"(Failed to open "{}")", pathStr)};
+	defer { ::close(fd); };
+
+	struct stat info = {};
+	if (fstat(fd, &info) == -1)
+		throw system_error{errno, std::generic_category(),
+		                   format(R"(Failed to query size of "{}")", pathStr)};
+	if (info.st_size == 0)
+		throw system_error{EINVAL, std::generic_category(),
+		                   format(R"(Failed to map "{}": file is empty)", pathStr)};
+
+	void* const result = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	if (result == MAP_FAILED)
+		throw system_error{errno, std::generic_category(),
+		                   format(R"(Failed to map "{}")", pathStr)};
+	map = result;
+	length = info.st_size;
+#endif //_WIN32
+}
+
+void mapped_file::close() noexcept {
+	if (!map) return;
+
+#ifdef _WIN32
+	UnmapViewOfFile(map);
+	CloseHandle(mapping);
+	mapping = nullptr;
+#else //_WIN32
+	munmap(const_cast<void*>(map), length);
+#endif //_WIN32
+	map = nullptr;
+	length = 0;
+}
+
+mapped_file::mapped_file(mapped_file&& other) noexcept:
+	map{other.map}, length{other.length}, pathStr{move(other.pathStr)} {
+
+#ifdef _WIN32
+	mapping = other.mapping;
+	other.mapping = nullptr;
+#endif //_WIN32
+	other.map = nullptr;
+	other.length = 0;
+
+}
+
+auto mapped_file::operator=(mapped_file&& other) noexcept -> mapped_file& {
+
+	close();
+
+	map = other.map;
+	length = other.length;
+	pathStr = move(other.pathStr);
+#ifdef _WIN32
+	mapping = other.mapping;
+	other.mapping = nullptr;
+#endif //_WIN32
+	other.map = nullptr;
+	other.length = 0;
+
+	return *this;
+
+}
+
 }
@@ -8,6 +8,8 @@
 #include <cstdio>
 #include <fmt/format.h>
 #include "base/string.hpp"
+#include "base/array.hpp"
+#include "base/util.hpp"
 
 namespace minote {
 
@@ -48,7 +50,7 @@ struct file {
 
 	// True if currently attached to a file.
 	[[nodiscard]]
-	auto isOpen() const { return handle == nullptr; }
+	auto isOpen() const { return handle != nullptr; }
 
 	// Resolved path of the file.
 	[[nodiscard]]
@@ -74,6 +76,58 @@ private:
 
 };
 
+// Read-only memory mapping of an entire file. Pages are loaded by the OS on first access,
+// so no time is spent reading parts of the file that are never touched. Throws system_error
+// on errors.
+struct mapped_file {
+
+	// Create a null object, with no file mapped.
+	mapped_file() noexcept = default;
+
+	// Create the object with an immediately mapped file.
+	explicit mapped_file(path const& path) { open(path); }
+
+	// Unmap the file if mapped.
+	~mapped_file() noexcept { close(); }
+
+	// Map the file at a given path. Any previous mapping is closed. Empty files cannot
+	// be mapped.
+	void open(path const&);
+
+	// Unmap the file if mapped. All pointers into the mapping become invalid.
+	void close() noexcept;
+
+	// True if currently mapping a file.
+	[[nodiscard]]
+	auto isOpen() const { return map != nullptr; }
+
+	// Contents of the mapped file. Empty if no file is mapped.
+	[[nodiscard]]
+	auto bytes() const -> span<u8 const> { return {static_cast<u8 const*>(map), length}; }
+
+	// Resolved path of the file.
+	[[nodiscard]]
+	auto where() const -> string_view { return pathStr; }
+
+	operator bool() const { return isOpen(); }
+
+	// Moveable, not copyable
+	mapped_file(mapped_file const&) = delete;
+	auto operator=(mapped_file const&) -> mapped_file& = delete;
+	mapped_file(mapped_file&&) noexcept;
+	auto operator=(mapped_file&&) noexcept -> mapped_file&;
+
+private:
+
+	void const* map{nullptr}; // nullptr if no file mapped
+	size_t length{0};
+	string pathStr;
+#ifdef _WIN32
+	void* mapping{nullptr}; // File mapping object HANDLE
+#endif //_WIN32
+
+};
+
 inline static file cout{stdout, "stdout", true};
 inline static file cerr{stderr, "stderr", true};
 
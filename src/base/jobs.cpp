@@ -0,0 +1,245 @@
+#include "base/jobs.hpp"
+
+#include "base/profile.hpp"
+#include "base/log.hpp"
+
+namespace minote {
+
+// Number of times an idle worker looks for jobs before going to sleep
+constexpr u32 JobSpinCount = 64;
+
+// Job system and worker index of the calling thread
+static thread_local JobSystem const* currentSystem = nullptr;
+static thread_local u32 currentIndex = 0;
+
+auto JobDeque::push(Job* const job) -> bool
+{
+	auto const b = bottom.load(std::memory_order_relaxed);
+	auto const t = top.load(std::memory_order_acquire);
+	if (b - t >= i64(JobDequeSize)) return false;
+
+	jobs[b & (JobDequeSize - 1)].store(job, std::memory_order_relaxed);
+	bottom.store(b + 1, std::memory_order_release); // Publishes the job to thieves
+	return true;
+}
+
+auto JobDeque::pop() -> Job*
+{
+	auto const b = bottom.load(std::memory_order_relaxed) - 1;
+	bottom.store(b, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	auto t = top.load(std::memory_order_relaxed);
+	if (t > b) { // Empty
+		bottom.store(b + 1, std::memory_order_relaxed);
+		return nullptr;
+	}
+
+	auto* job = jobs[b & (JobDequeSize - 1)].load(std::memory_order_relaxed);
+	if (t == b) {
+		// Last job, which thieves might be taking at the same time
+		if (!top.compare_exchange_strong(t, t + 1,
+			std::memory_order_seq_cst, std::memory_order_relaxed))
+			job = nullptr;
+		bottom.store(b + 1, std::memory_order_relaxed);
+	}
+	return job;
+}
+
+auto JobDeque::steal() -> Job*
+{
+	auto t = top.load(std::memory_order_acquire);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	auto const b = bottom.load(std::memory_order_acquire);
+	if (t >= b) return nullptr;
+
+	auto* const job = jobs[t & (JobDequeSize - 1)].load(std::memory_order_relaxed);
+	if (!top.compare_exchange_strong(t, t + 1,
+		std::memory_order_seq_cst, std::memory_order_relaxed))
+		return nullptr;
+	return job;
+}
+
+JobSystem::JobSystem(u32 const count)
+{
+	ASSERT(!currentSystem);
+
+	workers.reserve(count + 1);
+	for (u32 i = 0; i <= count; i += 1)
+		workers.push_back(std::make_unique<Worker>());
+
+	currentSystem = this;
+	currentIndex = 0;
+	for (u32 i = 1; i <= count; i += 1)
+		workers[i]->handle = thread([this, i](stop_token stop) { workerLoop(stop, i); });
+
+	L.info("Job system started with {} background workers", count);
+}
+
+JobSystem::~JobSystem()
+{
+	for (auto& worker: workers)
+		worker->handle.request_stop();
+	for (auto& worker: workers)
+		if (worker->handle.joinable())
+			worker->handle.join();
+
+	currentSystem = nullptr;
+	L.debug("Job system stopped");
+}
+
+auto JobSystem::defaultWorkers() -> u32
+{
+	return std::max(std::thread::hardware_concurrency(), 3u) - 2;
+}
+
+void JobSystem::wait(JobCounter const& counter)
+{
+	auto const index = currentWorker();
+	while (!counter.done()) {
+		if (auto* const job = find(index))
+			execute(*job, index);
+		else
+			std::this_thread::yield();
+	}
+}
+
+auto JobSystem::currentWorker() const -> u32
+{
+	ASSERT(currentSystem == this);
+	return currentIndex;
+}
+
+auto JobSystem::allocate() -> Job&
+{
+	auto& worker = *workers[currentWorker()];
+	auto& job = worker.pool[worker.nextSlot & (JobPoolSize - 1)];
+	ASSERT(!job.active.load(std::memory_order_acquire)); // Over JobPoolSize unfinished jobs
+	job.active.store(true, std::memory_order_relaxed);
+	worker.nextSlot += 1;
+	return job;
+}
+
+void JobSystem::submit(Job& job, JobAffinity affinity)
+{
+	if (affinity == JobAffinity::Background && workers.size() == 1)
+		affinity = JobAffinity::Main; // Nobody else to run it
+
+	switch (affinity) {
+	case JobAffinity::Any:
+		if (!workers[currentWorker()]->deque.push(&job)) {
+			execute(job, currentWorker()); // Deque is full
+			return;
+		}
+		break;
+	case JobAffinity::Main: {
+		auto const lock = scoped_lock{inboxLock};
+		mainInbox.push_back(&job);
+		mainInboxCount.fetch_add(1, std::memory_order_release);
+		return; // Background workers can't help
+	}
+	case JobAffinity::Background: {
+		auto const lock = scoped_lock{inboxLock};
+		backgroundInbox.push_back(&job);
+		backgroundInboxCount.fetch_add(1, std::memory_order_release);
+		break;
+	}
+	}
+
+	// Wake up a worker if all of them are asleep. Pairs with the predicate
+	// check in workerLoop()
+	queued.fetch_add(1);
+	if (sleeping.load()) {
+		auto const lock = scoped_lock{sleepLock};
+		wake.notify_one();
+	}
+}
+
+auto JobSystem::find(u32 const index) -> Job*
+{
+	auto& self = *workers[index];
+
+	// Deferred jobs that can start now
+	for (size_t i = 0; i < self.deferred.size(); i += 1) {
+		auto* const job = self.deferred[i];
+		if (!job->dependency->done()) continue;
+		self.deferred[i] = self.deferred.back();
+		self.deferred.pop_back();
+		return job;
+	}
+
+	// Jobs meant for this thread
+	auto& inbox = index == 0? mainInbox : backgroundInbox;
+	auto& inboxCount = index == 0? mainInboxCount : backgroundInboxCount;
+	if (inboxCount.load(std::memory_order_acquire)) {
+		auto const lock = scoped_lock{inboxLock};
+		if (!inbox.empty()) {
+			auto* const job = inbox.front();
+			inbox.erase(inbox.begin());
+			inboxCount.fetch_sub(1, std::memory_order_relaxed);
+			if (index != 0)
+				queued.fetch_sub(1);
+			return job;
+		}
+	}
+
+	// Own jobs, newest first
+	if (auto* const job = self.deque.pop()) {
+		queued.fetch_sub(1);
+		return job;
+	}
+
+	// Other workers' jobs, oldest first
+	for (size_t i = 1; i < workers.size(); i += 1) {
+		if (auto* const job = workers[(index + i) % workers.size()]->deque.steal()) {
+			queued.fetch_sub(1);
+			return job;
+		}
+	}
+	return nullptr;
+}
+
+void JobSystem::execute(Job& job, u32 const index)
+{
+	if (job.dependency && !job.dependency->done()) {
+		workers[index]->deferred.push_back(&job);
+		return;
+	}
+
+	job.func(job);
+	// Read the counter first, the slot can be reused as soon as it's released
+	auto* const counter = job.counter;
+	job.active.store(false, std::memory_order_release);
+	if (counter)
+		counter->pending.fetch_sub(1, std::memory_order_release);
+}
+
+void JobSystem::workerLoop(stop_token const stop, u32 const index)
+{
+	currentSystem = this;
+	currentIndex = index;
+	profileNameThread(format("worker {}", index));
+
+	u32 idle = 0;
+	while (!stop.stop_requested()) {
+		if (auto* const job = find(index)) {
+			execute(*job, index);
+			idle = 0;
+			continue;
+		}
+
+		// Deferred jobs need to be checked on, so no sleeping
+		idle += 1;
+		if (idle < JobSpinCount || !workers[index]->deferred.empty()) {
+			std::this_thread::yield();
+			continue;
+		}
+
+		auto lock = std::unique_lock{sleepLock};
+		sleeping.fetch_add(1);
+		wake.wait(lock, stop, [this] { return queued.load() > 0; });
+		sleeping.fetch_sub(1);
+		idle = 0;
+	}
+}
+
+}
@@ -0,0 +1,239 @@
+// Minote - base/jobs.hpp
+// Job system for spreading work across cores. Every worker thread owns
+// a Chase-Lev deque: it pushes and pops its own jobs at the bottom without
+// locking, and idle workers steal from the top of the others' deques.
+// The thread that creates the JobSystem becomes worker 0, and runs jobs
+// while it waits for them.
+//
+// Jobs are small trivially copyable callables, such as lambdas capturing
+// by reference, stored inline without allocation:
+//
+//     JobCounter counter;
+//     jobs.run([&] { shapeText(a); }, &counter);
+//     jobs.run([&] { shapeText(b); }, &counter);
+//     jobs.wait(counter);
+
+#pragma once
+
+#include <type_traits>
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include "base/thread.hpp"
+#include "base/array.hpp"
+#include "base/util.hpp"
+
+namespace minote {
+
+// Capacity of a worker's deque. Must be a power of 2. If a deque is full,
+// new jobs run immediately on the submitting thread
+constexpr size_t JobDequeSize = 4096;
+
+// Number of job slots per worker, reused in a cycle. At most this many jobs
+// submitted by the same worker can be unfinished at a time. Must be a power
+// of 2
+constexpr size_t JobPoolSize = 4096;
+
+// Size limit of a job's callable, in bytes
+constexpr size_t JobPayloadSize = 48;
+
+// Number of unfinished jobs of a group. Wait for it with JobSystem::wait(),
+// or make other jobs depend on it
+struct JobCounter {
+
+	atomic<u32> pending = 0;
+
+	[[nodiscard]]
+	auto done() const -> bool { return pending.load(std::memory_order_acquire) == 0; }
+
+};
+
+// Hint of which thread should run a job
+enum struct JobAffinity {
+	Any,        // Any worker, including the main one
+	Main,       // Only the thread that created the JobSystem, such as for jobs
+	            // that need its OpenGL context
+	Background, // Any worker except the main one, for long jobs that
+	            // shouldn't delay the frame, such as asset loading
+};
+
+struct Job {
+
+	// Calls the payload
+	void (*func)(Job&);
+
+	// Decremented once the job is finished. Can be nullptr
+	JobCounter* counter;
+
+	// The job doesn't start before this reaches zero. Can be nullptr
+	JobCounter const* dependency;
+
+	// True from submission until the job has run, while the slot can't
+	// be reused
+	atomic<bool> active = false;
+
+	alignas(std::max_align_t) std::byte payload[JobPayloadSize];
+
+};
+
+// Lock-free work-stealing deque of jobs, after Lê et al., "Correct and
+// Efficient Work-Stealing for Weak Memory Models" (2013). Only the owner can
+// push and pop; any thread can steal.
+struct JobDeque {
+
+	// Add a job to the bottom. Returns false if the deque is full.
+	auto push(Job* job) -> bool;
+
+	// Remove a job from the bottom. Returns nullptr if empty.
+	auto pop() -> Job*;
+
+	// Remove a job from the top. Returns nullptr if empty, or if another
+	// thread took it first.
+	auto steal() -> Job*;
+
+private:
+
+	alignas(64) atomic<i64> top = 0;
+	alignas(64) atomic<i64> bottom = 0;
+	array<atomic<Job*>, JobDequeSize> jobs = {};
+
+};
+
+struct JobSystem {
+
+	// Start the given number of background worker threads. The calling
+	// thread becomes the main worker. With 0 workers, jobs only run
+	// when the main thread waits.
+	explicit JobSystem(u32 workers = defaultWorkers());
+
+	// Stop the workers. Unfinished jobs are abandoned.
+	~JobSystem();
+
+	// One background worker for every core, except for the ones used by
+	// the game and input threads.
+	static auto defaultWorkers() -> u32;
+
+	// Number of threads that run jobs, including the main one.
+	[[nodiscard]]
+	auto threadCount() const -> u32 { return workers.size(); }
+
+	// Queue up a job. If counter is provided, it's incremented now and
+	// decremented once the job is finished. If dependency is provided,
+	// the job doesn't start before it's done. Must be called from the main
+	// thread or from a job.
+	template<typename F>
+	void run(F&& func, JobCounter* counter = nullptr,
+		JobAffinity affinity = JobAffinity::Any, JobCounter const* dependency = nullptr);
+
+	// Run other jobs until the counter reaches zero. Must be called from
+	// the main thread or from a job.
+	void wait(JobCounter const& counter);
+
+	// Call func(begin, end) over subranges of [0, count) in parallel, and wait
+	// for all of them. Subranges hold at least grain elements, except
+	// the last one.
+	template<typename F>
+	void parallelFor(size_t count, size_t grain, F const& func);
+
+	// Not copyable, not movable
+	JobSystem(JobSystem const&) = delete;
+	auto operator=(JobSystem const&) -> JobSystem& = delete;
+
+private:
+
+	struct Worker {
+
+		JobDeque deque;
+
+		// Slots that submitted jobs are stored in
+		array<Job, JobPoolSize> pool;
+		size_t nextSlot = 0;
+
+		// Taken jobs whose dependency wasn't done yet. Only accessed by
+		// the owner
+		vector<Job*> deferred;
+
+		thread handle;
+
+	};
+
+	vector<std::unique_ptr<Worker>> workers;
+
+	// Jobs with JobAffinity::Main and JobAffinity::Background, oldest first.
+	// The counts allow checking for jobs without locking
+	mutex inboxLock;
+	vector<Job*> mainInbox;
+	vector<Job*> backgroundInbox;
+	atomic<u32> mainInboxCount = 0;
+	atomic<u32> backgroundInboxCount = 0;
+
+	// Number of queued jobs that background workers can run, for waking
+	// them up
+	atomic<i64> queued = 0;
+	atomic<u32> sleeping = 0;
+	mutex sleepLock;
+	condition_variable_any wake;
+
+	// Index of the worker running on the calling thread.
+	[[nodiscard]]
+	auto currentWorker() const -> u32;
+
+	// Claim a job slot of the calling thread's worker. The slot must be
+	// finished, so at most JobPoolSize jobs of a worker can be unfinished.
+	auto allocate() -> Job&;
+
+	// Queue up a filled job slot.
+	void submit(Job& job, JobAffinity affinity);
+
+	// Take a job for a worker to run, or nullptr if there are none.
+	auto find(u32 worker) -> Job*;
+
+	// Run a job, or defer it if its dependency isn't done.
+	void execute(Job& job, u32 worker);
+
+	void workerLoop(stop_token stop, u32 index);
+
+};
+
+template<typename F>
+void JobSystem::run(F&& func, JobCounter* const counter,
+	JobAffinity const affinity, JobCounter const* const dependency)
+{
+	using Func = std::decay_t<F>;
+	static_assert(sizeof(Func) <= JobPayloadSize, "Job callable is too large");
+	static_assert(alignof(Func) <= alignof(std::max_align_t));
+	static_assert(std::is_trivially_copyable_v<Func> && std::is_trivially_destructible_v<Func>,
+		"Job callables are copied bytewise and never destroyed");
+
+	auto& job = allocate();
+	new (job.payload) Func(std::forward<F>(func));
+	job.func = [](Job& self) {
+		(*std::launder(reinterpret_cast<Func*>(self.payload)))();
+	};
+	job.counter = counter;
+	job.dependency = dependency;
+	if (counter)
+		counter->pending.fetch_add(1, std::memory_order_relaxed);
+	submit(job, affinity);
+}
+
+template<typename F>
+void JobSystem::parallelFor(size_t const count, size_t const grain, F const& func)
+{
+	if (!count) return;
+
+	// A few chunks per thread, so that stealing can even out the load
+	auto const chunks = size_t(threadCount()) * 4;
+	auto const chunk = std::max(std::max(grain, size_t(1)), (count + chunks - 1) / chunks);
+
+	JobCounter counter;
+	for (size_t begin = chunk; begin < count; begin += chunk) {
+		auto const end = std::min(begin + chunk, count);
+		run([&func, begin, end] { func(begin, end); }, &counter);
+	}
+	func(0, std::min(chunk, count)); // The first chunk is ours
+	wait(counter);
+}
+
+}
@@ -1,19 +1,314 @@
 #include "log.hpp"
 
+#include <algorithm>
+#include "base/time_io.hpp"
 #include "base/io.hpp"
 
 namespace minote {
 
+// Interval at which the writer thread checks for new messages when idle
+constexpr auto WriterInterval = 1_ms;
+
+// Current time in nanoseconds since the Unix epoch.
+static auto logTime() -> i64 {
+	return std::chrono::duration_cast<nsec>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+// Start a message with its timestamp and level.
+static void formatPreamble(memory_buffer& buf, Log::Level const level, i64 const time) {
+	// Converting the time is slow, so reuse the result within the same second
+	thread_local std::time_t cachedTime = -1;
+	thread_local array<char, 8> cachedStamp = {};
+	auto const seconds = std::time_t(time / 1'000'000'000);
+	if (seconds != cachedTime) {
+		format_to(cachedStamp.begin(), "{:%H:%M:%S}", fmt::localtime(seconds));
+		cachedTime = seconds;
+	}
+	buf.append(cachedStamp.data(), cachedStamp.data() + cachedStamp.size());
+	format_to(buf, " [{}] ", detail::LogLevelStrings[+level]);
+}
+
 void Log::enableFile(file&& _logfile) {
-	if (logfile) disableFile();
+	bool const async = isAsyncEnabled();
+	if (async) disableAsync();
 
+	if (logfile) disableFile();
 	logfile = move(_logfile);
+
+	if (async) enableAsync();
 }
 
 void Log::disableFile() try {
+	flush();
 	logfile.close();
 } catch (system_error const& e) {
 	print(cerr, R"(Could not close logfile "{}": {})", logfile.where(), e.what());
 }
 
+void Log::enableTraceFile(file&& _tracefile) try {
+	bool const async = isAsyncEnabled();
+	if (async) disableAsync();
+
+	if (tracefile) disableTraceFile();
+	tracefile = move(_tracefile);
+	traceFormats.clear();
+	auto const header = TracelogHeader{
+		.magic = TracelogMagic,
+		.version = TracelogVersion};
+	detail::logTo(tracefile, {reinterpret_cast<char const*>(&header), sizeof(header)});
+
+	if (async) enableAsync();
+} catch (system_error const& e) {
+	print(cerr, R"(Could not enable trace file "{}": {})", tracefile.where(), e.what());
+}
+
+void Log::disableTraceFile() try {
+	flush();
+	tracefile.close();
+} catch (system_error const& e) {
+	print(cerr, R"(Could not close trace file "{}": {})", tracefile.where(), e.what());
+}
+
+void Log::enableAsync() {
+	if (isAsyncEnabled()) return;
+
+	if (!queue) {
+		queue = std::make_unique<Slot[]>(QueueSlots);
+		for (size_t i = 0; i < QueueSlots; i += 1)
+			queue[i].sequence.store(i, std::memory_order_relaxed);
+		enqueuePos.store(0, std::memory_order_relaxed);
+		dequeuePos.store(0, std::memory_order_relaxed);
+	}
+	writer = thread([this](stop_token stop) { writerLoop(stop); });
+}
+
+void Log::disableAsync() {
+	if (!isAsyncEnabled()) return;
+
+	writer.request_stop();
+	writer.join();
+	writer = {};
+}
+
+void Log::flush() try {
+	if (isAsyncEnabled()) {
+		auto const target = enqueuePos.load(std::memory_order_acquire);
+		while (dequeuePos.load(std::memory_order_acquire) < target)
+			std::this_thread::yield();
+	}
+
+	cout.flush();
+	cerr.flush();
+	logfile.flush();
+	tracefile.flush();
+} catch (system_error const& e) {
+	print(cerr, "Failed to flush log outputs: {}\n", e.what());
+}
+
+void Log::submit(Level const _level, LogFormatInfo const* const format, string_view const msg) {
+	auto const now = logTime();
+	if (!isAsyncEnabled()) {
+		if (format) {
+			memory_buffer buf;
+			auto const lock = scoped_lock{traceLock};
+			writeTrace(buf, _level, now, *format, msg);
+			detail::logTo(tracefile, {buf.data(), buf.size()});
+		} else {
+			write(_level, now, msg);
+		}
+		return;
+	}
+
+	// Reserve enough consecutive slots for the whole message, waiting
+	// for the writer if the queue is full
+	constexpr u64 Mask = QueueSlots - 1;
+	auto const parts = std::clamp<u64>((msg.size() + SlotChars - 1) / SlotChars, 1, QueueSlots / 4);
+	auto pos = enqueuePos.load(std::memory_order_relaxed);
+	while (true) {
+		bool free = true;
+		for (u64 i = 0; i < parts; i += 1) {
+			if (queue[(pos + i) & Mask].sequence.load(std::memory_order_acquire) != pos + i) {
+				free = false;
+				break;
+			}
+		}
+		if (!free) {
+			auto const current = enqueuePos.load(std::memory_order_relaxed);
+			if (current == pos)
+				std::this_thread::yield();
+			pos = current;
+			continue;
+		}
+		if (enqueuePos.compare_exchange_weak(pos, pos + parts, std::memory_order_relaxed))
+			break;
+	}
+
+	// Fill in the slots. The first one is published last, so that the writer
+	// sees the whole message once it sees the first slot
+	for (u64 i = parts - 1; i < parts; i -= 1) {
+		auto& slot = queue[(pos + i) & Mask];
+		auto const offset = std::min<size_t>(i * SlotChars, msg.size());
+		auto const length = std::min<size_t>(msg.size() - offset, SlotChars);
+		slot.level = _level;
+		slot.time = now;
+		slot.format = format;
+		slot.parts = u32(parts);
+		slot.length = u32(length);
+		std::copy_n(msg.data() + offset, length, slot.text.begin());
+		slot.sequence.store(pos + i + 1, std::memory_order_release);
+	}
+
+	// The application is about to go down
+	if (_level >= Level::Crit)
+		flush();
+}
+
+void Log::write(Level const _level, i64 const time, string_view const msg) {
+	memory_buffer buf;
+	formatPreamble(buf, _level, time);
+	buf.append(msg.data(), msg.data() + msg.size());
+	buf.push_back('\n');
+	auto const str = string_view{buf.data(), buf.size()};
+
+	if (console) {
+		if (_level >= Level::Warn) {
+			// Ensure previously written messages are not interleaved
+			cout.flush();
+			detail::logTo(cerr, str);
+			// Ensure message is written, in case the application crashes
+			cerr.flush();
+		} else {
+			detail::logTo(cout, str);
+		}
+	}
+
+	if (logfile) {
+		detail::logTo(logfile, str);
+		// Ensure message is written, in case the application crashes
+		if (_level >= Level::Warn)
+			logfile.flush();
+	}
+}
+
+void Log::writeTrace(memory_buffer& buf, Level const _level, i64 const time,
+	LogFormatInfo const& format, string_view const args) {
+	if (!traceFormats.contains(format.id)) {
+		auto const size = sizeof(u32) + 1 + format.args.size() + format.format.size();
+		detail::logAppendRaw(buf, TracelogRecord{
+			.format = TracelogDefinition,
+			.level = u8(+_level),
+			.padding = 0,
+			.size = u16(size),
+			.time = time});
+		detail::logAppendRaw(buf, format.id);
+		detail::logAppendRaw(buf, u8(format.args.size()));
+		buf.append(format.args.data(), format.args.data() + format.args.size());
+		buf.append(format.format.data(), format.format.data() + format.format.size());
+		traceFormats.insert(format.id);
+	}
+
+	detail::logAppendRaw(buf, TracelogRecord{
+		.format = format.id,
+		.level = u8(+_level),
+		.padding = 0,
+		.size = u16(args.size()),
+		.time = time});
+	buf.append(args.data(), args.data() + args.size());
+}
+
+void Log::writerLoop(stop_token const stop) {
+	while (!stop.stop_requested()) {
+		if (!drain())
+			sleepFor(WriterInterval);
+	}
+	while (drain());
+}
+
+auto Log::drain() -> bool try {
+	constexpr u64 Mask = QueueSlots - 1;
+	auto pos = dequeuePos.load(std::memory_order_relaxed);
+	if (queue[pos & Mask].sequence.load(std::memory_order_acquire) != pos + 1)
+		return false;
+	// Let flush() know how far the messages are written out, even on error
+	defer { dequeuePos.store(pos, std::memory_order_release); };
+
+	// Collect the messages, writing console output whenever it switches
+	// between stdout and stderr to preserve ordering
+	thread_local memory_buffer consoleBuf;
+	thread_local memory_buffer fileBuf;
+	thread_local memory_buffer traceBuf;
+	thread_local memory_buffer msg;
+	consoleBuf.clear();
+	fileBuf.clear();
+	traceBuf.clear();
+	bool consoleErr = false;
+	bool important = false;
+	auto const writeConsole = [&] {
+		if (consoleBuf.size() == 0) return;
+		detail::logTo(consoleErr? cerr : cout, {consoleBuf.data(), consoleBuf.size()});
+		consoleBuf.clear();
+	};
+	// Copy the end of the logfile output, starting at begin, to the console output
+	auto const appendConsole = [&](Level const _level, size_t const begin) {
+		bool const err = (_level >= Level::Warn);
+		if (err != consoleErr) {
+			writeConsole();
+			cout.flush();
+			consoleErr = err;
+		}
+		consoleBuf.append(fileBuf.data() + begin, fileBuf.data() + fileBuf.size());
+	};
+
+	while (queue[pos & Mask].sequence.load(std::memory_order_acquire) == pos + 1) {
+		auto const& first = queue[pos & Mask];
+		if (first.level >= Level::Warn)
+			important = true;
+
+		// Gather the parts of the message
+		msg.clear();
+		for (u64 i = 0; i < first.parts; i += 1) {
+			auto const& slot = queue[(pos + i) & Mask];
+			msg.append(slot.text.data(), slot.text.data() + slot.length);
+		}
+
+		if (first.format) {
+			writeTrace(traceBuf, first.level, first.time, *first.format, {msg.data(), msg.size()});
+		} else {
+			auto const begin = fileBuf.size();
+			formatPreamble(fileBuf, first.level, first.time);
+			fileBuf.append(msg.data(), msg.data() + msg.size());
+			fileBuf.push_back('\n');
+			if (console)
+				appendConsole(first.level, begin);
+		}
+
+		// Free the slots for the next lap of the queue
+		auto const parts = first.parts;
+		for (u64 i = 0; i < parts; i += 1)
+			queue[(pos + i) & Mask].sequence.store(pos + i + QueueSlots, std::memory_order_release);
+		pos += parts;
+	}
+
+	if (console) {
+		writeConsole();
+		cout.flush();
+	}
+	if (logfile) {
+		detail::logTo(logfile, {fileBuf.data(), fileBuf.size()});
+		// Ensure warnings and errors are written, in case the application crashes
+		if (important)
+			logfile.flush();
+	}
+	if (tracefile && traceBuf.size() > 0) {
+		detail::logTo(tracefile, {traceBuf.data(), traceBuf.size()});
+		if (important)
+			tracefile.flush();
+	}
+
+	return true;
+} catch (system_error const& e) {
+	print(cerr, "Failed to write log messages: {}\n", e.what());
+	return true;
+}
+
 }
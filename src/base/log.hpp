@@ -1,14 +1,66 @@
 // Minote - base/log.hpp
 // Facility for logging runtime events. Supports log levels and multiple output targets
-// per logger. Blocking and non-threaded, so don't use in large volumes.
+// per logger. Blocking by default; with async enabled, messages are handed off
+// to a background thread and logging calls don't wait on IO. Messages with
+// a compile-time format string ("..."_fmt) can skip formatting entirely,
+// and be written into a binary trace file instead.
 
 #pragma once
 
+#include <memory>
+#include <ctime>
+#include "base/tracelog.hpp"
+#include "base/hashmap.hpp"
+#include "base/thread.hpp"
+#include "base/array.hpp"
 #include "base/util.hpp"
 #include "base/io.hpp"
 
 namespace minote {
 
+// A string literal usable as a template argument
+template<size_t N>
+struct LogFormatString {
+
+	array<char, N> chars;
+
+	consteval LogFormatString(char const (&str)[N]) { std::copy_n(str, N, chars.begin()); }
+
+	[[nodiscard]]
+	constexpr auto view() const -> string_view { return {chars.data(), N - 1}; }
+
+};
+
+// A format string known at compile time. Messages using it can be written
+// to a trace file without being formatted.
+template<LogFormatString S>
+struct LogFormat {
+
+	static constexpr auto format = S;
+	static constexpr string_view str = S.view();
+
+};
+
+template<typename T>
+concept log_format = requires { T::str; };
+
+// Format string and argument types of binary messages. Written to the trace
+// file before the first message that uses them
+struct LogFormatInfo {
+
+	u32 id;
+	string_view format;
+
+	// A TracelogArg value for each argument
+	string_view args;
+
+};
+
+// Create a LogFormat from a string literal.
+// Example: L.debug("Spawned {} particles"_fmt, count);
+template<LogFormatString S>
+consteval auto operator""_fmt() { return LogFormat<S>{}; }
+
 struct Log {
 
 	// Logging level. Messages with level lower than this will be ignored
@@ -23,6 +75,12 @@ struct Log {
 		Size
 	} level{Level::None};
 
+	// Trace file logging level. Messages with a compile-time format string
+	// lower than this are not written into the trace file. Independent
+	// of level, so that the trace can hold high-frequency messages that would
+	// flood the text outputs
+	Level traceLevel{Level::None};
+
 	// If true, messages are printed to stdout (<=Info) or stderr (>=Warn)
 	bool console{false};
 
@@ -32,8 +90,9 @@ struct Log {
 	// Create a logger that writes into an open file.
 	explicit Log(file&& _logfile) noexcept { enableFile(move(_logfile)); }
 
-	// Clean up by closing any open logfile.
-	~Log() noexcept { disableFile(); }
+	// Clean up by writing out queued messages and closing any open logfile
+	// and trace file.
+	~Log() noexcept { disableAsync(); disableFile(); disableTraceFile(); }
 
 	// Enable logging to a file. Any open logfile will be closed.
 	void enableFile(file&& logfile);
@@ -45,9 +104,41 @@ struct Log {
 	[[nodiscard]]
 	auto isFileEnabled() const -> bool { return logfile; }
 
-	// Log a Trace level message. Meant for "printf debugging", do not leave any trace() calls
-	// in committed code.
-	// Example: pos.x = 3, pos.y = 7
+	// Enable writing messages with a compile-time format string into a binary
+	// trace file, without formatting them. They are still formatted for
+	// the other outputs if they pass level. Any open trace file will be closed.
+	// Don't call while other threads might be logging.
+	void enableTraceFile(file&& tracefile);
+
+	// Disable the trace file, so that all messages are formatted again.
+	void disableTraceFile();
+
+	// true if a trace file is enabled.
+	[[nodiscard]]
+	auto isTraceFileEnabled() const -> bool { return tracefile; }
+
+	// Start a background thread that writes out messages. Logging calls will only
+	// format the message and place it in a lock-free queue, and are safe to make
+	// from any thread. They only block if the queue is full. Don't call while other
+	// threads might be logging.
+	void enableAsync();
+
+	// Write out all queued messages and stop the background thread. Logging calls
+	// become blocking again.
+	void disableAsync();
+
+	// true if async logging is enabled.
+	[[nodiscard]]
+	auto isAsyncEnabled() const -> bool { return writer.joinable(); }
+
+	// Block until all previously logged messages are written out, and flush
+	// the outputs. Call before terminating on a critical error.
+	void flush();
+
+	// Log a Trace level message. Meant for high-frequency events, such as per-frame ones.
+	// Use a compile-time format string, so that they can be cheaply written into
+	// the trace file.
+	// Example: Render graph pass "bloom" executed
 	template<typename S, typename... Args>
 	void trace(const S& fmt, Args&&... args);
 
@@ -75,20 +166,94 @@ struct Log {
 	void error(const S& fmt, Args&&... args);
 
 	// Log a Crit level message. Meant for failures that the entire application cannot recover
-	// from.
+	// from. Blocks until all messages are written out.
 	// Example: Failed to initialize OpenGL
 	template<typename S, typename... Args>
 	void crit(const S& fmt, Args&&... args);
 
 	// Log a message at the specified level. Useful for mapping of external log level enums.
+	// Every logging function accepts either a regular format string, or a compile-time one
+	// created with the _fmt literal. The latter only allows arithmetic and string
+	// arguments.
 	template<typename S, typename... Args>
 	void log(Log::Level level, S const& fmt, Args&&... args);
 
 private:
 
+	// Number of characters that fit in a queue slot. Longer messages take up
+	// multiple consecutive slots
+	static constexpr size_t SlotChars = 216;
+
+	// Number of slots in the queue. Must be a power of 2
+	static constexpr size_t QueueSlots = 4096;
+
+	// A message, or a part of one, waiting to be written out
+	struct Slot {
+
+		// Equal to the slot's position in the queue if the slot is free,
+		// and to the position + 1 once a message is written into it
+		atomic<u64> sequence;
+
+		// Level of the message
+		Level level;
+
+		// Time of the message, in nanoseconds since the Unix epoch
+		i64 time;
+
+		// Format of a binary message, with arguments in text. nullptr if
+		// the message is formatted
+		LogFormatInfo const* format;
+
+		// Number of slots the message takes up. Only valid in the first slot
+		u32 parts;
+
+		// Number of characters in text
+		u32 length;
+
+		array<char, SlotChars> text;
+
+	};
+
 	// File to write messages into. File logging is disabled if logfile is not open
 	file logfile;
 
+	// File to write binary messages into. Disabled if not open
+	file tracefile;
+
+	// Formats already defined in the trace file. Without async logging,
+	// guarded by traceLock
+	hashset<u32> traceFormats;
+	mutex traceLock;
+
+	// Ring of QueueSlots slots. Producers reserve slots by advancing enqueuePos,
+	// the writer thread frees them by advancing dequeuePos
+	std::unique_ptr<Slot[]> queue;
+	alignas(64) atomic<u64> enqueuePos{0};
+	alignas(64) atomic<u64> dequeuePos{0};
+
+	// Thread that writes out queued messages if async logging is enabled
+	thread writer;
+
+	// Write a message to all outputs, or queue it if async logging is enabled.
+	// If format is not nullptr, msg holds the message's binary arguments.
+	void submit(Level level, LogFormatInfo const* format, string_view msg);
+
+	// Write a formatted message with a timestamp to all outputs.
+	void write(Level level, i64 time, string_view msg);
+
+	// Append a binary message to a buffer, defining its format if it's
+	// the first use.
+	void writeTrace(memory_buffer& buf, Level level, i64 time,
+		LogFormatInfo const& format, string_view args);
+
+	// Body of the writer thread. Writes out queued messages until stopped,
+	// then drains the queue.
+	void writerLoop(stop_token stop);
+
+	// Write out all currently queued messages in one batch. Returns false if
+	// the queue was empty.
+	auto drain() -> bool;
+
 };
 
 // Global logger available for convenience
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <algorithm>
 #include "base/time_io.hpp"
 #include "base/string.hpp"
 #include "base/array.hpp"
@@ -15,14 +16,67 @@ constexpr auto LogLevelStrings = array{
 	""sv, "TRACE"sv, "DEBUG"sv, " INFO"sv, " WARN"sv, "ERROR"sv, " CRIT"sv
 };
 
-// Write a preformatted log message to a specified output. Does not insert
+// Write preformatted log messages to a specified output. Does not insert
 // a newline.
-inline void logTo(file& f, string_view msg) try {
-	print(f, msg);
-} catch (system_error const& e) {
-	print(cerr, R"(Failed to write to logfile "{}": {}\n)", f.where(), e.what());
+inline void logTo(file& f, string_view msg) {
+	if (std::fwrite(msg.data(), 1, msg.size(), f) != msg.size())
+		print(cerr, R"(Failed to write to logfile "{}"\n)", f.where());
 }
 
+// Append the bytes of a trivially copyable value to a buffer.
+template<typename T>
+void logAppendRaw(memory_buffer& buf, T const& value) {
+	auto const* const bytes = reinterpret_cast<char const*>(&value);
+	buf.append(bytes, bytes + sizeof(T));
+}
+
+// Append an argument of a binary message to a buffer, in the trace file
+// format.
+template<tracelog_arg T>
+void logAppendArg(memory_buffer& buf, T const& arg) {
+	constexpr auto type = tracelogArgOf<T>();
+	if constexpr (type == TracelogArg::String) {
+		auto const str = string_view(arg);
+		auto const length = u16(std::min(str.size(), TracelogMaxString));
+		logAppendRaw(buf, length);
+		buf.append(str.data(), str.data() + length);
+	} else if constexpr (type == TracelogArg::I32) {
+		logAppendRaw(buf, i32(arg));
+	} else if constexpr (type == TracelogArg::U32) {
+		logAppendRaw(buf, u32(arg));
+	} else if constexpr (type == TracelogArg::I64) {
+		logAppendRaw(buf, i64(arg));
+	} else if constexpr (type == TracelogArg::U64) {
+		logAppendRaw(buf, u64(arg));
+	} else if constexpr (type == TracelogArg::F32) {
+		logAppendRaw(buf, f32(arg));
+	} else if constexpr (type == TracelogArg::F64) {
+		logAppendRaw(buf, f64(arg));
+	} else {
+		logAppendRaw(buf, arg);
+	}
+}
+
+// Description of a binary message format, created at compile time
+template<LogFormatString S, tracelog_arg... Args>
+struct LogFormatInfoOf {
+
+	static constexpr auto args = array<char, sizeof...(Args)>{char(tracelogArgOf<Args>())...};
+
+	static constexpr auto id = [] {
+		// Same format string with different argument types needs a different ID
+		u32 const result = +ID(S.view()) ^ (+ID({args.data(), args.size()}) * 31u);
+		return result == TracelogDefinition? 1u : result;
+	}();
+
+	static constexpr auto value = LogFormatInfo{
+		.id = id,
+		.format = S.view(),
+		.args = {args.data(), args.size()}};
+
+};
+
+
 }
 
 template<typename S, typename... Args>
@@ -57,39 +111,28 @@ void Log::crit(S const& fmt, Args&& ... args) {
 
 template<typename S, typename... Args>
 void Log::log(Log::Level const _level, S const& fmt, Args&&... args) {
-	if (_level < level) return;
-	if (!console && !logfile) return;
-
-	memory_buffer msg;
-
-	// Insert timestamp and level
-	auto const now = time(nullptr);
-	auto const localnow = *localtime(&now);
-	format_to(msg, "{:%H:%M:%S} [{}] ", localnow, detail::LogLevelStrings[+_level]);
-
-	// Insert formatted message
-	format_to(msg, fmt, args...);
-	format_to(msg, "\n\0"sv); // Finalize
-
-	// Print constructed message to all enabled targets
-	if (console) {
-		if (level >= Level::Warn) {
-			// Ensure previously written messages are not interleaved
-			cout.flush();
-			detail::logTo(cerr, msg.data());
-			// Ensure message is written, in case the application crashes
-			cerr.flush();
-		} else {
-			detail::logTo(cout, msg.data());
+	// Reused by all messages of the calling thread, so that logging
+	// doesn't allocate
+	thread_local memory_buffer msg;
+	msg.clear();
+
+	if constexpr (log_format<S>) {
+		if (tracefile && _level >= traceLevel) {
+			(detail::logAppendArg(msg, args), ...);
+			submit(_level, &detail::LogFormatInfoOf<S::format, std::remove_cvref_t<Args>...>::value,
+				{msg.data(), msg.size()});
+			msg.clear();
 		}
 	}
 
-	if (logfile) {
-		detail::logTo(logfile, msg.data());
-		// Ensure message is written, in case the application crashes
-		if (level >= Level::Warn)
-			logfile.flush();
-	}
+	if (_level < level) return;
+	if (!console && !logfile) return;
+	if constexpr (log_format<S>)
+		format_to(msg, S::str, args...);
+	else
+		format_to(msg, fmt, args...);
+
+	submit(_level, nullptr, {msg.data(), msg.size()});
 }
 
 }
@@ -6,6 +6,7 @@
 #include <glm/vec2.hpp>
 #include <glm/vec3.hpp>
 #include <glm/vec4.hpp>
+#include <glm/mat3x3.hpp>
 #include <glm/mat4x4.hpp>
 #include <glm/common.hpp>
 #include <glm/exponential.hpp>
@@ -36,6 +37,7 @@ using glm::ivec4;
 using glm::uvec2;
 using glm::uvec3;
 using glm::uvec4;
+using glm::mat3;
 using glm::mat4;
 using glm::u8vec2;
 using glm::u8vec3;
@@ -0,0 +1,93 @@
+#include "base/profile.hpp"
+
+#include <algorithm>
+#include "base/log.hpp"
+
+namespace minote {
+
+// Reference point for converting ticks to time, taken at startup
+static auto const originTicks = profileTicks();
+static auto const originTime = std::chrono::steady_clock::now();
+
+// Ticks per nanosecond, measured against the steady clock. Remeasured
+// periodically, since the precision improves with elapsed time
+static mutex calibrationLock;
+static f64 ticksPerNsec = 0.0;
+static auto calibrationTime = originTime;
+
+// All threads that ever recorded an event
+static mutex threadsLock;
+static vector<std::unique_ptr<ProfileThread>> threads;
+
+auto profileTime(u64 const ticks) -> nsec {
+	{
+		auto const guard = scoped_lock{calibrationLock};
+		auto const now = std::chrono::steady_clock::now();
+		if (ticksPerNsec == 0.0 || now - calibrationTime > 1_s) {
+			auto const elapsed = std::chrono::duration_cast<nsec>(now - originTime).count();
+			auto const elapsedTicks = profileTicks() - originTicks;
+			if (elapsed > 0)
+				ticksPerNsec = f64(elapsedTicks) / f64(elapsed);
+			calibrationTime = now;
+		}
+	}
+
+	auto const relative = i64(ticks - originTicks);
+	return nsec{i64(f64(relative) / ticksPerNsec)};
+}
+
+auto ProfileThread::snapshot() -> vector<ProfileEvent> {
+	auto const guard = scoped_lock{lock};
+	auto const available = std::min<u64>(count, ProfileEventsPerThread);
+	auto result = vector<ProfileEvent>();
+	result.reserve(available);
+	for (u64 i = count - available; i < count; i += 1)
+		result.push_back(events[i & (ProfileEventsPerThread - 1)]);
+	return result;
+}
+
+auto profileThread() -> ProfileThread& {
+	thread_local ProfileThread* current = nullptr;
+	if (current) return *current;
+
+	auto const guard = scoped_lock{threadsLock};
+	auto& created = threads.emplace_back(std::make_unique<ProfileThread>());
+	created->id = threads.size() - 1;
+	created->name = format("Thread {}", created->id);
+	current = created.get();
+	return *current;
+}
+
+void profileNameThread(string_view const name) {
+	auto& current = profileThread();
+	auto const guard = scoped_lock{threadsLock};
+	current.name = name;
+}
+
+void profileExport(path const& filename) {
+	auto output = file(filename, "w");
+	print(output, R"({{"displayTimeUnit":"ns","traceEvents":[)");
+
+	auto const guard = scoped_lock{threadsLock};
+	bool first = true;
+	size_t total = 0;
+	for (auto const& thread: threads) {
+		print(output, R"({}{{"name":"thread_name","ph":"M","pid":0,"tid":{},"args":{{"name":"{}"}}}})",
+			first? "" : ",", thread->id, thread->name);
+		first = false;
+
+		for (auto const& event: thread->snapshot()) {
+			auto const start = profileTime(event.start);
+			auto const duration = profileTime(event.end) - start;
+			print(output, R"(,{{"name":"{}","ph":"X","pid":0,"tid":{},"ts":{:.3f},"dur":{:.3f}}})",
+				event.name, thread->id, f64(start.count()) / 1000.0, f64(duration.count()) / 1000.0);
+			total += 1;
+		}
+	}
+
+	print(output, "]}}\n");
+	output.close();
+	L.info(R"(Exported {} profiler events to "{}")", total, output.where());
+}
+
+}
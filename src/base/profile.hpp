@@ -0,0 +1,134 @@
+// Minote - base/profile.hpp
+// Lightweight CPU profiler. Scoped zones record their start and end times
+// into a ring buffer of the calling thread. The recorded events can be
+// inspected live, or exported as a Chrome trace (chrome://tracing, Perfetto).
+
+#pragma once
+
+#include <memory>
+#include "base/thread.hpp"
+#include "base/string.hpp"
+#include "base/array.hpp"
+#include "base/util.hpp"
+#include "base/time.hpp"
+#include "base/io.hpp"
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#elif defined(_M_X64) || defined(_M_IX86)
+#include <intrin.h>
+#endif
+
+namespace minote {
+
+// Number of events kept per thread. Must be a power of 2
+constexpr size_t ProfileEventsPerThread = 16384;
+
+// A completed zone
+struct ProfileEvent {
+
+	// Name of the zone. Must be a string literal
+	char const* name;
+
+	// Start and end of the zone, in profiler ticks
+	u64 start;
+	u64 end;
+
+	// Number of zones the zone is nested in
+	u32 depth;
+
+};
+
+// Current time in profiler ticks. The CPU timestamp counter where available,
+// otherwise the steady clock in nanoseconds.
+inline auto profileTicks() -> u64 {
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+	return __rdtsc();
+#else
+	return std::chrono::steady_clock::now().time_since_epoch().count();
+#endif
+}
+
+// Convert a tick count into time since the profiler was first used.
+auto profileTime(u64 ticks) -> nsec;
+
+// Events recorded by a single thread
+struct ProfileThread {
+
+	// Name shown in exported traces
+	string name;
+
+	// Unique number of the thread
+	u32 id;
+
+	// Current nesting depth of zones
+	u32 depth = 0;
+
+	// Total number of events ever recorded. The last ProfileEventsPerThread
+	// of them are available
+	u64 count = 0;
+
+	// Guards events and count against readers on other threads
+	mutex lock;
+
+	array<ProfileEvent, ProfileEventsPerThread> events;
+
+	// Store a completed zone.
+	void record(ProfileEvent const& event) {
+		auto const guard = scoped_lock{lock};
+		events[count & (ProfileEventsPerThread - 1)] = event;
+		count += 1;
+	}
+
+	// Copy out the available events, oldest first.
+	[[nodiscard]]
+	auto snapshot() -> vector<ProfileEvent>;
+
+};
+
+// Events of the calling thread. Created on first use, and kept after
+// the thread exits.
+auto profileThread() -> ProfileThread&;
+
+// Set the name of the calling thread in exported traces.
+void profileNameThread(string_view name);
+
+// Write the events of all threads into a file, in Chrome trace_event
+// JSON format. Throws system_error on failure.
+void profileExport(path const& filename);
+
+// Records the time between construction and destruction as an event
+// of the calling thread. Use with the PROFILE_ZONE macro.
+struct ProfileZone {
+
+	explicit ProfileZone(char const* const _name):
+		name{_name}, thread{profileThread()}, depth{thread.depth}, start{profileTicks()} {
+		thread.depth += 1;
+	}
+
+	~ProfileZone() {
+		auto const end = profileTicks();
+		thread.depth -= 1;
+		thread.record({.name = name, .start = start, .end = end, .depth = depth});
+	}
+
+	ProfileZone(ProfileZone const&) = delete;
+	auto operator=(ProfileZone const&) -> ProfileZone& = delete;
+
+private:
+
+	char const* name;
+	ProfileThread& thread;
+	u32 depth;
+	u64 start;
+
+};
+
+#define PROFILE_ZONE_CONCAT_IMPL(a, b) a##b
+#define PROFILE_ZONE_CONCAT(a, b) PROFILE_ZONE_CONCAT_IMPL(a, b)
+
+// Profile the rest of the current scope as a zone with the given name.
+// Example: PROFILE_ZONE("playUpdate");
+#define PROFILE_ZONE(name) \
+	::minote::ProfileZone const PROFILE_ZONE_CONCAT(profileZone_, __LINE__){name}
+
+}
@@ -0,0 +1,61 @@
+// Minote - base/registry.hpp
+// List of named functions that add themselves from any number of files before
+// main() runs. Used by tool executables such as minote-bench and minote-check,
+// whose entries are spread over many files. Define entries with a macro that
+// wraps REGISTRY_ENTRY, and iterate over Registry<Func>::entries() in main().
+
+#pragma once
+
+#include "base/string.hpp"
+#include "base/array.hpp"
+
+namespace minote {
+
+template<typename Func>
+struct Registry {
+
+	struct Entry {
+
+		char const* name;
+		Func func;
+
+	};
+
+	// All entries, in order of static initialization. Constructed on first use,
+	// so that it's ready for any static initializer
+	static auto entries() -> vector<Entry>& {
+		static auto list = vector<Entry>();
+		return list;
+	}
+
+	// Add an entry. Returns a dummy value to initialize a static with.
+	static auto add(char const* name, Func func) -> int {
+		entries().push_back({name, func});
+		return 0;
+	}
+
+	// Entries whose name contains the filter string. An empty filter
+	// matches all entries.
+	static auto matching(string_view filter) -> vector<Entry> {
+		auto result = vector<Entry>();
+		for (auto const& entry: entries())
+			if (string_view(entry.name).find(filter) != string_view::npos)
+				result.push_back(entry);
+		return result;
+	}
+
+};
+
+#define REGISTRY_CONCAT_IMPL(a, b) a##b
+#define REGISTRY_CONCAT(a, b) REGISTRY_CONCAT_IMPL(a, b)
+
+// Define a function taking "State& state" and add it to Registry<Func> under
+// the given name. The function's symbol is prefixed, so that the name can
+// match an existing function.
+#define REGISTRY_ENTRY(Func, State, prefix, name) \
+	static void REGISTRY_CONCAT(prefix, name)(State& state); \
+	[[maybe_unused]] static int const REGISTRY_CONCAT(prefix##registered_, name) = \
+		::minote::Registry<Func>::add(#name, REGISTRY_CONCAT(prefix, name)); \
+	static void REGISTRY_CONCAT(prefix, name)([[maybe_unused]] State& state)
+
+}
@@ -6,6 +6,7 @@
 #include <atomic>
 #include <thread>
 #include <mutex>
+#include <condition_variable>
 #include "base/time.hpp"
 
 namespace minote {
@@ -14,6 +15,8 @@ using thread = std::jthread; // Joins thread on destruction
 using std::mutex;
 using std::scoped_lock;
 using std::atomic;
+using std::condition_variable_any; // Can be woken by a thread's stop token
+using std::stop_token;
 
 // Sleep the thread for the specific duration. Keep in mind that on Windows this will be
 // at least 1ms and might have strong jitter.
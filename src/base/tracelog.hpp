@@ -0,0 +1,101 @@
+// Minote - base/tracelog.hpp
+// Binary log format. Messages with a compile-time format string are written
+// into it by the logger as raw arguments, and formatted offline
+// by the minote-logdump tool
+
+#pragma once
+
+#include <type_traits>
+#include <string_view>
+#include "base/util.hpp"
+
+namespace minote {
+
+// Layout of the file:
+// - TracelogHeader
+// - Records, each a TracelogRecord followed by size bytes of payload
+// A record with format TracelogDefinition defines a format string used by
+// the records after it. Its payload is:
+// - u32 ID of the format
+// - u8 number of arguments, followed by a TracelogArg for each argument
+// - the format string in fmt syntax, up to the end of the payload
+// Any other record is a message. Its payload is the arguments in order;
+// strings are stored as a u16 length followed by the characters, other
+// types as-is. All values are little-endian.
+
+// "MTRC" as a little-endian u32
+constexpr u32 TracelogMagic = 0x4352544D;
+
+// Increment on every change to the layout
+constexpr u32 TracelogVersion = 1;
+
+// Format ID of records that define a format
+constexpr u32 TracelogDefinition = 0;
+
+// Longest string argument that is stored; the rest is cut off
+constexpr size_t TracelogMaxString = 4096;
+
+struct TracelogHeader {
+
+	u32 magic;
+	u32 version;
+
+};
+
+struct TracelogRecord {
+
+	// ID of the message's format, or TracelogDefinition
+	u32 format;
+
+	// Log::Level of the message
+	u8 level;
+
+	u8 padding;
+
+	// Number of payload bytes following the record
+	u16 size;
+
+	// Time of the message, in nanoseconds since the Unix epoch
+	i64 time;
+
+};
+
+static_assert(sizeof(TracelogHeader) == 8);
+static_assert(sizeof(TracelogRecord) == 16);
+
+// Type of a stored argument. Integers are widened to 32 or 64 bits
+enum struct TracelogArg : u8 {
+	Bool,
+	Char,
+	I32,
+	U32,
+	I64,
+	U64,
+	F32,
+	F64,
+	String,
+};
+
+// Types that can be arguments of a binary log message
+template<typename T>
+concept tracelog_arg = arithmetic<T> || std::is_convertible_v<T const&, std::string_view>;
+
+// Type that an argument is stored as.
+template<tracelog_arg T>
+consteval auto tracelogArgOf() -> TracelogArg
+{
+	if constexpr (std::is_same_v<T, bool>)
+		return TracelogArg::Bool;
+	else if constexpr (std::is_same_v<T, char>)
+		return TracelogArg::Char;
+	else if constexpr (std::is_floating_point_v<T>)
+		return sizeof(T) <= 4? TracelogArg::F32 : TracelogArg::F64;
+	else if constexpr (std::is_signed_v<T>)
+		return sizeof(T) <= 4? TracelogArg::I32 : TracelogArg::I64;
+	else if constexpr (std::is_unsigned_v<T>)
+		return sizeof(T) <= 4? TracelogArg::U32 : TracelogArg::U64;
+	else
+		return TracelogArg::String;
+}
+
+}
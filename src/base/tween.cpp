@@ -0,0 +1,101 @@
+#include "base/tween.hpp"
+
+namespace minote {
+
+// Evaluate tweens that all use the easing function F, which is known at compile
+// time so that it can be inlined into the loop.
+template<EasingFunction<f32> F>
+static void evaluateRun(span<Tween<f32> const> const tweens, nsec const time, f32* const out)
+{
+	for (size_t i = 0; i < tweens.size(); i += 1) {
+		auto const& tween = tweens[i];
+		out[i] = detail::tweenAt(tween.from, tween.to, tween.start, tween.duration, time, F);
+	}
+}
+
+// An easing function with its version of evaluateRun()
+struct EaseKernel {
+
+	EasingFunction<f32> func;
+	void (*evaluate)(span<Tween<f32> const>, nsec, f32*);
+
+};
+
+#define EASE_KERNEL(func) EaseKernel{func<f32>, evaluateRun<func<f32>>}
+
+static constexpr auto EaseKernels = array{
+	EASE_KERNEL(linearInterpolation),
+	EASE_KERNEL(quadraticEaseIn),
+	EASE_KERNEL(quadraticEaseOut),
+	EASE_KERNEL(quadraticEaseInOut),
+	EASE_KERNEL(cubicEaseIn),
+	EASE_KERNEL(cubicEaseOut),
+	EASE_KERNEL(cubicEaseInOut),
+	EASE_KERNEL(quarticEaseIn),
+	EASE_KERNEL(quarticEaseOut),
+	EASE_KERNEL(quarticEaseInOut),
+	EASE_KERNEL(quinticEaseIn),
+	EASE_KERNEL(quinticEaseOut),
+	EASE_KERNEL(quinticEaseInOut),
+	EASE_KERNEL(sineEaseIn),
+	EASE_KERNEL(sineEaseOut),
+	EASE_KERNEL(sineEaseInOut),
+	EASE_KERNEL(circularEaseIn),
+	EASE_KERNEL(circularEaseOut),
+	EASE_KERNEL(circularEaseInOut),
+	EASE_KERNEL(exponentialEaseIn),
+	EASE_KERNEL(exponentialEaseOut),
+	EASE_KERNEL(exponentialEaseInOut),
+	EASE_KERNEL(elasticEaseIn),
+	EASE_KERNEL(elasticEaseOut),
+	EASE_KERNEL(elasticEaseInOut),
+	EASE_KERNEL(backEaseIn),
+	EASE_KERNEL(backEaseOut),
+	EASE_KERNEL(backEaseInOut),
+	EASE_KERNEL(bounceEaseIn),
+	EASE_KERNEL(bounceEaseOut),
+	EASE_KERNEL(bounceEaseInOut),
+};
+
+#undef EASE_KERNEL
+
+// Find the evaluateRun() of an easing function, or nullptr if it's not
+// from ease.hpp.
+static auto kernelOf(EasingFunction<f32> const func) -> void (*)(span<Tween<f32> const>, nsec, f32*)
+{
+	for (auto const& kernel: EaseKernels)
+		if (kernel.func == func) return kernel.evaluate;
+	return nullptr;
+}
+
+void evaluate(span<Tween<f32> const> const tweens, nsec const time, span<f32> const out)
+{
+	ASSERT(out.size() >= tweens.size());
+
+	// Tweens are processed in runs that share an easing function, such as
+	// particles from the same burst
+	auto lastFunc = EasingFunction<f32>{nullptr};
+	auto kernel = static_cast<void (*)(span<Tween<f32> const>, nsec, f32*)>(nullptr);
+	size_t begin = 0;
+	while (begin < tweens.size()) {
+		auto const func = tweens[begin].type;
+		size_t end = begin + 1;
+		while (end < tweens.size() && tweens[end].type == func)
+			end += 1;
+
+		if (func != lastFunc) {
+			lastFunc = func;
+			kernel = kernelOf(func);
+		}
+		if (kernel) {
+			kernel(tweens.subspan(begin, end - begin), time, out.data() + begin);
+		} else {
+			for (size_t i = begin; i < end; i += 1)
+				out[i] = tweens[i].applyAt(time);
+		}
+
+		begin = end;
+	}
+}
+
+}
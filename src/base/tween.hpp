@@ -1,8 +1,12 @@
 // Minote - base/tween.hpp
-// Smooth transitions between floating-point values
+// Smooth transitions between floating-point values. Tween picks its easing
+// function at runtime, FixedTween at compile time so that it can be inlined.
+// Many Tweens can be evaluated at once with evaluate().
 
 #pragma once
 
+#include <type_traits>
+#include "base/array.hpp"
 #include "base/ease.hpp"
 #include "base/util.hpp"
 #include "base/time.hpp"
@@ -47,16 +51,67 @@ struct Tween {
 template<typename... T>
 Tween(T...) -> Tween<>;
 
-template<floating_point T>
-constexpr auto Tween<T>::applyAt(nsec const time) const -> Type {
+// Description of a tween instance with the easing function as a template
+// parameter, such as FixedTween<cubicEaseOut<f32>>. Otherwise the same as Tween.
+template<auto Ease, floating_point T = f32>
+struct FixedTween {
+
+	static_assert(std::is_convertible_v<decltype(Ease), EasingFunction<T>>,
+		"Ease must be an easing function of the tween's type");
+
+	using Type = T;
+
+	Type from{0.0f};
+	Type to{1.0f};
+	nsec start{0};
+	nsec duration{1_s};
+
+	void restart() { start = Glfw::getTime(); }
+
+	auto apply() const -> Type { return applyAt(Glfw::getTime()); }
+
+	constexpr auto applyAt(nsec time) const -> Type;
+
+	// Convert to a Tween with the same state, such as for evaluate().
+	constexpr operator Tween<T>() const {
+		return {.from = from, .to = to, .start = start, .duration = duration, .type = Ease};
+	}
+
+};
+
+// Calculate the values of many f32 tweens at the same moment, into out.
+// Consecutive tweens that use the same easing function from ease.hpp are
+// evaluated in a single loop with the function inlined, instead of a call
+// through the pointer for each tween, so it's best to keep such tweens
+// together. out must be at least as large as tweens.
+void evaluate(span<Tween<f32> const> tweens, nsec time, span<f32> out);
+
+namespace detail {
+
+// Value of a tween at a moment in time, given its easing function.
+template<floating_point T, typename F>
+constexpr auto tweenAt(T const from, T const to, nsec const start, nsec const duration,
+	nsec const time, F const ease) -> T {
 	if (start >= time) return from;
 	if (start + duration <= time) return to;
 
 	nsec const elapsed = time - start;
-	Type const progress = type(ratio(elapsed, duration));
+	T const progress = ease(ratio<T>(elapsed, duration));
 
-	Type const span = to - from;
+	T const span = to - from;
 	return from + span * progress;
 }
 
 }
+
+template<floating_point T>
+constexpr auto Tween<T>::applyAt(nsec const time) const -> Type {
+	return detail::tweenAt(from, to, start, duration, time, type);
+}
+
+template<auto Ease, floating_point T>
+constexpr auto FixedTween<Ease, T>::applyAt(nsec const time) const -> Type {
+	return detail::tweenAt(from, to, start, duration, time, Ease);
+}
+
+}
@@ -0,0 +1,226 @@
+// Minote - bench/base.cpp
+// Benchmarks of the base library
+
+#include "bench/bench.hpp"
+
+#include "base/hashmap.hpp"
+#include "base/string.hpp"
+#include "base/array.hpp"
+#include "base/tween.hpp"
+#include "base/io.hpp"
+#include "base/jobs.hpp"
+#include "base/ease.hpp"
+#include "base/ring.hpp"
+#include "base/rng.hpp"
+
+using namespace minote;
+
+BENCHMARK(ringPushPop) {
+	auto buffer = ring<u32, 64>();
+	for (u32 i = 0; i < 32; i += 1)
+		buffer.push_back(i);
+
+	u32 value = 0;
+	for (auto _: state) {
+		buffer.push_back(value);
+		value += buffer.front();
+		buffer.pop_front();
+	}
+	doNotOptimize(value);
+	state.items = 1;
+}
+
+BENCHMARK(hashmapLookupID) {
+	constexpr size_t Keys = 256;
+	auto map = hashmap<ID, u32>();
+	auto keys = vector<ID>();
+	keys.reserve(Keys);
+	for (u32 i = 0; i < Keys; i += 1) {
+		auto const key = ID(format("resource{}", i));
+		map.emplace(key, i);
+		keys.push_back(key);
+	}
+
+	size_t i = 0;
+	u32 sum = 0;
+	for (auto _: state) {
+		sum += map.find(keys[i])->second;
+		i = (i + 1) % Keys;
+	}
+	doNotOptimize(sum);
+	state.items = 1;
+}
+
+BENCHMARK(tweenApplyAt) {
+	auto const tween = Tween{
+		.from = 0.0f,
+		.to = 10.0f,
+		.start = 0_s,
+		.duration = 1_s,
+		.type = cubicEaseInOut};
+
+	// Sweep through the whole tween, including both clamped ends
+	auto time = -100_ms;
+	f32 sum = 0.0f;
+	for (auto _: state) {
+		sum += tween.applyAt(time);
+		time += 1_ms;
+		if (time > 1100_ms)
+			time = -100_ms;
+	}
+	doNotOptimize(sum);
+	state.items = 1;
+}
+
+BENCHMARK(fixedTweenApplyAt) {
+	auto const tween = FixedTween<cubicEaseInOut<f32>>{
+		.from = 0.0f,
+		.to = 10.0f,
+		.start = 0_s,
+		.duration = 1_s};
+
+	auto time = -100_ms;
+	f32 sum = 0.0f;
+	for (auto _: state) {
+		sum += tween.applyAt(time);
+		time += 1_ms;
+		if (time > 1100_ms)
+			time = -100_ms;
+	}
+	doNotOptimize(sum);
+	state.items = 1;
+}
+
+// Tweens spread over a few easing functions and starting times, like a frame's
+// worth of particles.
+static auto benchTweens(size_t const count) -> vector<Tween<f32>>
+{
+	constexpr auto Eases = array<EasingFunction<f32>, 3>{
+		quadraticEaseOut<f32>, cubicEaseOut<f32>, sineEaseOut<f32>};
+
+	auto tweens = vector<Tween<f32>>(count);
+	for (size_t i = 0; i < count; i += 1) {
+		tweens[i] = {
+			.from = 0.0f,
+			.to = 1.0f,
+			.start = milliseconds(i % 1000),
+			.duration = 1_s,
+			.type = Eases[i / 64 % Eases.size()]};
+	}
+	return tweens;
+}
+
+constexpr size_t BenchTweenCount = 4096;
+
+BENCHMARK(tweenApplyAtMany) {
+	auto const tweens = benchTweens(BenchTweenCount);
+	auto out = vector<f32>(tweens.size());
+
+	for (auto _: state) {
+		for (size_t i = 0; i < tweens.size(); i += 1)
+			out[i] = tweens[i].applyAt(1200_ms);
+		clobberMemory();
+	}
+	state.items = BenchTweenCount;
+}
+
+BENCHMARK(tweenEvaluate) {
+	auto const tweens = benchTweens(BenchTweenCount);
+	auto out = vector<f32>(tweens.size());
+
+	for (auto _: state) {
+		evaluate(tweens, 1200_ms, out);
+		clobberMemory();
+	}
+	state.items = BenchTweenCount;
+}
+
+// Evaluate an easing function over the [0, 1] range.
+template<EasingFunction<f32> F>
+static void benchEase(BenchState& state)
+{
+	f32 p = 0.0f;
+	f32 sum = 0.0f;
+	for (auto _: state) {
+		sum += F(p);
+		p += 1.0f / 1024.0f;
+		if (p > 1.0f)
+			p = 0.0f;
+	}
+	doNotOptimize(sum);
+	state.items = 1;
+}
+
+#define BENCH_EASE(func) \
+	::minote::Registry<::minote::BenchFunc>::add("ease/" #func, benchEase<func<f32>>)
+
+[[maybe_unused]] static int const easeRegistered[] = {
+	BENCH_EASE(linearInterpolation),
+	BENCH_EASE(quadraticEaseIn),
+	BENCH_EASE(quadraticEaseOut),
+	BENCH_EASE(quadraticEaseInOut),
+	BENCH_EASE(cubicEaseIn),
+	BENCH_EASE(cubicEaseOut),
+	BENCH_EASE(cubicEaseInOut),
+	BENCH_EASE(quarticEaseIn),
+	BENCH_EASE(quarticEaseOut),
+	BENCH_EASE(quarticEaseInOut),
+	BENCH_EASE(quinticEaseIn),
+	BENCH_EASE(quinticEaseOut),
+	BENCH_EASE(quinticEaseInOut),
+	BENCH_EASE(sineEaseIn),
+	BENCH_EASE(sineEaseOut),
+	BENCH_EASE(sineEaseInOut),
+	BENCH_EASE(circularEaseIn),
+	BENCH_EASE(circularEaseOut),
+	BENCH_EASE(circularEaseInOut),
+	BENCH_EASE(exponentialEaseIn),
+	BENCH_EASE(exponentialEaseOut),
+	BENCH_EASE(exponentialEaseInOut),
+	BENCH_EASE(elasticEaseIn),
+	BENCH_EASE(elasticEaseOut),
+	BENCH_EASE(elasticEaseInOut),
+	BENCH_EASE(backEaseIn),
+	BENCH_EASE(backEaseOut),
+	BENCH_EASE(backEaseInOut),
+	BENCH_EASE(bounceEaseIn),
+	BENCH_EASE(bounceEaseOut),
+	BENCH_EASE(bounceEaseInOut),
+};
+
+BENCHMARK(jobsParallelFor) {
+	constexpr size_t Elements = 65536;
+	auto jobs = JobSystem();
+	auto data = vector<f32>(Elements, 1.0f);
+
+	for (auto _: state) {
+		jobs.parallelFor(Elements, 1024, [&](size_t const begin, size_t const end) {
+			for (size_t i = begin; i < end; i += 1)
+				data[i] = data[i] * 0.5f + 1.0f;
+		});
+		clobberMemory();
+	}
+	state.items = Elements;
+}
+
+BENCHMARK(rngRandInt) {
+	auto rng = Rng();
+	rng.seed(1);
+
+	u32 sum = 0;
+	for (auto _: state)
+		sum += rng.randInt(7);
+	doNotOptimize(sum);
+	state.items = 1;
+}
+
+BENCHMARK(rngRandFloat) {
+	auto rng = Rng();
+	rng.seed(1);
+
+	f32 sum = 0.0f;
+	for (auto _: state)
+		sum += rng.randFloat();
+	doNotOptimize(sum);
+	state.items = 1;
+}
@@ -0,0 +1,148 @@
+// Minote - bench/bench.cpp
+// Benchmark runner. Usage:
+//     minote-bench [--filter <substring>] [--min-time <seconds>] [--out <file>]
+// JSON results go to stdout, or to the --out file.
+
+#include "bench/bench.hpp"
+
+#include <thread>
+#include <cstdlib>
+#include <cstring>
+#include "base/array.hpp"
+#include "base/io.hpp"
+
+using namespace minote;
+
+using Benchmark = Registry<BenchFunc>::Entry;
+
+// Result of the final run of a benchmark
+struct BenchResult {
+
+	char const* name;
+	BenchState state;
+
+};
+
+// Run a benchmark with more and more iterations, until a run takes
+// at least minTime. The last run is the result.
+static auto benchRun(Benchmark const& bench, nsec const minTime) -> BenchState
+{
+	constexpr u64 MaxIterations = 1'000'000'000;
+
+	u64 iterations = 1;
+	while (true) {
+		auto state = BenchState(iterations);
+		bench.func(state);
+		if (!state.error.empty()) return state;
+		if (state.realTime >= minTime || iterations >= MaxIterations) return state;
+
+		// Aim 40% over the target, but don't grow more than 10x at a time
+		auto const perIteration = std::max(f64(state.realTime.count()) / f64(iterations), 1.0);
+		auto const predicted = u64(f64(minTime.count()) * 1.4 / perIteration);
+		iterations = std::clamp(predicted, iterations + 1, iterations * 10);
+		iterations = std::min(iterations, MaxIterations);
+	}
+}
+
+// Write a string as a JSON string literal.
+static void printJsonString(file& output, string_view const str)
+{
+	print(output, "\"");
+	for (char const ch: str) {
+		if (ch == '"' || ch == '\\')
+			print(output, "\\{}", ch);
+		else if (u8(ch) < 0x20)
+			print(output, "\\u{:04x}", int(ch));
+		else
+			print(output, "{}", ch);
+	}
+	print(output, "\"");
+}
+
+// Print results in the Google Benchmark JSON format.
+static void printResults(file& output, vector<BenchResult> const& results)
+{
+	auto const now = time(nullptr);
+	char date[32];
+	std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", localtime(&now));
+
+	print(output, "{{\n");
+	print(output, "  \"context\": {{\n");
+	print(output, "    \"date\": \"{}\",\n", date);
+	print(output, "    \"executable\": \"minote-bench\",\n");
+	print(output, "    \"num_cpus\": {},\n", std::thread::hardware_concurrency());
+#ifdef NDEBUG
+	print(output, "    \"library_build_type\": \"release\"\n");
+#else //NDEBUG
+	print(output, "    \"library_build_type\": \"debug\"\n");
+#endif //NDEBUG
+	print(output, "  }},\n");
+	print(output, "  \"benchmarks\": [\n");
+	for (size_t i = 0; i < results.size(); i += 1) {
+		auto const& [name, state] = results[i];
+		print(output, "    {{\n");
+		print(output, "      \"name\": ");
+		printJsonString(output, name);
+		print(output, ",\n      \"run_name\": ");
+		printJsonString(output, name);
+		print(output, ",\n      \"run_type\": \"iteration\",\n");
+		if (!state.error.empty()) {
+			print(output, "      \"error_occurred\": true,\n");
+			print(output, "      \"error_message\": ");
+			printJsonString(output, state.error);
+			print(output, "\n");
+		} else {
+			auto const iterations = f64(state.iterations);
+			print(output, "      \"iterations\": {},\n", state.iterations);
+			print(output, "      \"real_time\": {:.4f},\n", f64(state.realTime.count()) / iterations);
+			print(output, "      \"cpu_time\": {:.4f},\n", f64(state.cpuTime.count()) / iterations);
+			print(output, "      \"time_unit\": \"ns\"");
+			if (state.items && state.realTime.count()) {
+				auto const seconds = f64(state.realTime.count()) / 1'000'000'000.0;
+				print(output, ",\n      \"items_per_second\": {:.6e}",
+					f64(state.items) * iterations / seconds);
+			}
+			print(output, "\n");
+		}
+		print(output, "    }}{}\n", i + 1 < results.size()? "," : "");
+	}
+	print(output, "  ]\n");
+	print(output, "}}\n");
+}
+
+auto main(int argc, char* argv[]) -> int try {
+	auto filter = string_view();
+	auto minTime = milliseconds(250);
+	auto outPath = string_view();
+	for (int i = 1; i < argc; i += 1) {
+		auto const arg = string_view(argv[i]);
+		bool const hasValue = (i + 1 < argc);
+		if (arg == "--filter" && hasValue) {
+			filter = argv[++i];
+		} else if (arg == "--min-time" && hasValue) {
+			minTime = seconds(std::strtod(argv[++i], nullptr));
+		} else if (arg == "--out" && hasValue) {
+			outPath = argv[++i];
+		} else {
+			print(cerr, "Usage: {} [--filter <substring>] [--min-time <seconds>] [--out <file>]\n", argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+
+	auto results = vector<BenchResult>();
+	for (auto const& bench: Registry<BenchFunc>::matching(filter)) {
+		print(cerr, "Running {}...\n", bench.name);
+		results.push_back({bench.name, benchRun(bench, minTime)});
+	}
+
+	if (outPath.empty()) {
+		printResults(cout, results);
+	} else {
+		auto output = file(outPath, "w");
+		printResults(output, results);
+	}
+	return EXIT_SUCCESS;
+} catch (exception const& e) {
+	print(cerr, "Benchmark failed: {}\n", e.what());
+	return EXIT_FAILURE;
+}
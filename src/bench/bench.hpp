@@ -0,0 +1,110 @@
+// Minote - bench/bench.hpp
+// Minimal microbenchmark harness, modeled after Google Benchmark. A benchmark
+// is a function that runs its measured code in a loop over the BenchState:
+//
+//     BENCHMARK(ringPushPop) {
+//         for (auto _: state) { ... }
+//     }
+//
+// The iteration count is scaled up until a run takes long enough to be timed
+// reliably. Results are printed in Google Benchmark's JSON format, so that
+// existing tooling can compare them between runs.
+
+#pragma once
+
+#include <chrono>
+#include <ctime>
+#include "base/registry.hpp"
+#include "base/string.hpp"
+#include "base/util.hpp"
+#include "base/time.hpp"
+
+namespace minote {
+
+// Progress and timing of a single run of a benchmark
+struct BenchState {
+
+	struct Iterator {
+
+		BenchState* state;
+		u64 remaining;
+
+		// Value of the loop variable. Not meant to be used
+		struct [[maybe_unused]] Value {};
+
+		auto operator*() const -> Value { return {}; }
+		void operator++() { remaining -= 1; }
+
+		// Stops the timer once the loop is done
+		auto operator!=(Iterator const&) const -> bool {
+			if (remaining) [[likely]] return true;
+			state->pauseTiming();
+			return false;
+		}
+
+	};
+
+	explicit BenchState(u64 const _iterations): iterations{_iterations} {}
+
+	// Number of times the loop is going to run
+	u64 iterations;
+
+	// Number of items processed per iteration, for throughput. 0 if
+	// not applicable
+	u64 items = 0;
+
+	// If not empty, the benchmark couldn't run, and this is the reason
+	string error;
+
+	// Accumulated time of the measured parts of the run
+	nsec realTime = 0_s;
+	nsec cpuTime = 0_s;
+
+	// Start the timer and the loop. Anything before the loop is setup,
+	// and is not measured.
+	auto begin() -> Iterator {
+		resumeTiming();
+		return {this, iterations};
+	}
+	auto end() -> Iterator { return {this, 0}; }
+
+	// Exclude a section within the loop from measurement.
+	void pauseTiming() {
+		realTime += std::chrono::steady_clock::now() - realStart;
+		cpuTime += nsec{i64(f64(std::clock() - cpuStart) * 1'000'000'000.0 / CLOCKS_PER_SEC)};
+	}
+	void resumeTiming() {
+		cpuStart = std::clock();
+		realStart = std::chrono::steady_clock::now();
+	}
+
+	// Mark the benchmark as unable to run. It is reported with the message,
+	// and the loop must not be entered.
+	void skip(string_view reason) { error = reason; }
+
+private:
+
+	std::chrono::steady_clock::time_point realStart;
+	std::clock_t cpuStart = 0;
+
+};
+
+using BenchFunc = void(*)(BenchState&);
+
+// Prevent the compiler from optimizing out the computation of a value.
+template<typename T>
+inline void doNotOptimize(T const& value) {
+	asm volatile("" : : "r,m"(value) : "memory");
+}
+
+// Prevent the compiler from assuming that memory is unchanged between
+// iterations.
+inline void clobberMemory() {
+	asm volatile("" : : : "memory");
+}
+
+// Define a benchmark with the given name. The body receives "state".
+#define BENCHMARK(name) \
+	REGISTRY_ENTRY(::minote::BenchFunc, ::minote::BenchState, bench_, name)
+
+}
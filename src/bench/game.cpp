@@ -0,0 +1,371 @@
+// Minote - bench/game.cpp
+// Benchmarks of game logic, draw preparation and drawing. Benchmarks that
+// need GLFW or an OpenGL context create them on first use, and are skipped
+// if that fails, such as on a machine without a display.
+
+#include "bench/bench.hpp"
+
+#include <GLFW/glfw3.h>
+#include "glad/glad.h"
+#include "base/thread.hpp"
+#include "base/arena.hpp"
+#include "base/jobs.hpp"
+#include "base/array.hpp"
+#include "sys/window.hpp"
+#include "sys/glfw.hpp"
+#include "store/shaders.hpp"
+#include "store/models.hpp"
+#include "store/fonts.hpp"
+#include "engine/scene.hpp"
+#include "engine/model.hpp"
+#include "engine/mapper.hpp"
+#include "particles.hpp"
+#include "mrsdef.hpp"
+#include "mino.hpp"
+#include "text.hpp"
+#include "mrs.hpp"
+
+using namespace minote;
+
+// Windowing system and a hidden window with an OpenGL context
+struct BenchEnv {
+
+	optional<Glfw> glfw;
+	optional<Window> window;
+
+	// Reasons for GLFW or the context being unavailable
+	string glfwError;
+	string contextError;
+
+	// Whether the window's context is active on the main thread
+	bool active = false;
+
+	~BenchEnv() {
+		if (active)
+			window->deactivateContext();
+	}
+
+};
+
+// Create GLFW and the context, as far as possible. Only attempted once.
+static auto benchEnv() -> BenchEnv&
+{
+	static auto env = BenchEnv();
+	static bool attempted = false;
+	if (attempted) return env;
+	attempted = true;
+
+	try {
+		env.glfw.emplace();
+	} catch (exception const& e) {
+		env.glfwError = e.what();
+		env.contextError = e.what();
+		return env;
+	}
+	try {
+		env.window.emplace(*env.glfw, "Minote benchmark", false, uvec2{256, 256}, false);
+		env.window->activateContext();
+		env.active = true;
+		if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+			throw runtime_error{"Failed to initialize OpenGL"};
+	} catch (exception const& e) {
+		env.contextError = e.what();
+	}
+	return env;
+}
+
+// Skip the benchmark if GLFW is unavailable. Returns true if skipped.
+static auto requireGlfw(BenchState& state) -> bool
+{
+	auto const& env = benchEnv();
+	if (env.glfwError.empty()) return false;
+	state.skip(format("GLFW unavailable: {}", env.glfwError));
+	return true;
+}
+
+// Skip the benchmark if the OpenGL context is unavailable. Returns true
+// if skipped.
+static auto requireContext(BenchState& state) -> bool
+{
+	auto const& env = benchEnv();
+	if (env.contextError.empty()) return false;
+	state.skip(format("OpenGL context unavailable: {}", env.contextError));
+	return true;
+}
+
+// Create a playfield with a ragged stack in the bottom half.
+static auto benchField() -> Field*
+{
+	auto* const field = fieldCreate({FieldWidth, FieldHeight});
+	for (int y = 0; y < int(FieldHeight / 2); y += 1) {
+		for (int x = 0; x < int(FieldWidth); x += 1) {
+			if ((x * 7 + y * 3) % 5 != 0)
+				fieldSet(field, {x, y}, MinoGarbage);
+		}
+	}
+	return field;
+}
+
+BENCHMARK(pieceOverlapsField) {
+	auto* const field = benchField();
+	defer { fieldDestroy(field); };
+
+	// Test every piece against every position
+	size_t type = MinoI;
+	ivec2 pos = {0, 0};
+	u32 overlaps = 0;
+	for (auto _: state) {
+		overlaps += pieceOverlapsField(&MrsPieces[type], pos, field);
+		pos.x += 1;
+		if (pos.x >= int(FieldWidth)) {
+			pos.x = 0;
+			pos.y = (pos.y + 1) % FieldHeight;
+			type = (type % (MinoGarbage - 1)) + 1;
+		}
+	}
+	doNotOptimize(overlaps);
+	state.items = 1;
+}
+
+BENCHMARK(fieldDropRow) {
+	auto* const field = benchField();
+	defer { fieldDestroy(field); };
+
+	int row = 0;
+	for (auto _: state) {
+		fieldDropRow(field, row);
+		row = (row + 1) % (FieldHeight / 2);
+		clobberMemory();
+	}
+	state.items = 1;
+}
+
+BENCHMARK(mrsAdvance) {
+	if (requireGlfw(state)) return;
+
+	// A game is played for this many ticks before it's restarted
+	constexpr u64 GameLength = 3600;
+
+	// Inputs are pressed and released on a fixed schedule, so that pieces
+	// move, rotate and drop
+	constexpr auto Script = array{
+		Action::Type::Left, Action::Type::RotCW, Action::Type::Right,
+		Action::Type::Right, Action::Type::RotCCW, Action::Type::Drop,
+		Action::Type::Left, Action::Type::Lock};
+	auto inputs = array<Action, 2>();
+
+	particlesInit();
+	mrsInit();
+	u64 tick = 0;
+	for (auto _: state) {
+		tick += 1;
+		if (tick % GameLength == 0) {
+			state.pauseTiming();
+			mrsCleanup();
+			particlesCleanup();
+			particlesInit();
+			mrsInit();
+			state.resumeTiming();
+		}
+
+		// Release the previous input and press the next one every 8 ticks
+		size_t count = 0;
+		if (tick % 8 == 0) {
+			auto const step = tick / 8;
+			inputs[0] = {Script[(step - 1) % Script.size()], Action::State::Released, 0_s};
+			inputs[1] = {Script[step % Script.size()], Action::State::Pressed, 0_s};
+			count = 2;
+		}
+		mrsAdvance({inputs.data(), count});
+		particlesUpdate();
+	}
+	mrsCleanup();
+	particlesCleanup();
+	state.items = 1;
+}
+
+BENCHMARK(particlesQueue) {
+	if (requireGlfw(state)) return;
+
+	constexpr size_t Particles = 1024;
+	auto params = ParticleParams{
+		.color = {0.6f, 0.6f, 0.6f, 0.8f},
+		.durationMin = 1000_s,
+		.durationMax = 2000_s,
+		.distanceMin = 0.2f,
+		.distanceMax = 1.2f,
+		.spinMin = 0.4f,
+		.spinMax = 1.6f,
+		.directionVert = 0,
+		.directionHorz = 0,
+		.ease = exponentialEaseOut};
+
+	particlesInit();
+	particlesGenerate({0.0f, 0.0f, 0.0f}, Particles, &params);
+	auto arena = Arena("bench");
+	auto jobs = JobSystem();
+	size_t instances = 0;
+	for (auto _: state) {
+		arena.reset();
+		instances += particlesQueue(arena, jobs);
+	}
+	doNotOptimize(instances);
+	particlesCleanup();
+	state.items = Particles;
+}
+
+BENCHMARK(textQueue) {
+	if (requireContext(state)) return;
+
+	// Restart the text layer every this many strings, to discard the queue
+	constexpr u64 Batch = 256;
+
+	Fonts fonts;
+	auto& font = fonts["jost"_id];
+	textInit();
+
+	// Let the generator finish the glyphs
+	for (size_t i = 0; i < 50; i += 1) {
+		textQueue(font, 1.0f, {0.0f, 0.0f, 0.0f}, {1.0f, 1.0f, 1.0f, 1.0f},
+			"Score: %d Level: %d", 123456, 999);
+		fonts.update();
+		textCleanup();
+		textInit();
+		sleepFor(2_ms);
+	}
+
+	u64 count = 0;
+	for (auto _: state) {
+		textQueue(font, 1.0f, {0.0f, 0.0f, 0.0f}, {1.0f, 1.0f, 1.0f, 1.0f},
+			"Score: %d Level: %d", 123456, 999);
+		count += 1;
+		if (count % Batch == 0) {
+			state.pauseTiming();
+			textCleanup();
+			textInit();
+			state.resumeTiming();
+		}
+	}
+	textCleanup();
+	state.items = 1;
+}
+
+// Number of blocks drawn by the Phong benchmarks
+constexpr size_t PhongBlocks = 4096;
+
+// Phong vertex shader with the normal matrix computed for every vertex,
+// to compare against the per-instance normal matrices of phong.vert
+static constexpr GLchar PhongVertexInverseVert[] = R"(#version 330 core
+
+layout(location = 0) in vec3 vPosition;
+layout(location = 1) in vec4 vColor;
+layout(location = 2) in vec3 vNormal;
+layout(location = 3) in vec4 iTint;
+layout(location = 4) in vec4 iHighlight;
+layout(location = 5) in mat4 iModel;
+
+out vec3 fPosition;
+out vec4 fColor;
+out vec4 fHighlight;
+out vec3 fNormal;
+out vec3 fLightPosition;
+
+uniform mat4 view;
+uniform mat4 projection;
+uniform vec3 lightPosition;
+
+void main()
+{
+    mat4 modelView = view * iModel;
+    vec4 viewPosition = modelView * vec4(vPosition, 1.0);
+    gl_Position = projection * viewPosition;
+    fPosition = vec3(viewPosition);
+    fNormal = mat3(transpose(inverse(modelView))) * vNormal;
+    fColor = vColor * iTint;
+    fHighlight = iHighlight;
+    fLightPosition = vec3(view * vec4(lightPosition, 1.0));
+}
+)";
+static constexpr GLchar PhongFrag[] =
+#include "phong.frag"
+	;
+
+// A wall of rotated blocks in front of the default camera.
+static auto benchPhongInstances() -> vector<ModelPhong::Instance>
+{
+	auto result = vector<ModelPhong::Instance>(PhongBlocks);
+	for (size_t i = 0; i < PhongBlocks; i += 1) {
+		auto const x = f32(i % 64) * 0.5f - 16.0f;
+		auto const y = f32(i / 64) * 0.375f;
+		result[i].transform = make_translate(vec3{x, y, 0.0f}) *
+			make_rotate(f32(i) * 0.1f, normalize(vec3{1.0f, 2.0f, 3.0f})) *
+			make_scale(vec3{0.25f, 0.25f, 0.25f});
+	}
+	return result;
+}
+
+// Draw the blocks with phong.vert, or with another vertex shader if vertSrc
+// is not nullptr. The GPU is waited on every iteration. Blocks cover few
+// pixels, so vertex processing dominates.
+static void benchPhongDraw(BenchState& state, GLchar const* const vertSrc)
+{
+	if (requireContext(state)) return;
+
+	Shaders shaders;
+	Models models{shaders};
+	Shaders::Phong variant;
+	if (vertSrc) {
+		variant.create("phongVariant", vertSrc, PhongFrag);
+		models.block.drawcall.shader = &variant;
+	}
+	defer {
+		models.block.drawcall.shader = &shaders.phong;
+		if (variant.id)
+			variant.destroy();
+	};
+
+	auto const size = uvec2{256, 256};
+	Scene scene;
+	scene.updateMatrices(size);
+	auto const instances = benchPhongInstances();
+	auto const params = DrawParams{.viewport = {.size = size}};
+
+	for (auto _: state) {
+		models.block.draw(nullptr, scene, params, instances);
+		glFinish();
+	}
+	state.items = PhongBlocks;
+}
+
+BENCHMARK(phongDrawInstanceNormals) {
+	benchPhongDraw(state, nullptr);
+}
+
+BENCHMARK(phongDrawVertexInverse) {
+	benchPhongDraw(state, PhongVertexInverseVert);
+}
+
+BENCHMARK(phongNormalMatrix) {
+	auto const instances = benchPhongInstances();
+	Scene scene;
+	scene.updateMatrices({256, 256});
+
+	for (auto _: state) {
+		for (auto const& instance: instances)
+			doNotOptimize(phongNormalMatrix(scene.view * instance.transform));
+	}
+	state.items = PhongBlocks;
+}
+
+BENCHMARK(phongNormalMatrixInverse) {
+	auto const instances = benchPhongInstances();
+	Scene scene;
+	scene.updateMatrices({256, 256});
+
+	// Same as phongNormalMatrix without the shortcut for uniform scale
+	for (auto _: state) {
+		for (auto const& instance: instances)
+			doNotOptimize(transpose(inverse(mat3(scene.view * instance.transform))));
+	}
+	state.items = PhongBlocks;
+}
@@ -5,25 +5,19 @@
 
 #include "bloom.hpp"
 
-#include "glad/glad.h"
-#include "sys/window.hpp"
 #include "sys/opengl/framebuffer.hpp"
 #include "sys/opengl/texture.hpp"
 #include "sys/opengl/shader.hpp"
 #include "sys/opengl/draw.hpp"
+#include "engine/rendergraph.hpp"
+#include "base/array.hpp"
 #include "base/util.hpp"
 #include "base/log.hpp"
 #include "store/shaders.hpp"
 
 using namespace minote;
 
-#define BloomPasses 6
-
-static Framebuffer bloomFb[BloomPasses];
-static Texture<PixelFmt::RGBA_f16> bloomFbColor[BloomPasses];
-
-static Draw<Shaders::Threshold> threshold {
-	.framebuffer = &bloomFb[0],
+static Draw<Shaders::BloomDown> down {
 	.triangles = 1,
 	.params = {
 		.culling = false,
@@ -31,16 +25,7 @@ static Draw<Shaders::Threshold> threshold {
 	}
 };
 
-static Draw<Shaders::BoxBlur> boxBlur {
-	.triangles = 1,
-	.params = {
-		.blendingMode = {BlendingOp::One, BlendingOp::One},
-		.culling = false,
-		.depthTesting = false
-	}
-};
-
-static Draw<Shaders::Blit> blit {
+static Draw<Shaders::BloomUp> up {
 	.triangles = 1,
 	.params = {
 		.blending = true,
@@ -50,118 +35,100 @@ static Draw<Shaders::Blit> blit {
 	}
 };
 
-static uvec2 currentSize {0};
-static bool initialized = false;
+static BloomQuality quality = BloomQuality::High;
+
+/// Pass names of each level of the chain, so that levels can be told apart
+/// in GPU timings. The first downsample also applies the threshold
+static constexpr array<char const*, BloomMaxLevels> BloomDownNames = {
+	"bloomThreshold", "bloomDown1", "bloomDown2", "bloomDown3", "bloomDown4"};
+static constexpr array<char const*, BloomMaxLevels> BloomUpNames = {
+	"bloomUp0", "bloomUp1", "bloomUp2", "bloomUp3", "bloomUp4"};
 
 /**
- * Ensure that AA framebuffers are the correct size in relation to the screen.
- * This can be run every frame with the current size of the screen.
- * @param size Current screen size
+ * Record the passes of the bloom chain, adding the result to the frame.
+ * Must match bloomReference().
+ * @param engine Engine state
+ * @param levels Number of levels of the chain
  */
-static void bloomResize(uvec2 size)
+template<PixelFmt F>
+static void bloomRecord(Engine& engine, size_t const levels)
 {
-	ASSERT(size.x > 0);
-	ASSERT(size.y > 0);
-	if (size.x == currentSize.x && size.y == currentSize.y) return;
-	currentSize.x = size.x;
-	currentSize.y = size.y;
-
-	for (size_t i = 0; i < BloomPasses; i += 1) {
-		uvec2 layerSize = {
-			size.x >> (i + 1),
-			size.y >> (i + 1)
-		};
-		bloomFbColor[i].resize(layerSize);
+	auto& frame = engine.frame;
+	auto& graph = frame.graph;
+	uvec2 const size = frame.size;
+	down.shader = &engine.shaders.bloomDown;
+	up.shader = &engine.shaders.bloomUp;
+
+	array<RenderGraph::ResourceID, BloomMaxLevels> level = {};
+	for (size_t i = 0; i < levels; i += 1) {
+		level[i] = graph.create("bloomLevel", {
+			.format = F,
+			.size = bloomLevelSize(size, i)});
 	}
-}
-
-void bloomInit(Window& window)
-{
-	if (initialized) return;
-	uvec2 windowSize = window.size();
 
-	for (size_t i = 0; i < BloomPasses; i += 1) {
-		uvec2 layerSize = {
-			windowSize.x >> (i + 1),
-			windowSize.y >> (i + 1)
-		};
-		bloomFb[i].create("bloomFb");
-		bloomFbColor[i].create("bloomFbColor", layerSize);
+	// Downsample the image, applying the threshold on the first pass
+	for (size_t i = 0; i < levels; i += 1) {
+		auto const source = (i == 0)? frame.color : level[i - 1];
+		auto const pass = graph.addPass(BloomDownNames[i], [&graph, level, source, size, i](Framebuffer* const fb) {
+			down.framebuffer = fb;
+			down.params.viewport = {.size = bloomLevelSize(size, i)};
+			if (i == 0) {
+				auto& image = graph.texture<PixelFmt::RGBA_f16>(source);
+				down.shader->image = image;
+				down.shader->imageTexel = 1.0f / vec2(image.size);
+			} else {
+				auto& image = graph.texture<F>(source);
+				down.shader->image = image;
+				down.shader->imageTexel = 1.0f / vec2(image.size);
+			}
+			down.shader->imageScale = graph.textureScale(source);
+			down.shader->prefilter = (i == 0);
+			down.shader->threshold = BloomThreshold;
+			down.shader->softKnee = BloomSoftKnee;
+			down.draw();
+		});
+		graph.read(pass, source);
+		graph.write(pass, level[i]);
 	}
 
-	bloomResize(windowSize);
-
-	for (size_t i = 0; i < BloomPasses; i += 1)
-		bloomFb[i].attach(bloomFbColor[i], Attachment::Color0);
-
-	initialized = true;
-}
-
-void bloomCleanup(void)
-{
-	if (!initialized) return;
-
-	for (size_t i = BloomPasses - 1; i < BloomPasses; i -= 1) {
-		bloomFbColor[i].destroy();
-		bloomFb[i].destroy();
+	// Upsample back, accumulating all levels. The last pass draws the bloom
+	// on top of the render
+	for (size_t i = levels - 1; i < levels; i -= 1) {
+		auto const target = (i == 0)? frame.color : level[i - 1];
+		auto const pass = graph.addPass(BloomUpNames[i], [&graph, level, size, i](Framebuffer* const fb) {
+			up.framebuffer = fb;
+			up.params.viewport = {.size = (i == 0)? size : bloomLevelSize(size, i - 1)};
+			auto& image = graph.texture<F>(level[i]);
+			up.shader->image = image;
+			up.shader->imageTexel = 1.0f / vec2(image.size);
+			up.shader->imageScale = graph.textureScale(level[i]);
+			up.shader->strength = (i == 0)? BloomStrength : 1.0f;
+			up.draw();
+		});
+		graph.read(pass, level[i]);
+		graph.read(pass, target);
+		graph.write(pass, target);
 	}
-
-	initialized = false;
 }
 
 void bloomApply(Engine& engine)
 {
-	ASSERT(initialized);
-	bloomResize(engine.window.size());
+	ASSERT(engine.frame.resolved);
 
-	threshold.shader = &engine.shaders.threshold;
-	boxBlur.shader = &engine.shaders.boxBlur;
-	blit.shader = &engine.shaders.blit;
-	blit.framebuffer = engine.frame.fb;
-
-	// Prepare the image for bloom
-	threshold.params.viewport = {.size = {currentSize.x >> 1, currentSize.y >> 1}};
-	threshold.shader->image = engine.frame.color;
-	threshold.shader->threshold = 1.0f;
-	threshold.shader->softKnee = 0.25f;
-	threshold.shader->strength = 1.0f;
-	threshold.draw();
+	if (quality == BloomQuality::High)
+		bloomRecord<PixelFmt::RGBA_f16>(engine, bloomLevels(quality));
+	else if (quality == BloomQuality::Low)
+		bloomRecord<PixelFmt::RGB_f11f11f10>(engine, bloomLevels(quality));
+}
 
-	// Blur the bloom image
-	for (size_t i = 0; i < BloomPasses - 1; i += 1) {
-		boxBlur.framebuffer = &bloomFb[i + 1];
-		boxBlur.params.viewport = {.size = {
-			currentSize.x >> (i + 2),
-			currentSize.y >> (i + 2)
-		}};
-		boxBlur.params.blending = false;
-		boxBlur.shader->image = bloomFbColor[i];
-		boxBlur.shader->step = 1.0f;
-		boxBlur.shader->imageTexel = {
-			1.0 / (float)(currentSize.x >> (i + 1)),
-			1.0 / (float)(currentSize.y >> (i + 1))
-		};
-		boxBlur.draw();
-	}
-	for (size_t i = BloomPasses - 2; i < BloomPasses; i -= 1) {
-		boxBlur.framebuffer = &bloomFb[i];
-		boxBlur.params.viewport = {.size = {
-			currentSize.x >> (i + 1),
-			currentSize.y >> (i + 1)
-		}};
-		boxBlur.params.blending = true;
-		boxBlur.shader->image = bloomFbColor[i + 1];
-		boxBlur.shader->step = 0.5f;
-		boxBlur.shader->imageTexel = {
-			1.0 / (float)(currentSize.x >> (i + 2)),
-			1.0 / (float)(currentSize.y >> (i + 2))
-		};
-		boxBlur.draw();
-	}
+void bloomSetQuality(BloomQuality const _quality)
+{
+	if (quality == _quality) return;
+	quality = _quality;
+	L.info("Bloom quality changed to {}", +quality);
+}
 
-	// Draw the bloom on top of the render
-	blit.shader->image = bloomFbColor[0];
-	blit.shader->boost = 1.0f;
-	blit.params.viewport = {.size = engine.window.size()};
-	blit.draw();
+auto bloomGetQuality(void) -> BloomQuality
+{
+	return quality;
 }
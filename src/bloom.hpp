@@ -6,23 +6,26 @@
 #ifndef MINOTE_BLOOM_H
 #define MINOTE_BLOOM_H
 
-#include "sys/window.hpp"
 #include "engine/engine.hpp"
+#include "bloomfilter.hpp"
 
 /**
- * Initialize the bloom filter. Must be called after rendererInit().
+ * Apply the bloom effect, by recording its passes into the frame's render
+ * graph. Must be called after the frame's antialiasing is resolved.
  */
-void bloomInit(minote::Window& window);
+void bloomApply(minote::Engine& engine);
 
 /**
- * Cleanup the bloom filter. No other bloom functions can be used until
- * bloomInit() is called again.
+ * Change the quality tier of the bloom effect. Takes effect on the next
+ * bloomApply().
+ * @param quality New quality tier
  */
-void bloomCleanup(void);
+void bloomSetQuality(minote::BloomQuality quality);
 
 /**
- * Apply the bloom effect.
+ * Get the current quality tier of the bloom effect.
+ * @return Quality tier
  */
-void bloomApply(minote::Engine& engine);
+auto bloomGetQuality(void) -> minote::BloomQuality;
 
 #endif //MINOTE_BLOOM_H
@@ -0,0 +1,104 @@
+#include "bloomfilter.hpp"
+
+namespace minote {
+
+// Read a pixel of an image with coordinates clamped to its edges.
+static auto texel(span<vec3 const> const image, uvec2 const size, ivec2 pos) -> vec3
+{
+	pos = clamp(pos, ivec2{0, 0}, ivec2(size) - 1);
+	return image[pos.y * size.x + pos.x];
+}
+
+// Sample an image like a texture with GL_LINEAR and GL_CLAMP_TO_EDGE.
+static auto sample(span<vec3 const> const image, uvec2 const size, vec2 const uv) -> vec3
+{
+	vec2 const pos = uv * vec2(size) - 0.5f;
+	vec2 const base = floor(pos);
+	vec2 const frac = pos - base;
+	ivec2 const p = ivec2(base);
+	return mix(
+		mix(texel(image, size, p), texel(image, size, p + ivec2{1, 0}), frac.x),
+		mix(texel(image, size, p + ivec2{0, 1}), texel(image, size, p + ivec2{1, 1}), frac.x),
+		frac.y);
+}
+
+// Same as bloomDown.frag.glsl's threshold curve.
+static auto prefilter(vec3 const color) -> vec3
+{
+	f32 const brightness = max(color.r, max(color.g, color.b));
+	f32 const knee = BloomThreshold * BloomSoftKnee;
+	f32 soft = brightness - BloomThreshold + knee;
+	soft = clamp(soft, 0.0f, 2.0f * knee);
+	soft = soft * soft / (4.0f * knee + 0.00001f);
+	f32 contribution = max(soft, brightness - BloomThreshold);
+	contribution /= max(brightness, 0.00001f);
+	return color * contribution;
+}
+
+// Same as bloomDown.frag.glsl. The output image is overwritten.
+static void downsample(span<vec3 const> const src, uvec2 const srcSize,
+	span<vec3> const dst, uvec2 const dstSize, bool const applyThreshold)
+{
+	vec2 const texelSize = 1.0f / vec2(srcSize);
+	vec2 const diagonal = {texelSize.x, -texelSize.y};
+	for (u32 y = 0; y < dstSize.y; y += 1)
+	for (u32 x = 0; x < dstSize.x; x += 1) {
+		vec2 const uv = (vec2{x, y} + 0.5f) / vec2(dstSize);
+		vec3 color = sample(src, srcSize, uv) * 4.0f;
+		color += sample(src, srcSize, uv - texelSize);
+		color += sample(src, srcSize, uv + texelSize);
+		color += sample(src, srcSize, uv + diagonal);
+		color += sample(src, srcSize, uv - diagonal);
+		color /= 8.0f;
+		dst[y * dstSize.x + x] = applyThreshold ? prefilter(color) : color;
+	}
+}
+
+// Same as bloomUp.frag.glsl. The result is added to the output image.
+static void upsample(span<vec3 const> const src, uvec2 const srcSize,
+	span<vec3> const dst, uvec2 const dstSize, f32 const strength)
+{
+	vec2 const texelSize = 1.0f / vec2(srcSize);
+	vec2 const halfTexel = texelSize * 0.5f;
+	vec2 const diagonal = {halfTexel.x, -halfTexel.y};
+	for (u32 y = 0; y < dstSize.y; y += 1)
+	for (u32 x = 0; x < dstSize.x; x += 1) {
+		vec2 const uv = (vec2{x, y} + 0.5f) / vec2(dstSize);
+		vec3 color = {0.0f, 0.0f, 0.0f};
+		color += sample(src, srcSize, uv + vec2{texelSize.x, 0.0f});
+		color += sample(src, srcSize, uv - vec2{texelSize.x, 0.0f});
+		color += sample(src, srcSize, uv + vec2{0.0f, texelSize.y});
+		color += sample(src, srcSize, uv - vec2{0.0f, texelSize.y});
+		color += sample(src, srcSize, uv + halfTexel) * 2.0f;
+		color += sample(src, srcSize, uv - halfTexel) * 2.0f;
+		color += sample(src, srcSize, uv + diagonal) * 2.0f;
+		color += sample(src, srcSize, uv - diagonal) * 2.0f;
+		color /= 12.0f;
+		dst[y * dstSize.x + x] += color * strength;
+	}
+}
+
+void bloomReference(span<vec3> const image, uvec2 const size, BloomQuality const quality)
+{
+	ASSERT(size.x > 0 && size.y > 0);
+	ASSERT(image.size() == size.x * size.y);
+
+	size_t const levels = bloomLevels(quality);
+	if (!levels) return;
+
+	array<vector<vec3>, BloomMaxLevels> chain;
+	array<uvec2, BloomMaxLevels> sizes;
+	for (size_t i = 0; i < levels; i += 1) {
+		sizes[i] = bloomLevelSize(size, i);
+		chain[i].resize(sizes[i].x * sizes[i].y);
+	}
+
+	downsample(image, size, chain[0], sizes[0], true);
+	for (size_t i = 1; i < levels; i += 1)
+		downsample(chain[i - 1], sizes[i - 1], chain[i], sizes[i], false);
+	for (size_t i = levels - 1; i > 0; i -= 1)
+		upsample(chain[i], sizes[i], chain[i - 1], sizes[i - 1], 1.0f);
+	upsample(chain[0], sizes[0], image, size, BloomStrength);
+}
+
+}
@@ -0,0 +1,59 @@
+// Minote - bloomfilter.hpp
+// Parameters of the dual filter bloom chain, shared by the GPU implementation
+// and a CPU reference of the filter that can run headless, for comparing
+// output against golden images
+
+#pragma once
+
+#include <algorithm>
+#include "base/array.hpp"
+#include "base/math.hpp"
+#include "base/util.hpp"
+
+namespace minote {
+
+// Bloom quality tier, trading blur radius and precision for speed
+enum struct BloomQuality {
+	Off,  // No bloom
+	Low,  // 3 levels, R11G11B10F
+	High, // 5 levels, RGBA16F
+};
+
+// Maximum number of levels of the bloom chain
+constexpr size_t BloomMaxLevels = 5;
+
+// Brightness curve that selects pixels to bloom
+constexpr f32 BloomThreshold = 1.0f;
+constexpr f32 BloomSoftKnee = 0.25f;
+
+// Multiplier of the bloom added to the image
+constexpr f32 BloomStrength = 1.0f;
+
+// Number of levels of the bloom chain. Level n is 2^(n+1) times smaller than
+// the image, and costs one downsample and one upsample pass.
+constexpr auto bloomLevels(BloomQuality const quality) -> size_t
+{
+	switch (quality) {
+	case BloomQuality::Off: return 0;
+	case BloomQuality::Low: return 3;
+	case BloomQuality::High: return BloomMaxLevels;
+	default: return 0;
+	}
+}
+
+// Size of a bloom chain level, never smaller than 1x1.
+constexpr auto bloomLevelSize(uvec2 const size, size_t const level) -> uvec2
+{
+	return {
+		std::max(size.x >> (level + 1), 1u),
+		std::max(size.y >> (level + 1), 1u)
+	};
+}
+
+// Apply bloom to a linear HDR image on the CPU, performing the same passes and
+// samples as the shaders (without the precision loss of the texture formats).
+// The image is stored row by row, bottom row first, and is modified in place.
+// Slow; meant for tests and tools only.
+void bloomReference(span<vec3> image, uvec2 size, BloomQuality quality);
+
+}
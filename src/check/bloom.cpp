@@ -0,0 +1,107 @@
+// Minote - check/bloom.cpp
+// Checks of the CPU reference of the bloom filter. Images with a known result
+// are filtered: the threshold curve has a closed form, and every pass of
+// the chain preserves a uniform image.
+
+#include "check/check.hpp"
+
+#include <algorithm>
+#include "base/array.hpp"
+#include "base/math.hpp"
+#include "bloomfilter.hpp"
+
+using namespace minote;
+
+// Not a power of two, and not square
+constexpr auto Size = uvec2{64, 36};
+
+// Relative error allowed from the accumulation of filter passes
+constexpr auto Tolerance = 1e-4f;
+
+static auto near(f32 const value, f32 const expected) -> bool
+{
+	return abs(value - expected) <= Tolerance * max(1.0f, abs(expected));
+}
+
+// Check that every pixel of an image is close to the expected color.
+static auto allNear(span<vec3 const> const image, vec3 const expected) -> bool
+{
+	return std::all_of(image.begin(), image.end(), [=](vec3 const color) {
+		return near(color.r, expected.r) &&
+			near(color.g, expected.g) &&
+			near(color.b, expected.b);
+	});
+}
+
+CHECK(bloomOff) {
+	auto image = vector<vec3>(Size.x * Size.y);
+	for (size_t i = 0; i < image.size(); i += 1)
+		image[i] = vec3{f32(i % 7), f32(i % 5), f32(i % 3)};
+	auto const original = image;
+
+	bloomReference(image, Size, BloomQuality::Off);
+	EXPECT(image == original);
+}
+
+CHECK(bloomBelowThreshold) {
+	// Below the soft knee nothing blooms
+	auto const dim = vec3{0.5f, 0.5f, 0.5f};
+	for (auto const quality: {BloomQuality::Low, BloomQuality::High}) {
+		auto image = vector<vec3>(Size.x * Size.y, dim);
+		bloomReference(image, Size, quality);
+		EXPECT(allNear(image, dim));
+	}
+}
+
+CHECK(bloomUniform) {
+	// Brightness 2 is past the knee, so the threshold leaves 2 - 1 = 1.
+	// Each level of the chain adds that once.
+	for (auto const quality: {BloomQuality::Low, BloomQuality::High}) {
+		auto image = vector<vec3>(Size.x * Size.y, vec3{2.0f, 2.0f, 2.0f});
+		bloomReference(image, Size, quality);
+		auto const expected = 2.0f + f32(bloomLevels(quality));
+		EXPECT(allNear(image, vec3{expected, expected, expected}));
+	}
+}
+
+CHECK(bloomHue) {
+	// Threshold scales the color by (3 - 1) / 3, keeping the hue
+	auto image = vector<vec3>(Size.x * Size.y, vec3{3.0f, 0.0f, 0.0f});
+	bloomReference(image, Size, BloomQuality::High);
+	auto const expected = 3.0f + 2.0f * f32(bloomLevels(BloomQuality::High));
+	EXPECT(allNear(image, vec3{expected, 0.0f, 0.0f}));
+}
+
+CHECK(bloomSpot) {
+	// A bright square in the middle spreads evenly in all directions
+	auto const size = uvec2{64, 64};
+	auto image = vector<vec3>(size.x * size.y, vec3{0.0f, 0.0f, 0.0f});
+	auto const at = [&](u32 x, u32 y) -> vec3& { return image[y * size.x + x]; };
+	for (u32 y = 30; y < 34; y += 1)
+	for (u32 x = 30; x < 34; x += 1)
+		at(x, y) = vec3{100.0f, 100.0f, 100.0f};
+
+	bloomReference(image, size, BloomQuality::High);
+
+	auto symmetric = true;
+	auto nonnegative = true;
+	for (u32 y = 0; y < size.y; y += 1)
+	for (u32 x = 0; x < size.x; x += 1) {
+		auto const value = at(x, y).r;
+		symmetric = symmetric &&
+			near(value, at(size.x - 1 - x, y).r) &&
+			near(value, at(x, size.y - 1 - y).r) &&
+			near(value, at(y, x).r);
+		nonnegative = nonnegative && value >= 0.0f;
+	}
+	EXPECT(symmetric);
+	EXPECT(nonnegative);
+
+	// Bloom falls off with distance, but reaches past the square
+	auto falloff = true;
+	for (u32 x = 34; x < size.x; x += 1)
+		falloff = falloff && at(x, 32).r <= at(x - 1, 32).r;
+	EXPECT(falloff);
+	EXPECT(at(33, 32).r > 100.0f);
+	EXPECT(at(40, 32).r > 0.0f);
+}
@@ -0,0 +1,40 @@
+// Minote - check/check.cpp
+// Runs the checks whose names contain the filter, or all of them:
+//     minote-check [<filter>]
+// Exits with failure if any check failed.
+
+#include "check/check.hpp"
+
+#include <cstdlib>
+#include "base/io.hpp"
+
+using namespace minote;
+
+void CheckState::fail(char const* const expr, char const* const file, int const line)
+{
+	print(cerr, "  {}:{}: expected {}\n", file, line, expr);
+	failures += 1;
+}
+
+auto main(int argc, char* argv[]) -> int try {
+	if (argc > 2) {
+		print(cerr, "Usage: {} [<filter>]\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	auto const checks = Registry<CheckFunc>::matching(argc == 2? argv[1] : "");
+	size_t failed = 0;
+	for (auto const& check: checks) {
+		auto state = CheckState();
+		check.func(state);
+		print(cerr, "{}: {}\n", check.name, state.failures? "FAILED" : "ok");
+		if (state.failures)
+			failed += 1;
+	}
+
+	print(cerr, "{} of {} checks passed\n", checks.size() - failed, checks.size());
+	return failed? EXIT_FAILURE : EXIT_SUCCESS;
+} catch (exception const& e) {
+	print(cerr, "Check threw an exception: {}\n", e.what());
+	return EXIT_FAILURE;
+}
@@ -0,0 +1,36 @@
+// Minote - check/check.hpp
+// Pass/fail checks of code that doesn't need a window, run by minote-check
+// and ctest. A check states expectations, and each false one is a failure:
+//
+//     CHECK(framegraphCulling) {
+//         EXPECT(graph.alivePasses() == 2);
+//     }
+
+#pragma once
+
+#include "base/registry.hpp"
+#include "base/util.hpp"
+
+namespace minote {
+
+// Failures of the check being run
+struct CheckState {
+
+	u32 failures = 0;
+
+	// Print the location and expression of a false expectation.
+	void fail(char const* expr, char const* file, int line);
+
+};
+
+using CheckFunc = void(*)(CheckState&);
+
+// Define a check with the given name. The body receives "state".
+#define CHECK(name) \
+	REGISTRY_ENTRY(::minote::CheckFunc, ::minote::CheckState, check_, name)
+
+// Record a failure if the condition is false, and continue with the check.
+#define EXPECT(cond) \
+	((cond)? void() : state.fail(#cond, __FILE__, __LINE__))
+
+}
@@ -0,0 +1,174 @@
+// Minote - check/framegraph.cpp
+// Checks of the frame graph compiler: pass culling, resource lifetimes
+// and aliasing of physical resources
+
+#include "check/check.hpp"
+
+#include "base/string.hpp"
+#include "base/array.hpp"
+#include "engine/framegraph.hpp"
+
+using namespace minote;
+
+// Resources with equal descs can alias
+using Graph = FrameGraph<u32>;
+
+// Names of the passes that survived culling, in order of execution.
+static auto alivePassNames(Graph const& graph) -> vector<string_view>
+{
+	auto result = vector<string_view>();
+	for (auto const& pass: graph.passes)
+		if (pass.alive) result.emplace_back(pass.name);
+	return result;
+}
+
+CHECK(framegraphCulling) {
+	auto graph = Graph();
+	auto const backbuffer = graph.importResource("backbuffer");
+	auto const scene = graph.create("scene", 0);
+	auto const unused = graph.create("unused", 0);
+	auto const debug = graph.create("debug", 1);
+
+	auto const draw = graph.addPass("draw");
+	graph.write(draw, scene);
+	auto const dead = graph.addPass("dead");
+	graph.read(dead, scene);
+	graph.write(dead, unused);
+	auto const deadChain = graph.addPass("deadChain");
+	graph.write(deadChain, debug);
+	auto const deadChainEnd = graph.addPass("deadChainEnd");
+	graph.read(deadChainEnd, debug);
+	graph.write(deadChainEnd, unused);
+	auto const present = graph.addPass("present");
+	graph.read(present, scene);
+	graph.write(present, backbuffer);
+
+	graph.compile();
+
+	EXPECT(alivePassNames(graph) == (vector<string_view>{"draw", "present"}));
+	EXPECT(graph.alivePasses() == 2);
+	EXPECT(graph.resources[unused].physical == Graph::None);
+	EXPECT(graph.resources[debug].physical == Graph::None);
+	EXPECT(graph.resources[backbuffer].physical == Graph::None);
+	EXPECT(graph.physicals.size() == 1);
+}
+
+CHECK(framegraphLifetimes) {
+	auto graph = Graph();
+	auto const backbuffer = graph.importResource("backbuffer");
+	auto const a = graph.create("a", 0);
+	auto const b = graph.create("b", 0);
+	auto const history = graph.create("history", 0);
+
+	auto const first = graph.addPass("first");
+	graph.write(first, a);
+	auto const second = graph.addPass("second");
+	graph.read(second, a);
+	graph.write(second, b);
+	graph.write(second, history);
+	auto const third = graph.addPass("third");
+	graph.read(third, b);
+	graph.write(third, backbuffer);
+	graph.markOutput(history);
+
+	graph.compile();
+
+	EXPECT(graph.resources[a].first == first);
+	EXPECT(graph.resources[a].last == second);
+	EXPECT(graph.resources[b].first == second);
+	EXPECT(graph.resources[b].last == third);
+
+	// Outputs stay alive after the last pass
+	EXPECT(graph.resources[history].first == second);
+	EXPECT(graph.resources[history].last == graph.passes.size());
+	EXPECT(graph.resources[backbuffer].first == third);
+}
+
+CHECK(framegraphAliasing) {
+	auto graph = Graph();
+	auto const backbuffer = graph.importResource("backbuffer");
+	auto const r0 = graph.create("r0", 0);
+	auto const r1 = graph.create("r1", 0);
+	auto const r2 = graph.create("r2", 0);
+	auto const r3 = graph.create("r3", 0);
+	auto const small = graph.create("small", 1);
+
+	auto const p0 = graph.addPass("p0");
+	graph.write(p0, r0);
+	auto const p1 = graph.addPass("p1");
+	graph.read(p1, r0);
+	graph.write(p1, r1);
+	auto const p2 = graph.addPass("p2");
+	graph.read(p2, r1);
+	graph.write(p2, r2);
+	graph.write(p2, small);
+	auto const p3 = graph.addPass("p3");
+	graph.read(p3, r2);
+	graph.read(p3, small);
+	graph.write(p3, r3);
+	auto const p4 = graph.addPass("p4");
+	graph.read(p4, r3);
+	graph.write(p4, backbuffer);
+
+	graph.compile();
+
+	// A pass never reads and writes the same allocation
+	EXPECT(graph.resources[r0].physical != graph.resources[r1].physical);
+	EXPECT(graph.resources[r1].physical != graph.resources[r2].physical);
+	EXPECT(graph.resources[r2].physical != graph.resources[r3].physical);
+
+	// Disjoint lifetimes with equal descs share, different descs don't
+	EXPECT(graph.resources[r0].physical == graph.resources[r2].physical);
+	EXPECT(graph.resources[r1].physical == graph.resources[r3].physical);
+	EXPECT(graph.resources[small].physical != graph.resources[r0].physical);
+	EXPECT(graph.resources[small].physical != graph.resources[r1].physical);
+	EXPECT(graph.physicals.size() == 3);
+	EXPECT(graph.physicals[graph.resources[small].physical] == 1);
+}
+
+CHECK(framegraphOutputsNotAliased) {
+	auto graph = Graph();
+	auto const backbuffer = graph.importResource("backbuffer");
+	auto const history = graph.create("history", 0);
+	auto const temp = graph.create("temp", 0);
+
+	auto const first = graph.addPass("first");
+	graph.write(first, history);
+	auto const second = graph.addPass("second");
+	graph.write(second, temp);
+	auto const third = graph.addPass("third");
+	graph.read(third, temp);
+	graph.write(third, backbuffer);
+	graph.markOutput(history);
+
+	graph.compile();
+
+	// history is never released, so temp can't reuse its allocation
+	EXPECT(alivePassNames(graph) == (vector<string_view>{"first", "second", "third"}));
+	EXPECT(graph.resources[history].physical != graph.resources[temp].physical);
+	EXPECT(graph.physicals.size() == 2);
+}
+
+CHECK(framegraphRecompile) {
+	auto graph = Graph();
+	auto const backbuffer = graph.importResource("backbuffer");
+	auto const scene = graph.create("scene", 0);
+	auto const draw = graph.addPass("draw");
+	graph.write(draw, scene);
+	auto const present = graph.addPass("present");
+	graph.read(present, scene);
+	graph.write(present, backbuffer);
+
+	// Compiling twice gives the same result
+	graph.compile();
+	graph.compile();
+	EXPECT(graph.physicals.size() == 1);
+	EXPECT(graph.resources[scene].physical == 0);
+	EXPECT(graph.alivePasses() == 2);
+
+	// A new frame starts empty
+	graph.clear();
+	EXPECT(graph.passes.empty());
+	EXPECT(graph.resources.empty());
+	EXPECT(graph.physicals.empty());
+}
@@ -0,0 +1,184 @@
+// Minote - check/jobs.cpp
+// Checks of the job system under load: every job runs exactly once, after
+// its dependency, and on a thread its affinity allows. Each check repeats
+// its work many times with different worker counts, so that races have
+// a chance to show up, especially under ThreadSanitizer.
+
+#include "check/check.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <thread>
+#include "base/thread.hpp"
+#include "base/array.hpp"
+#include "base/jobs.hpp"
+
+using namespace minote;
+
+// Worker counts to test with. 0 makes the main thread do all the work
+constexpr auto JobWorkerCounts = array<u32, 4>{0, 1, 3, 7};
+
+// Number of times each check's work is repeated
+constexpr size_t JobRounds = 64;
+
+CHECK(jobsParallelForCoverage) {
+	// Ranges smaller than, equal to and much larger than the number of chunks
+	constexpr auto Counts = array<size_t, 6>{1, 7, 32, 100, 1000, 20000};
+	constexpr auto Grains = array<size_t, 3>{0, 1, 64};
+
+	for (auto const workers: JobWorkerCounts) {
+		auto jobs = JobSystem(workers);
+		auto hits = std::make_unique<atomic<u32>[]>(Counts.back());
+		for (size_t round = 0; round < JobRounds; round += 1)
+		for (auto const count: Counts)
+		for (auto const grain: Grains) {
+			for (size_t i = 0; i < count; i += 1)
+				hits[i].store(0, std::memory_order_relaxed);
+			auto badRange = atomic<bool>(false);
+
+			jobs.parallelFor(count, grain, [&](size_t const begin, size_t const end) {
+				if (begin >= end || end > count)
+					badRange.store(true, std::memory_order_relaxed);
+				for (size_t i = begin; i < end; i += 1)
+					hits[i].fetch_add(1, std::memory_order_relaxed);
+			});
+
+			EXPECT(!badRange.load());
+			auto exactlyOnce = true;
+			for (size_t i = 0; i < count; i += 1)
+				exactlyOnce = exactlyOnce && hits[i].load(std::memory_order_relaxed) == 1;
+			EXPECT(exactlyOnce);
+		}
+	}
+}
+
+// Build chains of jobs where each job depends on the previous one, and record
+// the order in which they run in tickets. Returns once all chains are done.
+static void runChains(JobSystem& jobs, size_t chains, size_t length, span<u32> tickets)
+{
+	auto ticket = atomic<u32>(0);
+	auto counters = vector<JobCounter>(chains * length);
+
+	// Submit the chains interleaved, so that dependent jobs sit next to each
+	// other in the deques
+	for (size_t step = 0; step < length; step += 1)
+	for (size_t chain = 0; chain < chains; chain += 1) {
+		auto const index = chain * length + step;
+		auto const* dependency = step? &counters[index - 1] : nullptr;
+		jobs.run([&ticket, tickets, index] {
+			tickets[index] = ticket.fetch_add(1, std::memory_order_relaxed) + 1;
+		}, &counters[index], JobAffinity::Any, dependency);
+	}
+
+	// The last job of a chain finishes after all the others
+	for (size_t chain = 0; chain < chains; chain += 1)
+		jobs.wait(counters[chain * length + length - 1]);
+}
+
+// Whether every job of every chain ran, after the job before it.
+static auto chainsInOrder(size_t chains, size_t length, span<u32 const> tickets) -> bool
+{
+	for (size_t chain = 0; chain < chains; chain += 1)
+	for (size_t step = 0; step < length; step += 1) {
+		auto const t = tickets[chain * length + step];
+		if (t == 0) return false;
+		if (step > 0 && t <= tickets[chain * length + step - 1]) return false;
+	}
+	return true;
+}
+
+CHECK(jobsDependencyChains) {
+	constexpr size_t Chains = 16;
+	constexpr size_t Length = 32;
+
+	for (auto const workers: JobWorkerCounts) {
+		auto jobs = JobSystem(workers);
+		auto tickets = vector<u32>(Chains * Length);
+		for (size_t round = 0; round < JobRounds; round += 1) {
+			std::fill(tickets.begin(), tickets.end(), 0);
+			runChains(jobs, Chains, Length, tickets);
+			EXPECT(chainsInOrder(Chains, Length, tickets));
+		}
+	}
+}
+
+CHECK(jobsNested) {
+	constexpr size_t Outer = 8;
+	constexpr size_t Chains = 4;
+	constexpr size_t Length = 16;
+	constexpr size_t Count = 1000;
+
+	for (auto const workers: JobWorkerCounts) {
+		auto jobs = JobSystem(workers);
+		auto tickets = vector<u32>(Outer * Chains * Length);
+		auto hits = std::make_unique<atomic<u32>[]>(Outer * Count);
+		for (size_t round = 0; round < JobRounds; round += 1) {
+			std::fill(tickets.begin(), tickets.end(), 0);
+			for (size_t i = 0; i < Outer * Count; i += 1)
+				hits[i].store(0, std::memory_order_relaxed);
+
+			// Jobs that submit their own jobs and wait for them
+			auto counter = JobCounter();
+			for (size_t outer = 0; outer < Outer; outer += 1) {
+				jobs.run([&jobs, &tickets, &hits, outer] {
+					runChains(jobs, Chains, Length,
+						span(tickets).subspan(outer * Chains * Length, Chains * Length));
+					jobs.parallelFor(Count, 16, [&hits, outer](size_t const begin, size_t const end) {
+						for (size_t i = begin; i < end; i += 1)
+							hits[outer * Count + i].fetch_add(1, std::memory_order_relaxed);
+					});
+				}, &counter);
+			}
+			jobs.wait(counter);
+
+			auto inOrder = true;
+			for (size_t outer = 0; outer < Outer; outer += 1)
+				inOrder = inOrder && chainsInOrder(Chains, Length,
+					span(tickets).subspan(outer * Chains * Length, Chains * Length));
+			EXPECT(inOrder);
+			auto exactlyOnce = true;
+			for (size_t i = 0; i < Outer * Count; i += 1)
+				exactlyOnce = exactlyOnce && hits[i].load(std::memory_order_relaxed) == 1;
+			EXPECT(exactlyOnce);
+		}
+	}
+}
+
+CHECK(jobsAffinity) {
+	constexpr size_t Count = 64;
+
+	auto const mainThread = std::this_thread::get_id();
+	for (auto const workers: JobWorkerCounts) {
+		auto jobs = JobSystem(workers);
+		for (size_t round = 0; round < JobRounds; round += 1) {
+			auto onMain = atomic<u32>(0);
+			auto offMain = atomic<u32>(0);
+			auto counter = JobCounter();
+
+			// Main jobs must run on the main thread, even when submitted
+			// from another worker
+			for (size_t i = 0; i < Count; i += 1) {
+				jobs.run([&, mainThread] {
+					if (std::this_thread::get_id() == mainThread)
+						onMain.fetch_add(1, std::memory_order_relaxed);
+				}, &counter, JobAffinity::Main);
+				jobs.run([&, mainThread] {
+					if (std::this_thread::get_id() != mainThread)
+						offMain.fetch_add(1, std::memory_order_relaxed);
+				}, &counter, JobAffinity::Background);
+				jobs.run([&, mainThread] {
+					jobs.run([&, mainThread] {
+						if (std::this_thread::get_id() == mainThread)
+							onMain.fetch_add(1, std::memory_order_relaxed);
+					}, &counter, JobAffinity::Main);
+				}, &counter, JobAffinity::Background);
+			}
+			jobs.wait(counter);
+
+			EXPECT(onMain.load() == Count * 2);
+			// With no background workers, background jobs fall back to
+			// the main thread
+			EXPECT(offMain.load() == (workers? Count : 0));
+		}
+	}
+}
@@ -0,0 +1,53 @@
+// Minote - check/model.cpp
+// Checks of the per-instance normal matrices of Phong models
+
+#include "check/check.hpp"
+
+#include <algorithm>
+#include "base/array.hpp"
+#include "base/math.hpp"
+#include "engine/model.hpp"
+
+using namespace minote;
+
+// Check that two matrices transform normals into the same directions.
+static auto sameDirections(mat3 const& left, mat3 const& right) -> bool
+{
+	constexpr auto Normals = array{
+		vec3{1.0f, 0.0f, 0.0f}, vec3{0.0f, 1.0f, 0.0f}, vec3{0.0f, 0.0f, 1.0f},
+		vec3{0.6f, -0.8f, 0.0f}, vec3{0.48f, 0.6f, -0.64f}};
+	return std::all_of(Normals.begin(), Normals.end(), [&](vec3 const n) {
+		return dot(normalize(left * n), normalize(right * n)) > 0.99999f;
+	});
+}
+
+// Reference normal matrix, without any shortcut.
+static auto inverseTranspose(mat4 const& modelView) -> mat3
+{
+	return transpose(inverse(mat3(modelView)));
+}
+
+CHECK(phongNormalMatrixConformal) {
+	auto const view = lookAt(vec3{0.0f, 12.0f, 32.0f}, vec3{0.0f, 12.0f, 0.0f},
+		vec3{0.0f, 1.0f, 0.0f});
+	for (u32 i = 0; i < 64; i += 1) {
+		auto const modelView = view *
+			make_translate(vec3{f32(i), -f32(i), 2.0f}) *
+			make_rotate(f32(i) * 0.37f, normalize(vec3{1.0f, 2.0f, 3.0f})) *
+			make_scale(vec3{0.25f + f32(i) * 0.5f});
+		EXPECT(sameDirections(phongNormalMatrix(modelView), inverseTranspose(modelView)));
+	}
+}
+
+CHECK(phongNormalMatrixNonUniform) {
+	// A stretched or sheared instance needs the full inverse transpose
+	auto const stretched = make_rotate(0.5f, vec3{0.0f, 0.0f, 1.0f}) *
+		make_scale(vec3{4.0f, 1.0f, 0.5f});
+	EXPECT(sameDirections(phongNormalMatrix(stretched), inverseTranspose(stretched)));
+	EXPECT(!sameDirections(mat3(stretched), inverseTranspose(stretched)));
+
+	auto sheared = mat4(1.0f);
+	sheared[1][0] = 0.75f;
+	EXPECT(sameDirections(phongNormalMatrix(sheared), inverseTranspose(sheared)));
+	EXPECT(!sameDirections(mat3(sheared), inverseTranspose(sheared)));
+}
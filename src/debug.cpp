@@ -6,6 +6,7 @@
 #define MINOTE_NO_NUKLEAR_INCLUDE
 #include "debug.hpp"
 
+#include <algorithm>
 #include <atomic>
 #include <GLFW/glfw3.h>
 #define NK_IMPLEMENTATION
@@ -15,6 +16,8 @@
 #include "sys/opengl/buffer.hpp"
 #include "sys/opengl/shader.hpp"
 #include "sys/opengl/draw.hpp"
+#include "base/profile.hpp"
+#include "base/string.hpp"
 #include "base/util.hpp"
 #include "base/log.hpp"
 
@@ -23,6 +26,17 @@ using namespace minote;
 #define NUKLEAR_VBO_SIZE (1024 * 1024)
 #define NUKLEAR_EBO_SIZE (256 * 1024)
 
+#define PROFILER_ROW_HEIGHT 18.0f
+#define PROFILER_MAX_DEPTH 8
+#define PROFILER_TRACE_PATH "minote-profile.json"
+#define GPU_TIMERS_CSV_PATH "minote-gpu.csv"
+#define GPU_TIMERS_INDENT 12.0f
+#define FRAME_STATS_SHORT 60
+#define FRAME_STATS_GRAPH_FRAMES 240
+#define FRAME_STATS_GRAPH_HEIGHT 80.0f
+#define FRAME_STATS_GRAPH_MAX 50_ms
+#define FRAME_STATS_GRAPH_TARGET 16.667_ms
+
 struct NuklearVertex {
 	vec2 pos;
 	vec2 texCoord;
@@ -271,6 +285,198 @@ void debugDraw(Engine& engine)
 	nk_buffer_clear(&commandList);
 }
 
+void debugProfiler(void)
+{
+	ASSERT(initialized);
+	if (!nuklearEnabled) return;
+
+	if (nk_begin(&nkContext, "Profiler", nk_rect(30, 500, 700, 220),
+		NK_WINDOW_BORDER | NK_WINDOW_MOVABLE | NK_WINDOW_SCALABLE
+			| NK_WINDOW_MINIMIZABLE | NK_WINDOW_NO_SCROLLBAR)) {
+		// Find the last completed top-level zone. Its children were all
+		// recorded right before it
+		auto const events = profileThread().snapshot();
+		size_t root = events.size() - 1;
+		while (root < events.size() && events[root].depth != 0)
+			root -= 1;
+
+		nk_layout_row_dynamic(&nkContext, 20, 2);
+		if (root < events.size()) {
+			auto const& frame = events[root];
+			auto const duration = profileTime(frame.end) - profileTime(frame.start);
+			nk_labelf(&nkContext, NK_TEXT_LEFT, "%s: %.2f ms", frame.name,
+				duration.count() / 1'000'000.0);
+		} else {
+			nk_label(&nkContext, "No zones recorded", NK_TEXT_LEFT);
+		}
+		if (nk_button_label(&nkContext, "Export trace")) {
+			try {
+				profileExport(PROFILER_TRACE_PATH);
+			} catch (system_error const& e) {
+				L.warn(R"(Could not export profiler trace to "{}": {})",
+					PROFILER_TRACE_PATH, e.what());
+			}
+		}
+
+		nk_layout_row_dynamic(&nkContext, PROFILER_ROW_HEIGHT * PROFILER_MAX_DEPTH, 1);
+		struct nk_rect bounds;
+		if (root < events.size() && nk_widget(&bounds, &nkContext) != NK_WIDGET_INVALID) {
+			auto* const canvas = nk_window_get_canvas(&nkContext);
+			auto const* const font = nkContext.style.font;
+			auto const& frame = events[root];
+			auto const frameStart = profileTime(frame.start);
+			auto const frameLength = f32((profileTime(frame.end) - frameStart).count());
+
+			// Draw each zone as a bar under its parent, colored by name
+			for (size_t i = root; i < events.size() && events[i].end >= frame.start; i -= 1) {
+				auto const& event = events[i];
+				if (event.depth >= PROFILER_MAX_DEPTH) continue;
+				auto const start = profileTime(event.start);
+				auto const length = profileTime(event.end) - start;
+				struct nk_rect const bar = {
+					.x = bounds.x + bounds.w * f32((start - frameStart).count()) / frameLength,
+					.y = bounds.y + PROFILER_ROW_HEIGHT * event.depth,
+					.w = std::max(bounds.w * f32(length.count()) / frameLength, 1.0f),
+					.h = PROFILER_ROW_HEIGHT - 1.0f
+				};
+				auto const color = nk_hsv(+ID(event.name) % 256, 140, 200);
+				nk_fill_rect(canvas, bar, 0.0f, color);
+
+				int const nameLength = std::strlen(event.name);
+				if (font->width(font->userdata, font->height, event.name, nameLength) < bar.w)
+					nk_draw_text(canvas, bar, event.name, nameLength, font, color,
+						nk_rgb(0, 0, 0));
+				if (nk_input_is_mouse_hovering_rect(&nkContext.input, bar)) {
+					auto const tooltip = format("{}: {:.3f} ms", event.name,
+						length.count() / 1'000'000.0);
+					nk_tooltip(&nkContext, tooltip.c_str());
+				}
+			}
+		}
+	}
+	nk_end(&nkContext);
+}
+
+void debugFrameStats(FrameStats const& stats)
+{
+	ASSERT(initialized);
+	if (!nuklearEnabled) return;
+
+	if (nk_begin(&nkContext, "Frame statistics", nk_rect(760, 30, 300, 370),
+		NK_WINDOW_BORDER | NK_WINDOW_MOVABLE | NK_WINDOW_MINIMIZABLE
+			| NK_WINDOW_NO_SCROLLBAR)) {
+		auto const toMs = [](nsec const duration) {
+			return duration.count() / 1'000'000.0;
+		};
+
+		// Percentiles over the last second and the whole history
+		for (auto const window: {size_t(FRAME_STATS_SHORT), FrameStatsHistory}) {
+			auto const cpu = stats.summary(&FrameStats::Sample::cpu, window);
+			auto const present = stats.summary(&FrameStats::Sample::present, window);
+
+			nk_layout_row_dynamic(&nkContext, 18, 1);
+			nk_labelf(&nkContext, NK_TEXT_LEFT, "Last %zu frames, %zu hitches:",
+				cpu.frames, cpu.hitches);
+			nk_layout_row_dynamic(&nkContext, 18, 5);
+			nk_label(&nkContext, "ms", NK_TEXT_LEFT);
+			nk_label(&nkContext, "p50", NK_TEXT_RIGHT);
+			nk_label(&nkContext, "p95", NK_TEXT_RIGHT);
+			nk_label(&nkContext, "p99", NK_TEXT_RIGHT);
+			nk_label(&nkContext, "max", NK_TEXT_RIGHT);
+			auto const row = [&](char const* const name, FrameStats::Summary const& summary) {
+				nk_label(&nkContext, name, NK_TEXT_LEFT);
+				nk_labelf(&nkContext, NK_TEXT_RIGHT, "%.2f", toMs(summary.p50));
+				nk_labelf(&nkContext, NK_TEXT_RIGHT, "%.2f", toMs(summary.p95));
+				nk_labelf(&nkContext, NK_TEXT_RIGHT, "%.2f", toMs(summary.p99));
+				nk_labelf(&nkContext, NK_TEXT_RIGHT, "%.2f", toMs(summary.max));
+			};
+			row("CPU", cpu);
+			row("Present", present);
+		}
+		nk_layout_row_dynamic(&nkContext, 18, 1);
+		nk_labelf(&nkContext, NK_TEXT_LEFT, "Session: %llu frames, %llu hitches",
+			static_cast<unsigned long long>(stats.frames),
+			static_cast<unsigned long long>(stats.hitches));
+
+		// Present intervals of recent frames, with frames that ran more than
+		// one logic tick in red
+		nk_layout_row_dynamic(&nkContext, FRAME_STATS_GRAPH_HEIGHT, 1);
+		struct nk_rect bounds;
+		if (nk_widget(&bounds, &nkContext) != NK_WIDGET_INVALID) {
+			auto* const canvas = nk_window_get_canvas(&nkContext);
+			auto const height = [&](nsec const duration) {
+				return bounds.h * std::min(ratio(duration, FRAME_STATS_GRAPH_MAX), 1.0f);
+			};
+			f32 const barWidth = bounds.w / FRAME_STATS_GRAPH_FRAMES;
+			size_t const count = std::min<size_t>(stats.recent.size(), FRAME_STATS_GRAPH_FRAMES);
+			size_t const first = stats.recent.size() - count;
+
+			nk_fill_rect(canvas, bounds, 0.0f, nk_rgb(30, 30, 30));
+			for (size_t i = 0; i < count; i += 1) {
+				auto const& sample = stats.recent[first + i];
+				f32 const h = height(sample.present);
+				struct nk_rect const bar = {
+					.x = bounds.x + barWidth * (FRAME_STATS_GRAPH_FRAMES - count + i),
+					.y = bounds.y + bounds.h - h,
+					.w = std::max(barWidth - 1.0f, 1.0f),
+					.h = h
+				};
+				nk_fill_rect(canvas, bar, 0.0f, sample.ticks > 1?
+					nk_rgb(220, 60, 60) : nk_rgb(90, 180, 90));
+			}
+			f32 const target = bounds.y + bounds.h - height(FRAME_STATS_GRAPH_TARGET);
+			nk_stroke_line(canvas, bounds.x, target, bounds.x + bounds.w, target,
+				1.0f, nk_rgb(200, 200, 200));
+		}
+	}
+	nk_end(&nkContext);
+}
+
+void debugGpuTimers(GpuTimers& timers)
+{
+	ASSERT(initialized);
+	if (!nuklearEnabled) return;
+
+	if (nk_begin(&nkContext, "GPU timings", nk_rect(740, 500, 280, 360),
+		NK_WINDOW_BORDER | NK_WINDOW_MOVABLE | NK_WINDOW_SCALABLE
+			| NK_WINDOW_MINIMIZABLE)) {
+		if (!timers.supported) {
+			nk_layout_row_dynamic(&nkContext, 20, 1);
+			nk_label(&nkContext, "Timer queries unavailable", NK_TEXT_LEFT);
+			nk_end(&nkContext);
+			return;
+		}
+
+		nk_layout_row_dynamic(&nkContext, 20, 2);
+		timers.enabled = nk_check_label(&nkContext, "Enabled", timers.enabled);
+		bool const recording = nk_check_label(&nkContext, "Record CSV", timers.isCsvOpen());
+		if (recording != timers.isCsvOpen()) {
+			if (recording) {
+				try {
+					timers.startCsv(GPU_TIMERS_CSV_PATH);
+				} catch (system_error const& e) {
+					L.warn(R"(Could not record GPU timings to "{}": {})",
+						GPU_TIMERS_CSV_PATH, e.what());
+				}
+			} else {
+				timers.stopCsv();
+			}
+		}
+
+		for (auto const& result: timers.results) {
+			nk_layout_row_begin(&nkContext, NK_STATIC, 18, 3);
+			nk_layout_row_push(&nkContext, GPU_TIMERS_INDENT * result.depth);
+			nk_spacing(&nkContext, 1);
+			nk_layout_row_push(&nkContext, 150.0f - GPU_TIMERS_INDENT * result.depth);
+			nk_label(&nkContext, result.name, NK_TEXT_LEFT);
+			nk_layout_row_push(&nkContext, 80.0f);
+			nk_labelf(&nkContext, NK_TEXT_RIGHT, "%.3f ms", result.ms);
+			nk_layout_row_end(&nkContext);
+		}
+	}
+	nk_end(&nkContext);
+}
+
 struct nk_context* nkCtx(void)
 {
 	return &nkContext;
@@ -6,6 +6,7 @@
 #ifndef MINOTE_DEBUG_H
 #define MINOTE_DEBUG_H
 
+#include "engine/framestats.hpp"
 #include "engine/engine.hpp"
 
 // Nuklear configuration
@@ -59,6 +60,27 @@ void debugUpdate(void);
  */
 void debugDraw(minote::Engine& engine);
 
+/**
+ * Show the profiler window, with a flame graph of the last completed
+ * top-level zone of the calling thread and a button to export a Chrome
+ * trace. Must be called between debugUpdate() and debugDraw().
+ */
+void debugProfiler(void);
+
+/**
+ * Show the frame statistics window, with percentiles of frame times over
+ * rolling windows and a graph of recent present intervals, with hitches
+ * highlighted. Must be called between debugUpdate() and debugDraw().
+ */
+void debugFrameStats(minote::FrameStats const& stats);
+
+/**
+ * Show the GPU timings window, with the durations of the sections timed
+ * by the frame's GPU timers, and toggles for timing and CSV recording. Must
+ * be called between debugUpdate() and debugDraw().
+ */
+void debugGpuTimers(minote::GpuTimers& timers);
+
 /**
  * Retrieve the Nuklear context for use with nk_* functions.
  * @return pointer to the Nuklear context
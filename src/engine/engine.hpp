@@ -4,6 +4,7 @@
 #pragma once
 
 #include "sys/window.hpp"
+#include "base/jobs.hpp"
 #include "engine/mapper.hpp"
 #include "engine/scene.hpp"
 #include "engine/frame.hpp"
@@ -22,6 +23,7 @@ struct Engine {
 	Mapper& mapper;
 	Frame& frame;
 	Scene& scene;
+	JobSystem& jobs;
 
 	// *** Content stores ***
 
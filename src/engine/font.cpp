@@ -1,12 +1,192 @@
 #include "engine/font.hpp"
 
+#include <algorithm>
 #include <cstring>
 #include <cstdio>
-#include "stb/stb_image.h"
+#include "msdf-atlas-gen/msdf-atlas-gen.h"
+#include "engine/fontpack.hpp"
+#include "base/thread.hpp"
+#include "base/io.hpp"
 #include "base/util.hpp"
+#include "base/log.hpp"
 
 namespace minote {
 
+using namespace msdf_atlas;
+
+// Pixel density of glyphs in the dynamic atlas. Matches the size that
+// msdf-atlas-gen picks for the baked atlas
+constexpr f64 DynamicEmSize = 32.0;
+
+// Distance field range in pixels. Must match the -pxrange used
+// for the baked atlas and the msdf shader
+constexpr f64 DynamicPxRange = 4.0;
+
+// msdf-atlas-gen defaults, used for the baked atlas
+constexpr f64 AngleThreshold = 3.0;
+constexpr f64 MiterLimit = 1.0;
+
+struct Font::Generator {
+
+	// A glyph generated on the worker thread, waiting for upload
+	struct Result {
+
+		u32 id;
+		Glyph glyph;
+
+		// Location of the glyph's pixels in the dynamic atlas
+		uvec2 offset;
+		uvec2 size;
+
+		// Tightly packed RGB pixels of the glyph's box
+		vector<u8> pixels;
+
+	};
+
+	using AtlasGen = ImmediateAtlasGenerator<float, 3, msdfGenerator,
+		BitmapAtlasStorage<byte, 3>>;
+
+	// Path of the font file, for the worker's own FreeType instance
+	char fontPath[256] = "";
+
+	// Glyph IDs requested by the game thread
+	mutex requestsLock;
+	condition_variable_any requestsSignal;
+	vector<u32> requests;
+
+	// Glyphs finished by the worker
+	mutex resultsLock;
+	vector<Result> results;
+
+	// Worker-only state; allocated space in the dynamic atlas
+	RectanglePacker packer{DynamicAtlasSize, DynamicAtlasSize};
+	AtlasGen atlasGen{DynamicAtlasSize, DynamicAtlasSize};
+
+	thread worker;
+
+	// Worker thread body. Waits for requests and generates them in batches
+	// until stopped.
+	void run(stop_token stop);
+
+	// Generate MSDFs of a batch of requested glyphs.
+	void generate(msdfgen::FontHandle* face, f64 emSize, span<u32 const> ids);
+
+};
+
+void Font::Generator::run(stop_token const stop)
+{
+	msdfgen::FreetypeHandle* const freetype = msdfgen::initializeFreetype();
+	if (!freetype) {
+		L.error("Failed to initialize Freetype for the glyph generator");
+		return;
+	}
+	defer { msdfgen::deinitializeFreetype(freetype); };
+
+	msdfgen::FontHandle* const face = msdfgen::loadFont(freetype, fontPath);
+	if (!face) {
+		L.error(R"(Glyph generator failed to open font file at {})", fontPath);
+		return;
+	}
+	defer { msdfgen::destroyFont(face); };
+
+	msdfgen::FontMetrics fontMetrics = {};
+	msdfgen::getFontMetrics(fontMetrics, face);
+	if (fontMetrics.emSize <= 0)
+		fontMetrics.emSize = DynamicEmSize;
+
+	vector<u32> batch;
+	while (!stop.stop_requested()) {
+		{
+			std::unique_lock lock{requestsLock};
+			if (!requestsSignal.wait(lock, stop, [this] { return !requests.empty(); }))
+				break;
+			std::swap(batch, requests);
+		}
+
+		generate(face, fontMetrics.emSize, batch);
+		batch.clear();
+	}
+}
+
+void Font::Generator::generate(msdfgen::FontHandle* const face, f64 const emSize,
+	span<u32 const> const ids)
+{
+	f64 const scale = DynamicEmSize / emSize;
+	f64 const range = DynamicPxRange / scale;
+
+	// Load and lay out the glyphs
+	vector<GlyphGeometry> geometry;
+	vector<Rectangle> rects;
+	vector<Result> finished;
+	geometry.reserve(ids.size());
+	for (u32 const id: ids) {
+		auto& result = finished.emplace_back();
+		result.id = id;
+		result.glyph.source = GlyphSource::Failed;
+
+		GlyphGeometry glyph;
+		if (!glyph.load(face, id)) {
+			L.warn(R"(Failed to load glyph {} from font file {})", id, fontPath);
+			continue;
+		}
+		glyph.edgeColoring(AngleThreshold, id);
+		glyph.wrapBox(scale, range, MiterLimit);
+
+		int w = 0;
+		int h = 0;
+		glyph.getBoxSize(w, h);
+		rects.push_back({-1, -1, w, h});
+		geometry.push_back(std::move(glyph));
+	}
+	packer.pack(rects.data(), rects.size());
+
+	// Whatever didn't fit is dropped from the batch
+	size_t placed = 0;
+	for (size_t i = 0; i < geometry.size(); i += 1) {
+		if (rects[i].x < 0) {
+			L.warn(R"(Dynamic atlas of font file {} is full, glyph {} dropped)",
+				fontPath, geometry[i].getCodepoint());
+			continue;
+		}
+		geometry[i].placeBox(rects[i].x, rects[i].y);
+		if (placed != i)
+			geometry[placed] = std::move(geometry[i]);
+		placed += 1;
+	}
+	geometry.resize(placed);
+
+	atlasGen.generate(geometry.data(), geometry.size());
+
+	// Extract the metrics and pixels
+	msdfgen::BitmapConstRef<byte, 3> const storage = atlasGen.atlasStorage();
+	for (auto const& glyph: geometry) {
+		auto& result = *std::find_if(finished.begin(), finished.end(),
+			[&](auto const& r) { return r.id == glyph.getCodepoint(); });
+		result.glyph.source = GlyphSource::Dynamic;
+
+		f64 l = 0.0, b = 0.0, r = 0.0, t = 0.0;
+		glyph.getQuadPlaneBounds(l, b, r, t);
+		result.glyph.glyph.pos = vec2(l / emSize, b / emSize);
+		result.glyph.glyph.size = vec2((r - l) / emSize, (t - b) / emSize);
+		glyph.getQuadAtlasBounds(l, b, r, t);
+		result.glyph.msdf.pos = vec2(l, b);
+		result.glyph.msdf.size = vec2(r - l, t - b);
+
+		int x = 0, y = 0, w = 0, h = 0;
+		glyph.getBoxRect(x, y, w, h);
+		if (!w || !h) continue; // Whitespace
+		result.offset = uvec2(x, y);
+		result.size = uvec2(w, h);
+		result.pixels.resize(w * h * 3);
+		for (int row = 0; row < h; row += 1)
+			std::memcpy(&result.pixels[row * w * 3], storage(x, y + row), w * 3);
+	}
+
+	scoped_lock lock{resultsLock};
+	for (auto& result: finished)
+		results.push_back(std::move(result));
+}
+
 void Font::create(FT_Library freetype, char const* const _name, char const* const path)
 {
 	ASSERT(freetype);
@@ -34,74 +214,147 @@ void Font::create(FT_Library freetype, char const* const _name, char const* cons
 	}
 	hbFont = hb_ft_font_create_referenced(ftFace);
 
-	// *** Loading the atlas texture ***
+	// *** Mapping the packed atlas and metrics ***
 
-	char atlasPath[MaxPathLen];
-	std::snprintf(atlasPath, MaxPathLen, "%s.png", path);
+	char packPath[MaxPathLen];
+	std::snprintf(packPath, MaxPathLen, "%s.font", path);
 
-	ivec2 size = {};
-	int channels = 0;
-	stbi_set_flip_vertically_on_load(true);
-	u8* atlasData = stbi_load(atlasPath, &size.x, &size.y, &channels, 0);
-	if (!atlasData) {
-		L.error(R"(Failed to load font atlas at {} for font "{}": {})",
-			atlasPath, _name, stbi_failure_reason());
+	mapped_file pack;
+	try {
+		pack.open(packPath);
+	} catch (system_error const& e) {
+		L.error(R"(Failed to load font "{}": {})", _name, e.what());
 		destroy();
 		return;
 	}
-	defer { stbi_image_free(atlasData); };
-	uvec2 const usize = size;
-	size_t const atlasDataLen = usize.x * usize.y * channels;
+	auto const bytes = pack.bytes();
 
-	atlas.create(_name, usize);
-	atlas.upload(span<u8 const>{atlasData, atlasDataLen}, channels);
-
-	// *** Parsing the glyph metrics ***
-	char metricsPath[MaxPathLen];
-	std::snprintf(metricsPath, MaxPathLen, "%s.csv", path);
-	std::FILE* const metricsFile = std::fopen(metricsPath, "r");
-	if (!metricsFile) {
-		L.error(R"(Failed to load font metrics at {} for font "{}": {})",
-			metricsPath, _name, std::strerror(errno));
+	FontpackHeader header = {};
+	if (bytes.size() >= sizeof(header))
+		std::memcpy(&header, bytes.data(), sizeof(header));
+	if (header.magic != FontpackMagic || header.version != FontpackVersion) {
+		L.error(R"(Failed to load font "{}": {} is not a version {} font pack)",
+			_name, packPath, FontpackVersion);
 		destroy();
 		return;
 	}
-	defer { fclose(metricsFile); };
+	size_t const metricsLen = header.glyphCount * sizeof(FontpackGlyph);
+	size_t const atlasLen = header.atlasWidth * header.atlasHeight * header.atlasChannels;
+	if (header.metricsOffset + metricsLen > bytes.size() ||
+		header.atlasOffset + atlasLen > bytes.size()) {
+		L.error(R"(Failed to load font "{}": {} is truncated)", _name, packPath);
+		destroy();
+		return;
+	}
+
+	// *** Uploading the atlas texture ***
 
-	metrics.emplace_back(); // Empty first element
-	while (true) {
-		int index = 0;
-		Glyph glyph = {};
-		int parsed = std::fscanf(metricsFile, "%d,%*f,%f,%f,%f,%f,%f,%f,%f,%f\n",
-			&index,
-			&glyph.glyph.pos.x, &glyph.glyph.pos.y,
-			&glyph.glyph.size.x, &glyph.glyph.size.y,
-			&glyph.msdf.pos.x, &glyph.msdf.pos.y,
-			&glyph.msdf.size.x, &glyph.msdf.size.y);
-		if (parsed == 0 || parsed == EOF) break;
-		ASSERT(static_cast<size_t>(index) == metrics.size());
-		glyph.glyph.size -= glyph.glyph.pos;
-		glyph.msdf.size -= glyph.msdf.pos;
+	atlas.create(_name, {header.atlasWidth, header.atlasHeight});
+	atlas.upload(bytes.subspan(header.atlasOffset, atlasLen), header.atlasChannels);
 
-		metrics.push_back(glyph);
+	// *** Copying the glyph metrics ***
+
+	metrics.resize(std::max<size_t>(ftFace->num_glyphs, header.glyphCount));
+	auto const* const packed = reinterpret_cast<FontpackGlyph const*>(
+		bytes.data() + header.metricsOffset);
+	for (size_t i = 0; i < header.glyphCount; i += 1) {
+		if (!packed[i].baked) continue;
+		auto& glyph = metrics[i];
+		glyph.glyph.pos = {packed[i].glyph[0], packed[i].glyph[1]};
+		glyph.glyph.size = {packed[i].glyph[2], packed[i].glyph[3]};
+		glyph.msdf.pos = {packed[i].msdf[0], packed[i].msdf[1]};
+		glyph.msdf.size = {packed[i].msdf[2], packed[i].msdf[3]};
+		glyph.source = GlyphSource::Baked;
 	}
 
+	// *** Starting the glyph generator ***
+
+	generator = new Generator;
+	std::strcpy(generator->fontPath, fontPath);
+	generator->worker = thread([gen = generator](stop_token stop) {
+		gen->run(stop);
+	});
+
 	name = _name;
 	L.info(R"(Font "{}" loaded)", name);
 }
 
 void Font::destroy()
 {
+	if (generator) {
+		generator->worker.request_stop();
+		generator->worker.join();
+		delete generator;
+		generator = nullptr;
+	}
 	if (hbFont) {
 		hb_font_destroy(hbFont);
 		hbFont = nullptr;
 	}
 	if (atlas.id)
 		atlas.destroy();
+	if (dynamicAtlas.id)
+		dynamicAtlas.destroy();
 	metrics.clear();
 
 	L.info(R"(Font "{}" cleaned up)", name);
 	name = nullptr;
 }
 
+auto Font::getGlyph(u32 const id) -> Glyph const*
+{
+	if (id >= metrics.size()) return nullptr;
+
+	auto& glyph = metrics[id];
+	switch (glyph.source) {
+	case GlyphSource::Baked:
+	case GlyphSource::Dynamic:
+		return &glyph;
+	case GlyphSource::Missing:
+		if (!generator) return nullptr;
+		glyph.source = GlyphSource::Pending;
+		{
+			scoped_lock lock{generator->requestsLock};
+			generator->requests.push_back(id);
+		}
+		generator->requestsSignal.notify_one();
+		return nullptr;
+	default:
+		return nullptr;
+	}
+}
+
+auto Font::atlasOf(Glyph const& glyph) -> Texture<PixelFmt::RGBA_u8>&
+{
+	ASSERT(glyph.source == GlyphSource::Baked || glyph.source == GlyphSource::Dynamic);
+
+	return glyph.source == GlyphSource::Dynamic ? dynamicAtlas : atlas;
+}
+
+void Font::update()
+{
+	if (!generator) return;
+
+	vector<Generator::Result> finished;
+	{
+		std::unique_lock lock{generator->resultsLock, std::try_to_lock};
+		if (!lock.owns_lock()) return;
+		std::swap(finished, generator->results);
+	}
+	if (finished.empty()) return;
+
+	if (!dynamicAtlas.id)
+		dynamicAtlas.create(name, {DynamicAtlasSize, DynamicAtlasSize});
+
+	for (auto const& result: finished) {
+		if (!result.pixels.empty())
+			dynamicAtlas.upload(span<u8 const>{result.pixels},
+				result.offset, result.size, 3);
+		metrics[result.id] = result.glyph;
+	}
+
+	L.debug(R"(Font "{}": {} glyphs added to the dynamic atlas)",
+		name, finished.size());
+}
+
 }
@@ -12,10 +12,22 @@
 
 namespace minote {
 
-// Loaded font data, containing a glyph atlas and metrics
+// Loaded font data, containing a glyph atlas and metrics. Glyphs that were
+// not baked into the atlas at build time are generated on demand
+// into a secondary dynamic atlas.
 struct Font {
 
-	constexpr static size_t MaxGlyphs = 1024;
+	// Side length in pixels of the dynamic atlas
+	constexpr static u32 DynamicAtlasSize = 1024;
+
+	// Where the MSDF of a glyph can be found
+	enum struct GlyphSource : u8 {
+		Missing, // Not generated yet
+		Pending, // Queued for generation
+		Baked, // In the build-time atlas
+		Dynamic, // In the dynamic atlas
+		Failed, // Could not be generated, or the dynamic atlas is full
+	};
 
 	// Size metrics of a single glyph
 	struct Glyph {
@@ -26,24 +38,50 @@ struct Font {
 		// Boundary of glyph's MSDF in the atlas
 		AABB<2, f32> msdf;
 
+		// Which atlas the MSDF is stored in
+		GlyphSource source = GlyphSource::Missing;
+
 	};
 
+	// Runtime glyph generator state, private to the implementation
+	struct Generator;
+
 	// Name of the font for debugging and logging purposes
 	char const* name = nullptr;
 
 	// Uploaded texture holding the atlas of MSDF glyphs
 	Texture<PixelFmt::RGBA_u8> atlas;
 
-	// Glyph metrics datasheet
-	svector<Glyph, MaxGlyphs> metrics;
+	// Texture holding glyphs generated at runtime. Created on first use
+	Texture<PixelFmt::RGBA_u8> dynamicAtlas;
+
+	// Glyph metrics datasheet, indexed by glyph ID
+	vector<Glyph> metrics;
 
 	// HarfBuzz font data
 	hb_font_t* hbFont = nullptr;
 
+	// Glyph generator and its worker thread
+	Generator* generator = nullptr;
+
 	void create(FT_Library freetype, char const* name, char const* path);
 
 	void destroy();
 
+	// Return the metrics of a glyph ready to be drawn. If the glyph is in
+	// neither atlas, it is queued for generation and nullptr is returned;
+	// it will become available a few frames later. Glyph IDs outside
+	// of the font also return nullptr.
+	auto getGlyph(u32 id) -> Glyph const*;
+
+	// Return the atlas texture that holds a glyph's MSDF.
+	auto atlasOf(Glyph const& glyph) -> Texture<PixelFmt::RGBA_u8>&;
+
+	// Upload glyphs that the generator has finished since the last call.
+	// Never blocks; if the generator is busy the upload is retried next time.
+	// Must be called on the thread that owns the OpenGL context.
+	void update();
+
 };
 
 }
@@ -0,0 +1,63 @@
+// Minote - engine/fontpack.hpp
+// Binary font atlas format. Written at build time by the Fontpack tool,
+// memory-mapped and uploaded as-is by Font
+
+#pragma once
+
+#include "base/util.hpp"
+
+namespace minote {
+
+// Layout of the file:
+// - FontpackHeader
+// - FontpackGlyph[glyphCount] at metricsOffset, indexed by glyph ID
+// - Atlas pixels at atlasOffset; atlasChannels u8 per pixel, tightly packed
+//   rows, bottom row first (ready for glTexSubImage2D)
+// All values are little-endian.
+
+// "MFNT" as a little-endian u32
+constexpr u32 FontpackMagic = 0x544E464D;
+
+// Increment on every change to the structs below
+constexpr u32 FontpackVersion = 1;
+
+// Offsets are aligned to this many bytes
+constexpr size_t FontpackAlignment = 16;
+
+struct FontpackHeader {
+
+	u32 magic;
+	u32 version;
+
+	// Number of FontpackGlyph entries
+	u32 glyphCount;
+
+	// Atlas dimensions in pixels, and number of u8 channels per pixel
+	u32 atlasWidth;
+	u32 atlasHeight;
+	u32 atlasChannels;
+
+	// Byte offsets of the sections from the start of the file
+	u64 metricsOffset;
+	u64 atlasOffset;
+
+};
+
+// Same layout as the AABBs of Font::Glyph
+struct FontpackGlyph {
+
+	// Boundary of glyph relative to origin in ems: position, then size
+	f32 glyph[4];
+
+	// Boundary of glyph's MSDF in the atlas in pixels: position, then size
+	f32 msdf[4];
+
+	// 0 if the glyph is not in the atlas, 1 otherwise
+	u32 baked;
+
+};
+
+static_assert(sizeof(FontpackHeader) == 40);
+static_assert(sizeof(FontpackGlyph) == 36);
+
+}
@@ -2,51 +2,28 @@
 
 namespace minote {
 
-// Initialize Frame framebuffers and their attachments for a specified AA mode.
-static void createFramebuffers(Frame& frame, uvec2 const size, Samples const _aa)
+// Sample count of the multisampled targets an antialiasing mode needs.
+static auto aaSamples(AAMode const aa) -> Samples
 {
-	ASSERT(_aa != Samples::None);
-
-	frame.ssfb.create("Frame::ssfb");
-	frame.color.create("Frame::color", size);
-	frame.depthStencil.create("Frame::depthStencil", size);
-	frame.ssfb.attach(frame.color, Attachment::Color0);
-	frame.ssfb.attach(frame.depthStencil, Attachment::DepthStencil);
-
-	if (_aa != Samples::_1) {
-		frame.msfb.create("Frame::msfb");
-		frame.colorMS.create("Frame::colorMS", size, _aa);
-		frame.depthStencilMS.create("Frame::depthStencilMS", size, _aa);
-		frame.msfb.attach(frame.colorMS, Attachment::Color0);
-		frame.msfb.attach(frame.depthStencilMS, Attachment::DepthStencil);
+	switch (aa) {
+	case AAMode::None:
+	case AAMode::SMAA:
+		return Samples::_1;
+	case AAMode::MSAA2x:
+	case AAMode::SMAAS2x:
+		return Samples::_2;
+	case AAMode::MSAA4x:
+		return Samples::_4;
+	case AAMode::MSAA8x:
+		return Samples::_8;
+	default:
+		throw logic_error{"Unknown antialiasing mode"};
 	}
 }
 
-// Destroy all of a Frame's framebuffers and their attachments.
-static void destroyFramebuffers(Frame& frame)
+void Frame::create(Shaders& shaders, AAMode const _aa)
 {
-	if (frame.fb)
-		frame.fb = nullptr;
-	if (frame.ssfb.id)
-		frame.ssfb.destroy();
-	if (frame.msfb.id)
-		frame.msfb.destroy();
-	if (frame.color.id)
-		frame.color.destroy();
-	if (frame.depthStencil.id)
-		frame.depthStencil.destroy();
-	if (frame.colorMS.id)
-		frame.colorMS.destroy();
-	if (frame.depthStencilMS.id)
-		frame.depthStencilMS.destroy();
-}
-
-void Frame::create(uvec2 const size, Shaders& shaders, Samples const _aa)
-{
-	ASSERT(_aa != Samples::None);
-	ASSERT(aa == Samples::None);
-
-	createFramebuffers(*this, size, _aa);
+	ASSERT(samples == Samples::None);
 
 	delinearize = {
 		.shader = &shaders.delinearize,
@@ -57,74 +34,137 @@ void Frame::create(uvec2 const size, Shaders& shaders, Samples const _aa)
 			.depthTesting = false
 		}
 	};
+	smaa.create(shaders);
+	timers.create();
+	graph.timers = &timers;
 
 	aa = _aa;
-	L.debug("Frame created with MSAA {}x", +aa);
+	samples = aaSamples(aa);
+	L.debug("Frame created with AA mode {}", +aa);
 }
 
 void Frame::destroy()
 {
-	ASSERT(aa != Samples::None);
+	ASSERT(samples != Samples::None);
 
-	destroyFramebuffers(*this);
+	graph.destroy();
+	smaa.destroy();
+	timers.destroy();
+	graph.timers = nullptr;
+	fb = nullptr;
 
-	aa = Samples::None;
+	aa = AAMode::None;
+	samples = Samples::None;
+	L.info("Frame arena high-water mark: {} KiB", arena.peak() / 1024);
 	L.debug("Frame destroyed");
 }
 
-void Frame::changeAA(Samples const _aa)
+void Frame::changeAA(AAMode const _aa)
 {
-	ASSERT(aa != Samples::None);
-	if (aa == _aa) return;
+	ASSERT(samples != Samples::None);
 
-	uvec2 const size = color.size;
-	destroyFramebuffers(*this);
-	createFramebuffers(*this, size, _aa);
 	aa = _aa;
+	samples = aaSamples(aa);
 }
 
-void Frame::resolveAA()
+void Frame::begin(uvec2 const _size)
 {
-	ASSERT(aa != Samples::None);
-	if (aa == Samples::_1) return;
-	ASSERT(fb == &msfb);
-
-	Framebuffer::blit(ssfb, msfb, Attachment::Color0, true);
+	ASSERT(samples != Samples::None);
+
+	timers.beginFrame();
+	arena.reset();
+	graph.clear();
+	color = graph.create("Frame::color", {
+		.format = PixelFmt::RGBA_f16,
+		.size = _size});
+	depthStencil = graph.create("Frame::depthStencil", {
+		.format = PixelFmt::DepthStencil,
+		.size = _size});
+	if (samples != Samples::_1) {
+		colorMS = graph.create("Frame::colorMS", {
+			.format = PixelFmt::RGBA_f16,
+			.size = _size,
+			.samples = samples});
+		depthStencilMS = graph.create("Frame::depthStencilMS", {
+			.format = PixelFmt::DepthStencil,
+			.size = _size,
+			.samples = samples});
+	} else {
+		colorMS = RenderGraph::Graph::None;
+		depthStencilMS = RenderGraph::Graph::None;
+	}
 
-	fb = &ssfb;
+	resolved = false;
+	lastDraw = RenderGraph::Graph::None;
+	size = _size;
 }
 
-void Frame::begin(uvec2 const _size)
+auto Frame::draw(char const* const name, std::function<void()> func) -> PassID
 {
-	ASSERT(aa != Samples::None);
+	ASSERT(samples != Samples::None);
+
+	auto const pass = graph.addPass(name, [this, func = move(func)](Framebuffer* const _fb) {
+		fb = _fb;
+		func();
+		fb = nullptr;
+	});
+	bool const ms = (!resolved && samples != Samples::_1);
+	auto const targetColor = ms? colorMS : color;
+	auto const targetDS = ms? depthStencilMS : depthStencil;
+	graph.read(pass, targetColor);
+	graph.read(pass, targetDS);
+	graph.write(pass, targetColor);
+	graph.write(pass, targetDS);
+
+	lastDraw = pass;
+	return pass;
+}
 
-	color.resize(_size);
-	depthStencil.resize(_size);
-	if (aa != Samples::_1) {
-		colorMS.resize(_size);
-		depthStencilMS.resize(_size);
+void Frame::resolveAA()
+{
+	ASSERT(samples != Samples::None);
+	if (resolved) return;
+
+	if (samples != Samples::_1) {
+		ASSERT(lastDraw != RenderGraph::Graph::None);
+		auto const source = lastDraw;
+		auto const pass = graph.addPass("Frame::resolve", [this, source](Framebuffer* const _fb) {
+			auto& sourceFb = graph.framebuffer(source);
+			Framebuffer::blit(*_fb, sourceFb, Attachment::Color0, true);
+			if (aa == AAMode::SMAAS2x)
+				smaa.checkSamples(sourceFb);
+		});
+		graph.read(pass, colorMS);
+		graph.read(pass, depthStencilMS);
+		graph.write(pass, color);
+		graph.write(pass, depthStencil);
 	}
 
-	if (aa == Samples::_1)
-		fb = &ssfb;
-	else
-		fb = &msfb;
+	if (aa == AAMode::SMAA)
+		color = smaa.apply(graph, color, size);
+	if (aa == AAMode::SMAAS2x)
+		color = smaa.applyS2x(graph, colorMS, size);
 
-	size = _size;
+	resolved = true;
 }
 
 void Frame::end()
 {
-	ASSERT(aa != Samples::None);
+	ASSERT(samples != Samples::None);
 
-	if (fb == &msfb)
-		resolveAA();
+	resolveAA();
 
-	delinearize.shader->image = color;
-	delinearize.params.viewport = {.size = size};
-	delinearize.draw();
+	auto const pass = graph.addPass("Frame::delinearize", [this](Framebuffer*) {
+		delinearize.shader->image = graph.texture<PixelFmt::RGBA_f16>(color);
+		delinearize.shader->imageScale = graph.textureScale(color);
+		delinearize.params.viewport = {.size = size};
+		delinearize.draw();
+	});
+	graph.read(pass, color);
+	graph.write(pass, graph.backbuffer());
 
-	fb = nullptr;
+	GPU_ZONE(timers, "frame");
+	graph.execute();
 }
 
 }
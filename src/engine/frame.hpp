@@ -1,73 +1,114 @@
 // Minote - engine/frame.hpp
-// The main rendertarget of the game
+// The main rendertarget of the game. Drawing is recorded as passes
+// of a render graph, and executed at the end of the frame
 
 #pragma once
 
+#include <functional>
 #include "sys/opengl/framebuffer.hpp"
 #include "sys/opengl/texture.hpp"
 #include "sys/opengl/draw.hpp"
+#include "engine/rendergraph.hpp"
+#include "engine/gputimers.hpp"
+#include "engine/smaa.hpp"
 #include "store/shaders.hpp"
+#include "base/arena.hpp"
 
 namespace minote {
 
+// Antialiasing method of a Frame
+enum struct AAMode {
+	None,
+	MSAA2x,
+	MSAA4x,
+	MSAA8x,
+	SMAA,    // SMAA 1x, a postprocessing filter
+	SMAAS2x, // SMAA on both samples of MSAA 2x
+};
+
 struct Frame {
 
-	// Current main framebuffer. Might be singlesampled or multisampled,
-	// and might change during the course of a frame. Is nullptr outside
-	// of a begin()/end() pair.
+	using ResourceID = RenderGraph::ResourceID;
+	using PassID = RenderGraph::PassID;
+
+	// Framebuffer of the pass being executed. Might be singlesampled or
+	// multisampled. Is nullptr outside of a function passed to draw().
 	Framebuffer* fb = nullptr;
 
 	// Size of the current frame after a begin() call. Use this for
 	// the viewport parameter of a Draw.
 	uvec2 size = {};
 
-	// Singlesampled framebuffer
-	Framebuffer ssfb;
-
-	// Multisampled framebuffer. Might not exist in certain AA modes
-	Framebuffer msfb;
+	// Render graph of the frame. Passes other than draw() ones, such as
+	// post-processing filters, can be added to it directly
+	RenderGraph graph;
 
-	// Color attachment of ssfb
-	Texture<PixelFmt::RGBA_f16> color;
+	// Singlesampled color target. Holds the image after resolveAA().
+	// Might be replaced by the output of a filter
+	ResourceID color = RenderGraph::Graph::None;
 
-	// DS attachment of ssfb
-	Renderbuffer<PixelFmt::DepthStencil> depthStencil;
+	// Singlesampled DS target
+	ResourceID depthStencil = RenderGraph::Graph::None;
 
-	// Color attachment of msfb
-	TextureMS<PixelFmt::RGBA_f16> colorMS;
+	// Multisampled color target. Only exists if the AA mode uses multisampling
+	ResourceID colorMS = RenderGraph::Graph::None;
 
-	// DS attachment of msfb
-	RenderbufferMS<PixelFmt::DepthStencil> depthStencilMS;
+	// Multisampled DS target. Only exists if the AA mode uses multisampling
+	ResourceID depthStencilMS = RenderGraph::Graph::None;
 
 	// Current antialiasing mode. Change with changeAA()
-	Samples aa = Samples::None;
+	AAMode aa = AAMode::None;
+
+	// Sample count of the multisampled targets, or _1 if there are none.
+	// None if the frame is not created
+	Samples samples = Samples::None;
+
+	// Whether draw() passes currently use the singlesampled targets
+	bool resolved = false;
+
+	// Last pass recorded with draw()
+	PassID lastDraw = RenderGraph::Graph::None;
 
 	// Drawcall of the final blit to the backbuffer
 	Draw<Shaders::Delinearize> delinearize;
 
-	// Initialize the frame, with the specified initial size
-	// and antialiasing mode.
-	void create(uvec2 size, Shaders& shaders, Samples aa = Samples::_1);
+	// SMAA filter, used by the SMAA modes
+	Smaa smaa;
+
+	// GPU timing of the frame's passes. Sections can also be added from
+	// within draw() passes with GPU_ZONE
+	GpuTimers timers;
+
+	// Storage for data that only lives until the end of the frame, such as
+	// instance lists filled by draw() passes. Reset on begin()
+	Arena arena{"frame"};
+
+	// Initialize the frame with the specified antialiasing mode.
+	void create(Shaders& shaders, AAMode aa = AAMode::None);
 
 	// Destroy the frame, freeing all used resources.
 	void destroy();
 
-	// Switch antialiasing modes. This operation leaves all framebuffer
-	// attachments with undefined contents.
-	void changeAA(Samples aa);
-
-	// Switch from the multisampled framebuffer to the singlesampled one,
-	// preserving color and DS contents. Safe no-op if antialiasing is disabled.
-	void resolveAA();
+	// Switch antialiasing modes. Takes effect on the next begin().
+	void changeAA(AAMode aa);
 
-	// Prepare the frame for drawing into. All attachments are resized
-	// to the specified size. fb and size become available as framebuffer
-	// and viewport parameters to Draw. The initial contents of the attachments
-	// are undefined.
+	// Start recording a frame of the specified size. fb and size become
+	// available as framebuffer and viewport parameters to Draw within draw()
+	// passes. The initial contents of the targets are undefined.
 	void begin(uvec2 size);
 
-	// Finalize the frame and blit it to the backbuffer. Alpha correction
-	// is performed, and antialiasing is resolved if required.
+	// Record a pass that draws into the frame's color and DS targets -
+	// the multisampled ones until resolveAA() is called. func is called
+	// during end(), with fb pointing at the pass's framebuffer.
+	auto draw(char const* name, std::function<void()> func) -> PassID;
+
+	// Switch from the multisampled targets to the singlesampled ones,
+	// preserving color and DS contents. With an SMAA mode, the filter is
+	// applied to the color contents. Safe no-op if already resolved.
+	void resolveAA();
+
+	// Record the final blit to the backbuffer with alpha correction, then
+	// execute all recorded passes. Antialiasing is resolved if required.
 	void end();
 
 };
@@ -0,0 +1,121 @@
+// Minote - engine/framegraph.hpp
+// Compiler of a frame's render passes. Passes declare the virtual resources
+// they read and write, and compile() works out which passes contribute
+// to the outputs, how long each resource needs to live, and which resources
+// can share the same physical allocation. Knows nothing about the graphics
+// API, so that it can be tested standalone.
+
+#pragma once
+
+#include "base/array.hpp"
+#include "base/util.hpp"
+
+namespace minote {
+
+// Desc describes a physical resource. Two resources can share an allocation
+// if their descs compare equal and their lifetimes don't overlap.
+template<regular Desc>
+struct FrameGraph {
+
+	using ResourceID = u32;
+	using PassID = u32;
+
+	// Marks a missing resource, pass or allocation
+	static constexpr u32 None = -1;
+
+	// Maximum number of reads and writes of a single pass
+	static constexpr size_t MaxPassResources = 8;
+
+	struct Resource {
+
+		// Name, for debugging. Must outlive the graph
+		char const* name;
+
+		// Properties of the physical resource
+		Desc desc;
+
+		// Imported resources are provided from outside of the graph. They are
+		// never allocated or aliased, and passes writing to them are
+		// always kept
+		bool imported;
+
+		// Output resources need to remain valid after the last pass
+		bool output;
+
+		// *** Results of compile() ***
+
+		// Index into physicals. None if imported or unused
+		u32 physical;
+
+		// First and last non-culled pass that uses the resource. None
+		// if unused
+		PassID first;
+		PassID last;
+
+	};
+
+	struct Pass {
+
+		// Name, for debugging. Must outlive the graph
+		char const* name;
+
+		// Resources the pass depends on
+		svector<ResourceID, MaxPassResources> reads;
+
+		// Resources the pass modifies. A pass that blends into or otherwise
+		// preserves the previous contents should also list the resource
+		// as a read
+		svector<ResourceID, MaxPassResources> writes;
+
+		// *** Results of compile() ***
+
+		// True if the pass contributes to any output
+		bool alive;
+
+	};
+
+	// Declared resources, indexed by ResourceID
+	vector<Resource> resources;
+
+	// Declared passes in order of execution, indexed by PassID
+	vector<Pass> passes;
+
+	// Physical resources required to execute the compiled graph
+	vector<Desc> physicals;
+
+	// Remove all passes and resources, to declare a new frame.
+	void clear();
+
+	// Declare a transient resource, which only exists during the frame.
+	auto create(char const* name, Desc const& desc) -> ResourceID;
+
+	// Declare a resource that exists outside of the graph. Writing to it
+	// is a side effect, so it is implicitly an output.
+	auto importResource(char const* name) -> ResourceID;
+
+	// Declare a pass. Passes are executed in order of declaration.
+	auto addPass(char const* name) -> PassID;
+
+	// Declare that a pass depends on the contents of a resource.
+	void read(PassID pass, ResourceID resource);
+
+	// Declare that a pass modifies a resource.
+	void write(PassID pass, ResourceID resource);
+
+	// Mark a resource as required to be valid after the last pass.
+	void markOutput(ResourceID resource);
+
+	// Cull passes that don't contribute to any output, calculate resource
+	// lifetimes and assign physical resources. Resources with equal descs
+	// share a physical resource if their lifetimes are disjoint.
+	void compile();
+
+	// Number of passes that survived culling. Valid after compile().
+	[[nodiscard]]
+	auto alivePasses() const -> size_t;
+
+};
+
+}
+
+#include "engine/framegraph.tpp"
@@ -0,0 +1,179 @@
+#pragma once
+
+#include <algorithm>
+
+namespace minote {
+
+template<regular Desc>
+void FrameGraph<Desc>::clear()
+{
+	resources.clear();
+	passes.clear();
+	physicals.clear();
+}
+
+template<regular Desc>
+auto FrameGraph<Desc>::create(char const* const name, Desc const& desc) -> ResourceID
+{
+	ASSERT(name);
+
+	resources.push_back(Resource{
+		.name = name,
+		.desc = desc,
+		.imported = false,
+		.output = false,
+		.physical = None,
+		.first = None,
+		.last = None});
+	return resources.size() - 1;
+}
+
+template<regular Desc>
+auto FrameGraph<Desc>::importResource(char const* const name) -> ResourceID
+{
+	ASSERT(name);
+
+	resources.push_back(Resource{
+		.name = name,
+		.desc = {},
+		.imported = true,
+		.output = true,
+		.physical = None,
+		.first = None,
+		.last = None});
+	return resources.size() - 1;
+}
+
+template<regular Desc>
+auto FrameGraph<Desc>::addPass(char const* const name) -> PassID
+{
+	ASSERT(name);
+
+	passes.push_back(Pass{
+		.name = name,
+		.reads = {},
+		.writes = {},
+		.alive = false});
+	return passes.size() - 1;
+}
+
+template<regular Desc>
+void FrameGraph<Desc>::read(PassID const pass, ResourceID const resource)
+{
+	ASSERT(pass < passes.size());
+	ASSERT(resource < resources.size());
+	auto& reads = passes[pass].reads;
+	ASSERT(reads.size() < MaxPassResources);
+
+	if (std::find(reads.begin(), reads.end(), resource) == reads.end())
+		reads.push_back(resource);
+}
+
+template<regular Desc>
+void FrameGraph<Desc>::write(PassID const pass, ResourceID const resource)
+{
+	ASSERT(pass < passes.size());
+	ASSERT(resource < resources.size());
+	auto& writes = passes[pass].writes;
+	ASSERT(writes.size() < MaxPassResources);
+
+	if (std::find(writes.begin(), writes.end(), resource) == writes.end())
+		writes.push_back(resource);
+}
+
+template<regular Desc>
+void FrameGraph<Desc>::markOutput(ResourceID const resource)
+{
+	ASSERT(resource < resources.size());
+
+	resources[resource].output = true;
+}
+
+template<regular Desc>
+void FrameGraph<Desc>::compile()
+{
+	physicals.clear();
+	for (auto& resource: resources) {
+		resource.physical = None;
+		resource.first = None;
+		resource.last = None;
+	}
+
+	// Walk the passes backwards, keeping the ones that write to a resource
+	// that is needed later. Their reads become needed in turn
+	auto needed = vector<bool>(resources.size(), false);
+	for (size_t i = 0; i < resources.size(); i += 1)
+		needed[i] = resources[i].output;
+	for (size_t i = passes.size() - 1; i < passes.size(); i -= 1) {
+		auto& pass = passes[i];
+		pass.alive = std::any_of(pass.writes.begin(), pass.writes.end(),
+			[&](ResourceID const r) { return needed[r]; });
+		if (!pass.alive) continue;
+		for (auto const r: pass.reads)
+			needed[r] = true;
+	}
+
+	// Find the lifetime of each resource
+	auto const use = [&](ResourceID const r, PassID const p) {
+		auto& resource = resources[r];
+		if (resource.first == None)
+			resource.first = p;
+		resource.last = p;
+	};
+	for (size_t i = 0; i < passes.size(); i += 1) {
+		if (!passes[i].alive) continue;
+		for (auto const r: passes[i].reads)
+			use(r, i);
+		for (auto const r: passes[i].writes)
+			use(r, i);
+	}
+	for (auto& resource: resources) {
+		if (resource.output && resource.first != None)
+			resource.last = passes.size(); // Never released
+	}
+
+	// Assign physical resources in order of execution, reusing the ones
+	// released by earlier passes. Resources are released only after all
+	// of a pass's resources are acquired, so that a pass never reads and
+	// writes the same allocation through different resources
+	auto busy = vector<bool>();
+	auto const acquire = [&](ResourceID const r) {
+		auto& resource = resources[r];
+		if (resource.imported || resource.physical != None) return;
+		for (size_t i = 0; i < physicals.size(); i += 1) {
+			if (busy[i] || physicals[i] != resource.desc) continue;
+			resource.physical = i;
+			busy[i] = true;
+			return;
+		}
+		resource.physical = physicals.size();
+		physicals.push_back(resource.desc);
+		busy.push_back(true);
+	};
+	auto const release = [&](ResourceID const r, PassID const p) {
+		auto const& resource = resources[r];
+		if (resource.imported || resource.last != p) return;
+		busy[resource.physical] = false;
+	};
+	for (size_t i = 0; i < passes.size(); i += 1) {
+		auto const& pass = passes[i];
+		if (!pass.alive) continue;
+		for (auto const r: pass.reads)
+			acquire(r);
+		for (auto const r: pass.writes)
+			acquire(r);
+		for (auto const r: pass.reads)
+			release(r, i);
+		for (auto const r: pass.writes)
+			release(r, i);
+	}
+}
+
+template<regular Desc>
+auto FrameGraph<Desc>::alivePasses() const -> size_t
+{
+	return std::count_if(passes.begin(), passes.end(),
+		[](Pass const& pass) { return pass.alive; });
+}
+
+}
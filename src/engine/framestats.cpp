@@ -0,0 +1,121 @@
+#include "engine/framestats.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include "sys/glfw.hpp"
+#include "base/log.hpp"
+
+namespace minote {
+
+// Histogram bucket of a duration.
+static auto bucketOf(nsec const duration) -> size_t
+{
+	return std::min<size_t>(duration / FrameStatsBucketWidth, FrameStatsBuckets - 1);
+}
+
+// Upper bound of the histogram bucket that holds the pth percentile.
+static auto histogramPercentile(array<u64, FrameStatsBuckets> const& histogram,
+	u64 const total, f64 const p) -> nsec
+{
+	auto const rank = u64(std::ceil(p * f64(total)));
+	u64 seen = 0;
+	for (size_t i = 0; i < histogram.size(); i += 1) {
+		seen += histogram[i];
+		if (seen >= rank)
+			return FrameStatsBucketWidth * i64(i + 1);
+	}
+	return FrameStatsBucketWidth * i64(histogram.size());
+}
+
+// Convert a duration to fractional milliseconds, for printing.
+static auto toMs(nsec const duration) -> f64
+{
+	return f64(duration.count()) / 1'000'000.0;
+}
+
+void FrameStats::record(nsec const cpu, u32 const ticks)
+{
+	auto const now = Glfw::getTime();
+	defer { lastPresent = now; };
+	if (lastPresent == 0_s) return;
+
+	auto const present = now - lastPresent;
+	if (recent.isFull())
+		recent.pop_front();
+	recent.push_back({.cpu = cpu, .present = present, .ticks = ticks});
+
+	cpuHistogram[bucketOf(cpu)] += 1;
+	presentHistogram[bucketOf(present)] += 1;
+	cpuMax = std::max(cpuMax, cpu);
+	presentMax = std::max(presentMax, present);
+	frames += 1;
+	if (ticks > 1)
+		hitches += 1;
+}
+
+auto FrameStats::summary(nsec Sample::* const metric, size_t const window) const -> Summary
+{
+	auto result = Summary{
+		.p50 = 0_s,
+		.p95 = 0_s,
+		.p99 = 0_s,
+		.max = 0_s,
+		.frames = std::min(window, recent.size()),
+		.hitches = 0};
+	if (!result.frames) return result;
+
+	auto values = vector<nsec>();
+	values.reserve(result.frames);
+	for (size_t i = recent.size() - result.frames; i < recent.size(); i += 1) {
+		values.push_back(recent[i].*metric);
+		if (recent[i].ticks > 1)
+			result.hitches += 1;
+	}
+	std::sort(values.begin(), values.end());
+
+	// Nearest-rank percentiles
+	auto const percentile = [&](f64 const p) {
+		auto const rank = size_t(std::ceil(p * f64(values.size())));
+		return values[std::max<size_t>(rank, 1) - 1];
+	};
+	result.p50 = percentile(0.50);
+	result.p95 = percentile(0.95);
+	result.p99 = percentile(0.99);
+	result.max = values.back();
+	return result;
+}
+
+void FrameStats::exportReport(path const& filename) const
+{
+	auto output = file(filename, "w");
+
+	print(output, "Frames: {}\n", frames);
+	print(output, "Hitches: {} ({:.2f}%)\n\n", hitches,
+		frames? f64(hitches) * 100.0 / f64(frames) : 0.0);
+
+	print(output, "{:<10}{:>10}{:>10}{:>10}{:>10}\n", "ms", "p50", "p95", "p99", "max");
+	auto const printRow = [&](char const* const name,
+		array<u64, FrameStatsBuckets> const& histogram, nsec const max) {
+		print(output, "{:<10}{:>10.2f}{:>10.2f}{:>10.2f}{:>10.2f}\n", name,
+			toMs(std::min(histogramPercentile(histogram, frames, 0.50), max)),
+			toMs(std::min(histogramPercentile(histogram, frames, 0.95), max)),
+			toMs(std::min(histogramPercentile(histogram, frames, 0.99), max)),
+			toMs(max));
+	};
+	printRow("CPU", cpuHistogram, cpuMax);
+	printRow("Present", presentHistogram, presentMax);
+
+	print(output, "\n{:<16}{:>10}{:>10}\n", "ms", "CPU", "Present");
+	for (size_t i = 0; i < FrameStatsBuckets; i += 1) {
+		if (!cpuHistogram[i] && !presentHistogram[i]) continue;
+		auto const range = (i == FrameStatsBuckets - 1)?
+			format("{:.2f}+", toMs(FrameStatsBucketWidth * i64(i))) :
+			format("{:.2f}-{:.2f}", toMs(FrameStatsBucketWidth * i64(i)),
+				toMs(FrameStatsBucketWidth * i64(i + 1)));
+		print(output, "{:<16}{:>10}{:>10}\n", range, cpuHistogram[i], presentHistogram[i]);
+	}
+
+	L.info(R"(Frame statistics of {} frames written to "{}")", frames, output.where());
+}
+
+}
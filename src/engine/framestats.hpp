@@ -0,0 +1,95 @@
+// Minote - engine/framestats.hpp
+// Frame timing statistics. Tracks the CPU time of each frame, the interval
+// between presents and the number of logic ticks run during the frame. More
+// than one tick means that logic had to catch up, which is a visible hitch.
+// Percentiles are available over rolling windows of recent frames, and over
+// the whole session from a histogram
+
+#pragma once
+
+#include "base/array.hpp"
+#include "base/ring.hpp"
+#include "base/util.hpp"
+#include "base/time.hpp"
+#include "base/io.hpp"
+
+namespace minote {
+
+// Number of recent frames kept for rolling statistics
+constexpr size_t FrameStatsHistory = 3600;
+
+// Width of a session histogram bucket
+constexpr auto FrameStatsBucketWidth = milliseconds(0.25);
+
+// Number of session histogram buckets. The last one also holds all longer
+// frames
+constexpr size_t FrameStatsBuckets = 400;
+
+struct FrameStats {
+
+	// Measurements of a single frame
+	struct Sample {
+
+		// Time spent on the CPU, up to the present
+		nsec cpu;
+
+		// Time since the previous present
+		nsec present;
+
+		// Number of logic ticks run
+		u32 ticks;
+
+	};
+
+	// Distribution of a measurement over a number of frames
+	struct Summary {
+
+		nsec p50;
+		nsec p95;
+		nsec p99;
+		nsec max;
+
+		// Number of frames summarized
+		size_t frames;
+
+		// Number of summarized frames that ran more than one logic tick
+		size_t hitches;
+
+	};
+
+	// Recent frames, oldest first
+	ring<Sample, FrameStatsHistory> recent;
+
+	// Session histograms of both measurements, in FrameStatsBucketWidth steps
+	array<u64, FrameStatsBuckets> cpuHistogram = {};
+	array<u64, FrameStatsBuckets> presentHistogram = {};
+
+	// Session totals
+	u64 frames = 0;
+	u64 hitches = 0;
+	nsec cpuMax = 0_s;
+	nsec presentMax = 0_s;
+
+	// Record a frame that was just presented. cpu is the time the frame took
+	// before the present, ticks the number of logic ticks it ran. The first
+	// frame only sets the reference time for the present interval.
+	void record(nsec cpu, u32 ticks);
+
+	// Summarize a measurement over the most recent frames. window is
+	// the number of frames, clamped to the number available.
+	[[nodiscard]]
+	auto summary(nsec Sample::* metric, size_t window) const -> Summary;
+
+	// Write a plain text report of the session statistics, with both
+	// histograms. Percentiles are rounded up to their histogram bucket. Throws
+	// system_error on failure.
+	void exportReport(path const& filename) const;
+
+private:
+
+	// Time of the previous present, or 0 if none was recorded yet
+	nsec lastPresent = 0_s;
+
+};
+
+}
@@ -0,0 +1,149 @@
+#include "engine/gputimers.hpp"
+
+#include <algorithm>
+#include "base/math.hpp"
+#include "base/log.hpp"
+
+namespace minote {
+
+void GpuTimers::create()
+{
+	GLint bits = 0;
+	glGetQueryiv(GL_TIMESTAMP, GL_QUERY_COUNTER_BITS, &bits);
+	supported = (bits > 0);
+	frameCount = 0;
+
+	if (supported)
+		L.debug("GPU timers created with {}-bit timestamps", bits);
+	else
+		L.info("GPU timestamps are not supported, GPU timers are disabled");
+}
+
+void GpuTimers::destroy()
+{
+	for (auto& frame: frames) {
+		if (!frame.queries.empty())
+			glDeleteQueries(frame.queries.size(), frame.queries.data());
+		frame = {};
+	}
+	results.clear();
+	if (csv)
+		stopCsv();
+	active = false;
+	depth = 0;
+
+	L.debug("GPU timers destroyed");
+}
+
+void GpuTimers::beginFrame()
+{
+	ASSERT(depth == 0);
+	if (!supported) return;
+
+	// Timestamps complete in order, so the last one being available means
+	// that all of the frame is
+	auto& frame = frames[frameCount % GpuTimerLatency];
+	if (frame.used) {
+		GLint available = GL_FALSE;
+		glGetQueryObjectiv(frame.queries[frame.used - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+		if (available)
+			readback(frame);
+		else
+			dropped += 1;
+	}
+
+	frame.sections.clear();
+	frame.used = 0;
+	frame.frame = frameCount;
+	frameCount += 1;
+	active = enabled;
+	if (!active)
+		results.clear();
+}
+
+auto GpuTimers::begin(char const* const name) -> u32
+{
+	ASSERT(name);
+	if (!active) return None;
+
+	auto& frame = frames[(frameCount - 1) % GpuTimerLatency];
+	frame.sections.push_back({
+		.name = name,
+		.depth = depth,
+		.begin = timestamp(),
+		.end = None});
+	depth += 1;
+	return frame.sections.size() - 1;
+}
+
+void GpuTimers::end(u32 const section)
+{
+	if (section == None) return;
+	ASSERT(active);
+
+	auto& frame = frames[(frameCount - 1) % GpuTimerLatency];
+	ASSERT(section < frame.sections.size());
+	ASSERT(frame.sections[section].end == None);
+	frame.sections[section].end = timestamp();
+	depth -= 1;
+}
+
+void GpuTimers::startCsv(path const& filename)
+{
+	csv.open(filename, "w");
+	print(csv, "frame,section,depth,ms\n");
+	L.info(R"(Writing GPU timings to "{}")", csv.where());
+}
+
+void GpuTimers::stopCsv()
+{
+	ASSERT(csv);
+
+	L.info(R"(Finished writing GPU timings to "{}")", csv.where());
+	csv.close();
+}
+
+auto GpuTimers::timestamp() -> u32
+{
+	auto& frame = frames[(frameCount - 1) % GpuTimerLatency];
+	if (frame.used == frame.queries.size()) {
+		GLuint id = 0;
+		glGenQueries(1, &id);
+		frame.queries.push_back(id);
+	}
+
+	glQueryCounter(frame.queries[frame.used], GL_TIMESTAMP);
+	frame.used += 1;
+	return frame.used - 1;
+}
+
+void GpuTimers::readback(FrameQueries& frame)
+{
+	timestamps.resize(frame.used);
+	for (size_t i = 0; i < frame.used; i += 1)
+		glGetQueryObjectui64v(frame.queries[i], GL_QUERY_RESULT, &timestamps[i]);
+
+	// Smooth the durations only if the frame had the same sections as
+	// the previous one; otherwise start over
+	bool const smooth = std::equal(results.begin(), results.end(),
+		frame.sections.begin(), frame.sections.end(),
+		[](Result const& r, Section const& s) { return r.name == s.name && r.depth == s.depth; });
+	if (!smooth)
+		results.resize(frame.sections.size());
+
+	for (size_t i = 0; i < frame.sections.size(); i += 1) {
+		auto const& section = frame.sections[i];
+		ASSERT(section.end != None);
+		f32 const ms = f32(timestamps[section.end] - timestamps[section.begin]) / 1'000'000.0f;
+
+		auto& result = results[i];
+		result.name = section.name;
+		result.depth = section.depth;
+		result.ms = smooth? mix(result.ms, ms, GpuTimerSmoothing) : ms;
+
+		if (csv)
+			print(csv, "{},{},{},{:.4f}\n", frame.frame, section.name, section.depth, ms);
+	}
+}
+
+}
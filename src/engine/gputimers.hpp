@@ -0,0 +1,165 @@
+// Minote - engine/gputimers.hpp
+// GPU time measurement of named sections of a frame, with timestamp queries.
+// Results are read back a few frames late, once the GPU is done with them,
+// so the CPU never waits. If the driver can't provide timestamps, timing is
+// a no-op
+
+#pragma once
+
+#include "glad/glad.h"
+#include "base/array.hpp"
+#include "base/util.hpp"
+#include "base/io.hpp"
+
+namespace minote {
+
+// Number of frames of queries in flight. Results are this many frames old
+constexpr size_t GpuTimerLatency = 3;
+
+// Weight of the newest frame in the smoothed section durations
+constexpr f32 GpuTimerSmoothing = 0.1f;
+
+struct GpuTimers {
+
+	// Handle of a section that isn't timed
+	static constexpr u32 None = -1;
+
+	// A section recorded during a frame
+	struct Section {
+
+		// Name of the section. Must be a string literal
+		char const* name;
+
+		// Number of sections it is nested in
+		u32 depth;
+
+		// Indices of the timestamp queries at the start and end
+		u32 begin;
+		u32 end;
+
+	};
+
+	// Measured duration of a section
+	struct Result {
+
+		char const* name;
+		u32 depth;
+
+		// Duration in milliseconds, smoothed over recent frames
+		f32 ms;
+
+	};
+
+	// Queries of a frame that might still be in flight
+	struct FrameQueries {
+
+		vector<Section> sections;
+
+		// Pool of timestamp query objects. The first used ones were issued
+		// during the frame, in order
+		vector<GLuint> queries;
+		u32 used = 0;
+
+		// Number of the frame, counted from create()
+		u64 frame = 0;
+
+	};
+
+	// Whether the driver provides timestamps. Valid after create()
+	bool supported = false;
+
+	// Whether sections are timed. Changes take effect on the next beginFrame()
+	bool enabled = false;
+
+	// Durations of the sections of the last frame that was read back,
+	// in order of their start
+	vector<Result> results;
+
+	// Number of frames whose results were not ready in time, and were dropped
+	u64 dropped = 0;
+
+	// Check for timestamp support. Queries are allocated on demand.
+	void create();
+
+	// Free all queries, and close the CSV file if open.
+	void destroy();
+
+	// Read back the results of the oldest frame in flight, if they are ready,
+	// and start recording a new frame. No sections can be open.
+	void beginFrame();
+
+	// Start a section, and return its handle for end(). Sections can
+	// be nested.
+	auto begin(char const* name) -> u32;
+
+	// Finish a section. Sections must be finished in reverse order of start.
+	void end(u32 section);
+
+	// Start appending the durations of every frame that is read back to a CSV
+	// file, one row per section. Throws system_error on failure.
+	void startCsv(path const& filename);
+
+	// Stop appending to the CSV file, and close it.
+	void stopCsv();
+
+	// Whether durations are being written to a CSV file.
+	[[nodiscard]]
+	auto isCsvOpen() const -> bool { return csv.isOpen(); }
+
+private:
+
+	array<FrameQueries, GpuTimerLatency> frames;
+
+	// Number of frames started so far
+	u64 frameCount = 0;
+
+	// Whether the frame being recorded is timed
+	bool active = false;
+
+	// Nesting depth of the next section
+	u32 depth = 0;
+
+	// Output of startCsv()
+	file csv;
+
+	// Scratch space for readback
+	vector<GLuint64> timestamps;
+
+	// Issue a timestamp query into the frame being recorded, and return
+	// its index.
+	auto timestamp() -> u32;
+
+	// Retrieve the results of a frame whose queries are all available.
+	void readback(FrameQueries& frame);
+
+};
+
+// Times the GPU work submitted between construction and destruction
+// as a section. Use with the GPU_ZONE macro.
+struct GpuZone {
+
+	GpuZone(GpuTimers& _timers, char const* const name):
+		timers{_timers}, section{timers.begin(name)} {}
+
+	~GpuZone() { timers.end(section); }
+
+	GpuZone(GpuZone const&) = delete;
+	auto operator=(GpuZone const&) -> GpuZone& = delete;
+
+private:
+
+	GpuTimers& timers;
+	u32 section;
+
+};
+
+#define GPU_ZONE_CONCAT_IMPL(a, b) a##b
+#define GPU_ZONE_CONCAT(a, b) GPU_ZONE_CONCAT_IMPL(a, b)
+
+// Time the GPU work of the rest of the current scope as a section with
+// the given name.
+// Example: GPU_ZONE(engine.frame.timers, "particles");
+#define GPU_ZONE(timers, name) \
+	::minote::GpuZone const GPU_ZONE_CONCAT(gpuZone_, __LINE__){timers, name}
+
+}
@@ -0,0 +1,168 @@
+#include "engine/mesh.hpp"
+
+#include <algorithm>
+#include <utility>
+#include <cmath>
+
+namespace minote {
+
+// Parameters of the vertex cache optimizer, as proposed in
+// https://tomforsyth1000.github.io/papers/fast_vert_cache_opt.html
+static constexpr size_t ForsythCacheSize = 32;
+static constexpr f32 CacheDecayPower = 1.5f;
+static constexpr f32 LastTriangleScore = 0.75f;
+static constexpr f32 ValenceBoostScale = 2.0f;
+static constexpr f32 ValenceBoostPower = 0.5f;
+
+// Score a vertex by its position in the modeled LRU cache (-1 if not cached)
+// and the number of its triangles that are yet to be emitted.
+static auto vertexScore(i32 const cachePosition, u32 const remaining) -> f32
+{
+	if (remaining == 0)
+		return -1.0f; // Vertex is not used anymore
+
+	auto score = 0.0f;
+	if (cachePosition >= 0) {
+		if (cachePosition < 3) {
+			// Vertices of the last triangle get a fixed score, so that strips
+			// are not favored over fans
+			score = LastTriangleScore;
+		} else {
+			f32 const scaler = 1.0f / f32(ForsythCacheSize - 3);
+			score = std::pow(1.0f - f32(cachePosition - 3) * scaler, CacheDecayPower);
+		}
+	}
+
+	// Prefer vertices with few triangles left, so that they are finished off
+	// and don't need to be loaded again later
+	score += ValenceBoostScale * std::pow(f32(remaining), -ValenceBoostPower);
+	return score;
+}
+
+void optimizeVertexCache(span<MeshIndex> const indices, size_t const vertexCount)
+{
+	ASSERT(indices.size() % 3 == 0);
+	size_t const triangleCount = indices.size() / 3;
+	if (triangleCount == 0)
+		return;
+
+	// Build the list of triangles using each vertex. The first remaining[v]
+	// triangles of vertex v's list are the ones not emitted yet
+	auto remaining = vector<u32>(vertexCount, 0);
+	for (auto const index: indices) {
+		ASSERT(index < vertexCount);
+		remaining[index] += 1;
+	}
+	auto adjacencyOffset = vector<u32>(vertexCount + 1, 0);
+	for (size_t v = 0; v < vertexCount; v += 1)
+		adjacencyOffset[v + 1] = adjacencyOffset[v] + remaining[v];
+	auto adjacency = vector<u32>(indices.size());
+	auto fill = vector<u32>(adjacencyOffset.begin(), adjacencyOffset.end() - 1);
+	for (size_t i = 0; i < indices.size(); i += 1) {
+		adjacency[fill[indices[i]]] = i / 3;
+		fill[indices[i]] += 1;
+	}
+	auto const triangles = [&](u32 const v) {
+		return span{adjacency}.subspan(adjacencyOffset[v], remaining[v]);
+	};
+
+	auto cachePosition = vector<i32>(vertexCount, -1);
+	auto vertexScores = vector<f32>(vertexCount);
+	for (size_t v = 0; v < vertexCount; v += 1)
+		vertexScores[v] = vertexScore(-1, remaining[v]);
+	auto triangleScores = vector<f32>(triangleCount, 0.0f);
+	for (size_t i = 0; i < indices.size(); i += 1)
+		triangleScores[i / 3] += vertexScores[indices[i]];
+	auto emitted = vector<bool>(triangleCount, false);
+
+	// Fallback for when no cached vertex has any triangles left
+	auto const findBest = [&]() -> size_t {
+		auto best = triangleCount;
+		for (size_t t = 0; t < triangleCount; t += 1) {
+			if (emitted[t]) continue;
+			if (best == triangleCount || triangleScores[t] > triangleScores[best])
+				best = t;
+		}
+		return best;
+	};
+
+	auto result = vector<MeshIndex>();
+	result.reserve(indices.size());
+	auto cache = vector<u32>();
+	cache.reserve(ForsythCacheSize + 3);
+	auto newCache = vector<u32>();
+	newCache.reserve(ForsythCacheSize + 3);
+
+	auto best = findBest();
+	while (best != triangleCount) {
+		auto const triangle = span{indices}.subspan(best * 3, 3);
+
+		// Emit the triangle and remove it from its vertices' lists
+		emitted[best] = true;
+		for (auto const v: triangle) {
+			result.push_back(v);
+			auto const list = triangles(v);
+			std::iter_swap(std::find(list.begin(), list.end(), best), list.end() - 1);
+			remaining[v] -= 1;
+		}
+
+		// Move the triangle's vertices to the front of the cache
+		newCache.clear();
+		for (auto const v: triangle)
+			if (std::find(newCache.begin(), newCache.end(), v) == newCache.end())
+				newCache.push_back(v);
+		for (auto const v: cache)
+			if (std::find(triangle.begin(), triangle.end(), v) == triangle.end())
+				newCache.push_back(v);
+
+		// Rescore every vertex that was or is in the cache, including the ones
+		// that were just pushed out of it
+		for (size_t i = 0; i < newCache.size(); i += 1) {
+			auto const v = newCache[i];
+			cachePosition[v] = i < ForsythCacheSize ? i32(i) : -1;
+			auto const score = vertexScore(cachePosition[v], remaining[v]);
+			auto const delta = score - vertexScores[v];
+			vertexScores[v] = score;
+			for (auto const t: triangles(v))
+				triangleScores[t] += delta;
+		}
+		if (newCache.size() > ForsythCacheSize)
+			newCache.resize(ForsythCacheSize);
+		std::swap(cache, newCache);
+
+		// Continue with the best triangle that uses a cached vertex
+		best = triangleCount;
+		for (auto const v: cache) {
+			for (auto const t: triangles(v)) {
+				if (best == triangleCount || triangleScores[t] > triangleScores[best])
+					best = t;
+			}
+		}
+		if (best == triangleCount)
+			best = findBest();
+	}
+
+	std::copy(result.begin(), result.end(), indices.begin());
+}
+
+auto vertexCacheACMR(span<MeshIndex const> const indices) -> f32
+{
+	ASSERT(indices.size() % 3 == 0);
+	if (indices.empty())
+		return 0.0f;
+
+	auto cache = array<i32, VertexCacheSize>{};
+	cache.fill(-1);
+	size_t next = 0;
+	size_t misses = 0;
+	for (auto const index: indices) {
+		if (std::find(cache.begin(), cache.end(), index) != cache.end())
+			continue;
+		cache[next] = index;
+		next = (next + 1) % VertexCacheSize;
+		misses += 1;
+	}
+	return f32(misses) / f32(indices.size() / 3);
+}
+
+}
@@ -0,0 +1,39 @@
+// Minote - engine/mesh.hpp
+// Conversion of triangle lists into indexed meshes that are efficient to draw
+
+#pragma once
+
+#include "base/array.hpp"
+#include "base/util.hpp"
+
+namespace minote {
+
+// Type of a mesh's vertex indices. A mesh can have at most 65536 unique vertices
+using MeshIndex = u16;
+
+// Size of the FIFO post-transform vertex cache modeled by vertexCacheACMR()
+constexpr size_t VertexCacheSize = 16;
+
+// Merge identical vertices of a non-indexed triangle list. Unique vertices
+// are written to outVertices in order of first appearance, and outIndices
+// receives one index per input vertex. Vertices are compared bytewise,
+// so T must not contain padding.
+template<copy_constructible T>
+void weldVertices(span<T const> vertices, vector<T>& outVertices,
+	vector<MeshIndex>& outIndices);
+
+// Reorder the triangles of an indexed triangle list to improve post-transform
+// vertex cache hit rate, using Tom Forsyth's linear-speed algorithm. Winding
+// of each triangle is preserved.
+void optimizeVertexCache(span<MeshIndex> indices, size_t vertexCount);
+
+// Calculate the average cache miss ratio of an indexed triangle list - the
+// number of vertex shader invocations per triangle, with a FIFO cache of
+// VertexCacheSize entries. A non-indexed list scores 3.0, and a regular grid
+// can approach 0.5.
+[[nodiscard]]
+auto vertexCacheACMR(span<MeshIndex const> indices) -> f32;
+
+}
+
+#include "engine/mesh.tpp"
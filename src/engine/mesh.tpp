@@ -0,0 +1,50 @@
+#pragma once
+
+#include <type_traits>
+#include <algorithm>
+#include <numeric>
+#include <limits>
+#include <cstring>
+
+namespace minote {
+
+template<copy_constructible T>
+void weldVertices(span<T const> const vertices, vector<T>& outVertices,
+	vector<MeshIndex>& outIndices)
+{
+	static_assert(std::is_trivially_copyable_v<T>);
+
+	auto const compare = [=](u32 const left, u32 const right) {
+		return std::memcmp(&vertices[left], &vertices[right], sizeof(T));
+	};
+
+	// Sort vertex indices so that identical vertices are adjacent, keeping
+	// the original order within each group
+	auto order = vector<u32>(vertices.size());
+	std::iota(order.begin(), order.end(), 0);
+	std::stable_sort(order.begin(), order.end(), [=](u32 const left, u32 const right) {
+		return compare(left, right) < 0;
+	});
+
+	// Map every vertex to the first occurrence of its value
+	auto first = vector<u32>(vertices.size());
+	for (size_t i = 0; i < order.size(); i += 1) {
+		bool const duplicate = (i > 0 && compare(order[i - 1], order[i]) == 0);
+		first[order[i]] = duplicate ? first[order[i - 1]] : order[i];
+	}
+
+	outVertices.clear();
+	outIndices.clear();
+	outIndices.reserve(vertices.size());
+	auto remap = vector<MeshIndex>(vertices.size());
+	for (size_t i = 0; i < vertices.size(); i += 1) {
+		if (first[i] == i) {
+			ASSERT(outVertices.size() <= std::numeric_limits<MeshIndex>::max());
+			remap[i] = outVertices.size();
+			outVertices.push_back(vertices[i]);
+		}
+		outIndices.push_back(remap[first[i]]);
+	}
+}
+
+}
@@ -0,0 +1,100 @@
+// Minote - engine/meshpack.hpp
+// Binary mesh format. Written at build time by the Meshpack tool,
+// memory-mapped and uploaded as-is by the models
+
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <cmath>
+#include "base/util.hpp"
+
+namespace minote {
+
+// Layout of the file:
+// - MeshpackHeader
+// - MeshpackVertex[vertexCount] at vertexOffset
+// - u16[indexCount] at indexOffset; every 3 indices form a triangle,
+//   ordered for vertex cache locality
+// All values are little-endian.
+
+// "MMSH" as a little-endian u32
+constexpr u32 MeshpackMagic = 0x48534D4D;
+
+// Increment on every change to the structs below
+constexpr u32 MeshpackVersion = 1;
+
+// Offsets are aligned to this many bytes
+constexpr size_t MeshpackAlignment = 16;
+
+struct MeshpackHeader {
+
+	u32 magic;
+	u32 version;
+
+	// Number of MeshpackVertex entries, and number of u16 indices
+	u32 vertexCount;
+	u32 indexCount;
+
+	// Byte offsets of the sections from the start of the file
+	u64 vertexOffset;
+	u64 indexOffset;
+
+};
+
+// Vertex layout shared by all models, in the format of the vertex buffer
+struct MeshpackVertex {
+
+	// Position in model space as half-precision floats. The last component
+	// is padding
+	u16 pos[4];
+
+	// Normal in GL_INT_2_10_10_10_REV format, signed normalized. Zero if
+	// the model doesn't use lighting
+	u32 normal;
+
+	// RGBA color, unsigned normalized
+	u8 color[4];
+
+};
+
+static_assert(sizeof(MeshpackHeader) == 32);
+static_assert(sizeof(MeshpackVertex) == 16);
+
+// Convert a float to the nearest half-precision float, as its bit pattern.
+inline auto packHalf(f32 const value) -> u16
+{
+	u32 bits = 0;
+	std::memcpy(&bits, &value, sizeof(bits));
+	u32 const sign = (bits >> 16) & 0x8000;
+	u32 const magnitude = bits & 0x7FFFFFFF;
+
+	if (magnitude >= 0x7F800000) // Infinity or NaN
+		return sign | 0x7C00 | (magnitude > 0x7F800000 ? 0x200 : 0);
+	if (magnitude >= 0x477FF000) // Rounds to infinity
+		return sign | 0x7C00;
+	if (magnitude < 0x38800000) // Subnormal; scaling by 2^24 is exact
+		return sign | u16(std::nearbyint(std::abs(value) * 16777216.0f));
+
+	// Rebias the exponent and round the mantissa to nearest even
+	u32 const rounded = magnitude + 0xFFF + ((magnitude >> 13) & 1);
+	return sign | ((rounded - 0x38000000) >> 13);
+}
+
+// Pack a normal vector into GL_INT_2_10_10_10_REV format.
+inline auto packNormal(f32 const x, f32 const y, f32 const z) -> u32
+{
+	auto const snorm10 = [](f32 const value) -> u32 {
+		auto const scaled = std::lround(std::clamp(value, -1.0f, 1.0f) * 511.0f);
+		return u32(scaled) & 0x3FF;
+	};
+	return snorm10(x) | snorm10(y) << 10 | snorm10(z) << 20;
+}
+
+// Convert a [0, 1] value to unsigned normalized u8.
+inline auto packUnorm8(f32 const value) -> u8
+{
+	return u8(std::lround(std::clamp(value, 0.0f, 1.0f) * 255.0f));
+}
+
+}
@@ -1,5 +1,9 @@
 #include "engine/model.hpp"
 
+#include <cstring>
+#include "base/io.hpp"
+#include "base/log.hpp"
+
 namespace minote {
 
 // Generate normals in-place for an array of vertices.
@@ -19,24 +23,121 @@ static void generatePhongNormals(span<ModelPhong::Vertex> const vertices)
 	}
 }
 
+// Convert a vertex to the format of the vertex buffer.
+static auto packVertex(vec3 const pos, vec3 const normal, color4 const color)
+	-> MeshpackVertex
+{
+	return MeshpackVertex{
+		.pos = {packHalf(pos.x), packHalf(pos.y), packHalf(pos.z), packHalf(1.0f)},
+		.normal = packNormal(normal.x, normal.y, normal.z),
+		.color = {packUnorm8(color.r), packUnorm8(color.g),
+			packUnorm8(color.b), packUnorm8(color.a)}};
+}
+
+// Convert a triangle list into unique vertices and an index list optimized
+// for the vertex cache, and report the improvement.
+static void indexMesh(char const* const name, span<MeshpackVertex const> const input,
+	vector<MeshpackVertex>& vertices, vector<MeshIndex>& indices)
+{
+	weldVertices(input, vertices, indices);
+	auto const acmrBefore = vertexCacheACMR(indices);
+	optimizeVertexCache(indices, vertices.size());
+	auto const acmrAfter = vertexCacheACMR(indices);
+
+	L.debug(R"(Model "{}": welded {} vertices into {}, ACMR {:.3f} -> {:.3f})",
+		name, input.size(), vertices.size(), acmrBefore, acmrAfter);
+}
+
+// Map a mesh file created by the Meshpack tool and locate its sections.
+// On failure, an error is logged and the spans are left empty.
+static void mapMesh(char const* const name, char const* const path,
+	mapped_file& pack, span<MeshpackVertex const>& vertices,
+	span<MeshIndex const>& indices)
+{
+	vertices = {};
+	indices = {};
+
+	try {
+		pack.open(path);
+	} catch (system_error const& e) {
+		L.error(R"(Failed to load model "{}": {})", name, e.what());
+		return;
+	}
+	auto const bytes = pack.bytes();
+
+	MeshpackHeader header = {};
+	if (bytes.size() >= sizeof(header))
+		std::memcpy(&header, bytes.data(), sizeof(header));
+	if (header.magic != MeshpackMagic || header.version != MeshpackVersion) {
+		L.error(R"(Failed to load model "{}": {} is not a version {} mesh file)",
+			name, path, MeshpackVersion);
+		return;
+	}
+	size_t const verticesLen = header.vertexCount * sizeof(MeshpackVertex);
+	size_t const indicesLen = header.indexCount * sizeof(MeshIndex);
+	if (header.vertexOffset + verticesLen > bytes.size() ||
+		header.indexOffset + indicesLen > bytes.size() ||
+		header.vertexOffset % MeshpackAlignment != 0 ||
+		header.indexOffset % MeshpackAlignment != 0 ||
+		header.indexCount % 3 != 0) {
+		L.error(R"(Failed to load model "{}": {} is malformed)", name, path);
+		return;
+	}
+
+	vertices = {reinterpret_cast<MeshpackVertex const*>(
+		bytes.data() + header.vertexOffset), header.vertexCount};
+	indices = {reinterpret_cast<MeshIndex const*>(
+		bytes.data() + header.indexOffset), header.indexCount};
+}
+
 void ModelFlat::create(char const* _name, Shaders& shaders,
 	span<Vertex const> const _vertices)
 {
 	ASSERT(_name);
 	ASSERT(_vertices.size() % 3 == 0);
 
+	auto packed = vector<MeshpackVertex>();
+	packed.reserve(_vertices.size());
+	for (auto const& v: _vertices)
+		packed.push_back(packVertex(v.pos, vec3{0.0f}, v.color));
+
+	auto meshVertices = vector<MeshpackVertex>();
+	auto meshIndices = vector<MeshIndex>();
+	indexMesh(_name, packed, meshVertices, meshIndices);
+	upload(_name, shaders, meshVertices, meshIndices);
+}
+
+void ModelFlat::load(char const* _name, Shaders& shaders, char const* path)
+{
+	ASSERT(_name);
+	ASSERT(path);
+
+	mapped_file pack;
+	span<MeshpackVertex const> meshVertices;
+	span<MeshIndex const> meshIndices;
+	mapMesh(_name, path, pack, meshVertices, meshIndices);
+	upload(_name, shaders, meshVertices, meshIndices);
+}
+
+void ModelFlat::upload(char const* _name, Shaders& shaders,
+	span<MeshpackVertex const> const _vertices,
+	span<MeshIndex const> const _indices)
+{
 	vertices.create("Flat::vertices", false);
 	vertices.upload(_vertices);
+	indices.create("Flat::indices", false);
 	instances.create("Flat::instances", true);
 	vao.create("Flat::vao");
-	vao.setAttribute(0, vertices, &Vertex::pos);
-	vao.setAttribute(1, vertices, &Vertex::color);
+	vao.setElements(indices);
+	indices.upload(_indices);
+	vao.setAttribute(0, vertices, &MeshpackVertex::pos, 3, GL_HALF_FLOAT, false);
+	vao.setAttribute(1, vertices, &MeshpackVertex::color, 4, GL_UNSIGNED_BYTE, true);
 	vao.setAttribute(2, instances, &Instance::tint, true);
 	vao.setAttribute(3, instances, &Instance::highlight, true);
 	vao.setAttribute(4, instances, &Instance::transform, true);
 	drawcall.shader = &shaders.flat;
 	drawcall.vertexarray = &vao;
-	drawcall.triangles = _vertices.size() / 3;
+	drawcall.triangles = _indices.size() / 3;
 
 	name = _name;
 	L.debug(R"(Model "{}" created)", name);
@@ -47,6 +148,7 @@ void ModelFlat::destroy()
 	ASSERT(vertices.id);
 
 	vertices.destroy();
+	indices.destroy();
 	instances.destroy();
 	vao.destroy();
 	drawcall = {};
@@ -55,13 +157,13 @@ void ModelFlat::destroy()
 	name = nullptr;
 }
 
-void ModelFlat::draw(Framebuffer& fb, Scene const& scene,
+void ModelFlat::draw(Framebuffer* const fb, Scene const& scene,
 	DrawParams const& params)
 {
 	draw(fb, scene, params, Instance{});
 }
 
-void ModelFlat::draw(Framebuffer& fb, Scene const& scene,
+void ModelFlat::draw(Framebuffer* const fb, Scene const& scene,
 	DrawParams const& params, Instance const& instance)
 {
 	ASSERT(vertices.id);
@@ -69,13 +171,13 @@ void ModelFlat::draw(Framebuffer& fb, Scene const& scene,
 	instances.upload(array{instance});
 	drawcall.shader->view = scene.view;
 	drawcall.shader->projection = scene.projection;
-	drawcall.framebuffer = &fb;
+	drawcall.framebuffer = fb;
 	drawcall.instances = 1;
 	drawcall.params = params;
 	drawcall.draw();
 }
 
-void ModelFlat::draw(Framebuffer& fb, Scene const& scene,
+void ModelFlat::draw(Framebuffer* const fb, Scene const& scene,
 	DrawParams const& params, span<Instance const> const _instances)
 {
 	ASSERT(vertices.id);
@@ -83,12 +185,36 @@ void ModelFlat::draw(Framebuffer& fb, Scene const& scene,
 	instances.upload(_instances);
 	drawcall.shader->view = scene.view;
 	drawcall.shader->projection = scene.projection;
-	drawcall.framebuffer = &fb;
+	drawcall.framebuffer = fb;
 	drawcall.instances = _instances.size();
 	drawcall.params = params;
 	drawcall.draw();
 }
 
+// Check that a transform has only uniform scaling and no shear.
+static auto isConformal(mat3 const& transform) -> bool
+{
+	constexpr f32 Epsilon = 1.0e-4f;
+
+	f32 const x2 = dot(transform[0], transform[0]);
+	f32 const y2 = dot(transform[1], transform[1]);
+	f32 const z2 = dot(transform[2], transform[2]);
+	f32 const tolerance = Epsilon * x2;
+	return abs(y2 - x2) <= tolerance &&
+		abs(z2 - x2) <= tolerance &&
+		abs(dot(transform[0], transform[1])) <= tolerance &&
+		abs(dot(transform[1], transform[2])) <= tolerance &&
+		abs(dot(transform[2], transform[0])) <= tolerance;
+}
+
+auto phongNormalMatrix(mat4 const& modelView) -> mat3
+{
+	auto const linear = mat3(modelView);
+	if (isConformal(linear)) [[likely]]
+		return linear;
+	return transpose(inverse(linear));
+}
+
 void ModelPhong::create(char const* _name, Shaders& shaders,
 	span<Vertex const> const _vertices, Material _material,
 	bool const generateNormals)
@@ -96,27 +222,58 @@ void ModelPhong::create(char const* _name, Shaders& shaders,
 	ASSERT(_name);
 	ASSERT(_vertices.size() % 3 == 0);
 
-	vertices.create("Phong::vertices", false);
-	if (generateNormals) {
-		auto normVertices = vector<Vertex>{_vertices.begin(), _vertices.end()};
+	auto normVertices = vector<Vertex>{_vertices.begin(), _vertices.end()};
+	if (generateNormals)
 		generatePhongNormals(normVertices);
-		vertices.upload(normVertices);
-	} else {
-		vertices.upload(_vertices);
-	}
+	auto packed = vector<MeshpackVertex>();
+	packed.reserve(normVertices.size());
+	for (auto const& v: normVertices)
+		packed.push_back(packVertex(v.pos, v.normal, v.color));
 
+	// Welding happens after normal generation, since flat normals make
+	// vertices shared between faces distinct
+	auto meshVertices = vector<MeshpackVertex>();
+	auto meshIndices = vector<MeshIndex>();
+	indexMesh(_name, packed, meshVertices, meshIndices);
+	upload(_name, shaders, meshVertices, meshIndices, _material);
+}
+
+void ModelPhong::load(char const* _name, Shaders& shaders, char const* path,
+	Material _material)
+{
+	ASSERT(_name);
+	ASSERT(path);
+
+	mapped_file pack;
+	span<MeshpackVertex const> meshVertices;
+	span<MeshIndex const> meshIndices;
+	mapMesh(_name, path, pack, meshVertices, meshIndices);
+	upload(_name, shaders, meshVertices, meshIndices, _material);
+}
+
+void ModelPhong::upload(char const* _name, Shaders& shaders,
+	span<MeshpackVertex const> const _vertices,
+	span<MeshIndex const> const _indices, Material _material)
+{
+	vertices.create("Phong::vertices", false);
+	vertices.upload(_vertices);
+	indices.create("Phong::indices", false);
 	instances.create("Phong::instances", true);
+	normals.create("Phong::normals", true);
 	material = _material;
 	vao.create("Phong::vao");
-	vao.setAttribute(0, vertices, &Vertex::pos);
-	vao.setAttribute(1, vertices, &Vertex::color);
-	vao.setAttribute(2, vertices, &Vertex::normal);
+	vao.setElements(indices);
+	indices.upload(_indices);
+	vao.setAttribute(0, vertices, &MeshpackVertex::pos, 3, GL_HALF_FLOAT, false);
+	vao.setAttribute(1, vertices, &MeshpackVertex::color, 4, GL_UNSIGNED_BYTE, true);
+	vao.setAttribute(2, vertices, &MeshpackVertex::normal, 4, GL_INT_2_10_10_10_REV, true);
 	vao.setAttribute(3, instances, &Instance::tint, true);
 	vao.setAttribute(4, instances, &Instance::highlight, true);
 	vao.setAttribute(5, instances, &Instance::transform, true);
+	vao.setAttribute(9, normals, true);
 	drawcall.shader = &shaders.phong;
 	drawcall.vertexarray = &vao;
-	drawcall.triangles = _vertices.size() / 3;
+	drawcall.triangles = _indices.size() / 3;
 
 	name = _name;
 	L.debug(R"(Model "{}" created)", name);
@@ -127,7 +284,10 @@ void ModelPhong::destroy()
 	ASSERT(vertices.id);
 
 	vertices.destroy();
+	indices.destroy();
 	instances.destroy();
+	normals.destroy();
+	normalMatrices.clear();
 	vao.destroy();
 	drawcall = {};
 
@@ -135,38 +295,29 @@ void ModelPhong::destroy()
 	name = nullptr;
 }
 
-void ModelPhong::draw(Framebuffer& fb, Scene const& scene,
+void ModelPhong::draw(Framebuffer* const fb, Scene const& scene,
 	DrawParams const& params)
 {
 	draw(fb, scene, params, Instance{});
 }
 
-void ModelPhong::draw(Framebuffer& fb, Scene const& scene,
+void ModelPhong::draw(Framebuffer* const fb, Scene const& scene,
 	DrawParams const& params, Instance const& instance)
 {
-	ASSERT(vertices.id);
-
-	instances.upload(array{instance});
-	drawcall.shader->view = scene.view;
-	drawcall.shader->projection = scene.projection;
-	drawcall.shader->lightPosition = scene.light.position;
-	drawcall.shader->lightColor = scene.light.color;
-	drawcall.shader->ambient = material.ambient;
-	drawcall.shader->diffuse = material.diffuse;
-	drawcall.shader->specular = material.specular;
-	drawcall.shader->shine = material.shine;
-	drawcall.framebuffer = &fb;
-	drawcall.instances = 1;
-	drawcall.params = params;
-	drawcall.draw();
+	draw(fb, scene, params, span{&instance, 1});
 }
 
-void ModelPhong::draw(Framebuffer& fb, Scene const& scene,
+void ModelPhong::draw(Framebuffer* const fb, Scene const& scene,
 	DrawParams const& params, span<Instance const> const _instances)
 {
-		ASSERT(vertices.id);
+	ASSERT(vertices.id);
+
+	normalMatrices.resize(_instances.size());
+	for (size_t i = 0; i < _instances.size(); i += 1)
+		normalMatrices[i] = phongNormalMatrix(scene.view * _instances[i].transform);
 
 	instances.upload(_instances);
+	normals.upload(normalMatrices);
 	drawcall.shader->view = scene.view;
 	drawcall.shader->projection = scene.projection;
 	drawcall.shader->lightPosition = scene.light.position;
@@ -175,7 +326,7 @@ void ModelPhong::draw(Framebuffer& fb, Scene const& scene,
 	drawcall.shader->diffuse = material.diffuse;
 	drawcall.shader->specular = material.specular;
 	drawcall.shader->shine = material.shine;
-	drawcall.framebuffer = &fb;
+	drawcall.framebuffer = fb;
 	drawcall.instances = _instances.size();
 	drawcall.params = params;
 	drawcall.draw();
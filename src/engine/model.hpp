@@ -8,6 +8,8 @@
 #include "sys/opengl/buffer.hpp"
 #include "sys/opengl/draw.hpp"
 #include "engine/scene.hpp"
+#include "engine/meshpack.hpp"
+#include "engine/mesh.hpp"
 #include "store/shaders.hpp"
 
 namespace minote {
@@ -42,8 +44,11 @@ struct ModelFlat {
 	// Model name for logging and debugging
 	char const* name = nullptr;
 
-	// VBO of static vertex data
-	VertexBuffer<Vertex> vertices;
+	// VBO of static vertex data, packed and with duplicate vertices removed
+	VertexBuffer<MeshpackVertex> vertices;
+
+	// EBO of triangle vertex indices, ordered for vertex cache locality
+	ElementBuffer<MeshIndex> indices;
 
 	// VBO of instance data, uploaded every draw
 	VertexBuffer<Instance> instances;
@@ -54,27 +59,45 @@ struct ModelFlat {
 	// Cached drawcall data
 	Draw<Shaders::Flat> drawcall;
 
-	// Create the model from an array of vertices.
+	// Create the model from an array of vertices, each three of which form
+	// a triangle. Identical vertices are merged into one.
 	void create(char const* name, Shaders& shaders, span<Vertex const> vertices);
 
+	// Create the model from a mesh file written by the Meshpack tool. If the file
+	// cannot be loaded, an error is logged and the model is created empty.
+	void load(char const* name, Shaders& shaders, char const* path);
+
 	// Free up all resources used by the model.
 	void destroy();
 
-	// Draw the model with specified parameters and identity instance.
-	void draw(Framebuffer& fb, Scene const& scene, DrawParams const& params);
+	// Draw the model with specified parameters and identity instance. If fb
+	// is nullptr, the model is drawn into the backbuffer.
+	void draw(Framebuffer* fb, Scene const& scene, DrawParams const& params);
 
 	// Draw the model with specified parameters and custom instance data.
-	void draw(Framebuffer& fb, Scene const& scene, DrawParams const& params,
+	void draw(Framebuffer* fb, Scene const& scene, DrawParams const& params,
 		Instance const& instance);
 
 	// Draw multiple instances of the model with specified parameters
 	// and an array of instance data. Number of instances drawn is the size
 	// of the instance data array.
-	void draw(Framebuffer& fb, Scene const& scene, DrawParams const& params,
+	void draw(Framebuffer* fb, Scene const& scene, DrawParams const& params,
 		span<Instance const> instances);
 
+private:
+
+	// Create the GPU objects from processed mesh data.
+	void upload(char const* name, Shaders& shaders,
+		span<MeshpackVertex const> vertices, span<MeshIndex const> indices);
+
 };
 
+// Matrix that transforms normals by a model-view matrix. If the transform
+// is a rotation with translation and uniform scale, normals can use
+// the matrix itself and skip the inverse transpose. The result is
+// not normalized.
+auto phongNormalMatrix(mat4 const& modelView) -> mat3;
+
 // Phong shaded model - the Phong-Blinn lighting model is used
 struct ModelPhong {
 
@@ -124,12 +147,22 @@ struct ModelPhong {
 	// Model name for logging and debugging
 	char const* name = nullptr;
 
-	// VBO of static vertex data
-	VertexBuffer<Vertex> vertices;
+	// VBO of static vertex data, packed and with duplicate vertices removed
+	VertexBuffer<MeshpackVertex> vertices;
+
+	// EBO of triangle vertex indices, ordered for vertex cache locality
+	ElementBuffer<MeshIndex> indices;
 
 	// VBO of instance data, uploaded every draw
 	VertexBuffer<Instance> instances;
 
+	// VBO of view space normal matrices of the instances, computed
+	// and uploaded every draw
+	VertexBuffer<mat3> normals;
+
+	// Storage of the normal matrices, reused between draws
+	vector<mat3> normalMatrices;
+
 	// Material data, can be modified
 	Material material;
 
@@ -139,27 +172,41 @@ struct ModelPhong {
 	// Cached drawcall data
 	Draw<Shaders::Phong> drawcall;
 
-	// Create the model from an array of vertices. Vertex normals can be left
-	// blank and automatically generated by setting generateNormals to true.
+	// Create the model from an array of vertices, each three of which form
+	// a triangle. Identical vertices are merged into one. Vertex normals can be
+	// left blank and automatically generated by setting generateNormals to true.
 	void create(char const* name, Shaders& shaders, span<Vertex const> vertices,
 		Material material, bool generateNormals = false);
 
+	// Create the model from a mesh file written by the Meshpack tool. If the file
+	// cannot be loaded, an error is logged and the model is created empty.
+	void load(char const* name, Shaders& shaders, char const* path,
+		Material material);
+
 	// Free up all resources used by the model.
 	void destroy();
 
-	// Draw the model with specified parameters and identity instance.
-	void draw(Framebuffer& fb, Scene const& scene, DrawParams const& params);
+	// Draw the model with specified parameters and identity instance. If fb
+	// is nullptr, the model is drawn into the backbuffer.
+	void draw(Framebuffer* fb, Scene const& scene, DrawParams const& params);
 
 	// Draw the model with specified parameters and custom instance data.
-	void draw(Framebuffer& fb, Scene const& scene, DrawParams const& params,
+	void draw(Framebuffer* fb, Scene const& scene, DrawParams const& params,
 		Instance const& instance);
 
 	// Draw multiple instances of the model with specified parameters
 	// and an array of instance data. Number of instances drawn is the size
 	// of the instance data array.
-	void draw(Framebuffer& fb, Scene const& scene, DrawParams const& params,
+	void draw(Framebuffer* fb, Scene const& scene, DrawParams const& params,
 		span<Instance const> instances);
 
+private:
+
+	// Create the GPU objects from processed mesh data.
+	void upload(char const* name, Shaders& shaders,
+		span<MeshpackVertex const> vertices, span<MeshIndex const> indices,
+		Material material);
+
 };
 
 }
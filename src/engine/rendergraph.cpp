@@ -0,0 +1,282 @@
+#include "engine/rendergraph.hpp"
+
+#include <type_traits>
+#include <algorithm>
+#include <numeric>
+#include "base/log.hpp"
+
+namespace minote {
+
+// Create a physical target of type T in place.
+template<typename T>
+static void createTarget(RenderGraph::Target& result, char const* const name, RenderTargetDesc const& desc)
+{
+	auto& target = result.emplace<T>();
+	ASSERT(target.Format == desc.format);
+	if constexpr (requires { target.samples; })
+		target.create(name, desc.size, desc.samples);
+	else
+		target.create(name, desc.size);
+}
+
+// Create a physical target of the type that matches the desc in place.
+// The result must not hold a live target.
+static void createTarget(RenderGraph::Target& result, char const* const name, RenderTargetDesc const& desc)
+{
+	ASSERT(desc.samples != Samples::None);
+	bool const ms = (desc.samples != Samples::_1);
+
+	switch (desc.format) {
+	case PixelFmt::DepthStencil:
+		if (ms)
+			createTarget<RenderbufferMS<PixelFmt::DepthStencil>>(result, name, desc);
+		else
+			createTarget<Renderbuffer<PixelFmt::DepthStencil>>(result, name, desc);
+		return;
+	case PixelFmt::RGBA_f16:
+		if (ms)
+			createTarget<TextureMS<PixelFmt::RGBA_f16>>(result, name, desc);
+		else
+			createTarget<Texture<PixelFmt::RGBA_f16>>(result, name, desc);
+		return;
+	case PixelFmt::RGB_f11f11f10:
+		ASSERT(!ms);
+		createTarget<Texture<PixelFmt::RGB_f11f11f10>>(result, name, desc);
+		return;
+	case PixelFmt::RGBA_u8:
+		ASSERT(!ms);
+		createTarget<Texture<PixelFmt::RGBA_u8>>(result, name, desc);
+		return;
+	case PixelFmt::RG_u8:
+		ASSERT(!ms);
+		createTarget<Texture<PixelFmt::RG_u8>>(result, name, desc);
+		return;
+	default:
+		throw logic_error{"Unsupported render target format"};
+	}
+}
+
+// Destroy all framebuffers of a graph.
+static void destroyFramebuffers(RenderGraph& rg)
+{
+	for (auto& fb: rg.framebuffers) {
+		if (fb.id)
+			fb.destroy();
+	}
+	rg.framebuffers.clear();
+	rg.attachments.clear();
+}
+
+void RenderGraph::clear()
+{
+	graph.clear();
+	funcs.clear();
+	sizes.clear();
+}
+
+auto RenderGraph::create(char const* const name, RenderTargetDesc const& desc) -> ResourceID
+{
+	ASSERT(desc.format != PixelFmt::None);
+	ASSERT(desc.size.x > 0 && desc.size.y > 0);
+
+	sizes.push_back(desc.size);
+	return graph.create(name, {
+		.format = desc.format,
+		.size = renderTargetBucket(desc.size),
+		.samples = desc.samples});
+}
+
+auto RenderGraph::backbuffer() -> ResourceID
+{
+	sizes.push_back({0, 0});
+	return graph.importResource("backbuffer");
+}
+
+auto RenderGraph::addPass(char const* const name, PassFunc func) -> PassID
+{
+	ASSERT(func);
+
+	funcs.emplace_back(move(func));
+	return graph.addPass(name);
+}
+
+void RenderGraph::execute()
+{
+	graph.compile();
+	auto const& physicals = graph.physicals;
+	bool poolChanged = false;
+
+	// Assign a pooled target to each physical resource, largest first so that
+	// small resources don't take up large targets. A target that fits
+	// is preferred; otherwise a compatible one is grown, and a new one
+	// is created only as a last resort
+	auto order = vector<u32>(physicals.size());
+	std::iota(order.begin(), order.end(), 0);
+	std::stable_sort(order.begin(), order.end(), [&](u32 const left, u32 const right) {
+		return u64(physicals[left].size.x) * physicals[left].size.y >
+			u64(physicals[right].size.x) * physicals[right].size.y;
+	});
+	auto taken = vector<bool>(pool.size(), false);
+	auto needed = vector<uvec2>(pool.size(), {0, 0});
+	mapping.assign(physicals.size(), Graph::None);
+	for (auto const i: order) {
+		auto const& desc = physicals[i];
+		auto const fits = [&](size_t const j) {
+			return pool[j]->desc.size.x >= desc.size.x && pool[j]->desc.size.y >= desc.size.y;
+		};
+		auto const area = [&](size_t const j) {
+			return u64(pool[j]->desc.size.x) * pool[j]->desc.size.y;
+		};
+
+		size_t best = pool.size();
+		for (size_t j = 0; j < pool.size(); j += 1) {
+			if (taken[j] || pool[j]->desc.format != desc.format ||
+				pool[j]->desc.samples != desc.samples) continue;
+			if (best == pool.size() || (fits(j) && !fits(best))) {
+				best = j;
+				continue;
+			}
+			if (fits(j) != fits(best)) continue;
+			if (fits(j)? area(j) < area(best) : area(j) > area(best))
+				best = j;
+		}
+
+		if (best == pool.size()) {
+			auto const user = std::find_if(graph.resources.begin(), graph.resources.end(),
+				[=](Graph::Resource const& r) { return r.physical == i; });
+			auto& pooled = *pool.emplace_back(std::make_unique<PooledTarget>());
+			createTarget(pooled.target, user->name, desc);
+			pooled.desc = desc;
+			pooled.oversized = 0;
+			taken.push_back(false);
+			needed.emplace_back(0, 0);
+			poolChanged = true;
+		} else if (!fits(best)) {
+			auto const size = max(pool[best]->desc.size, desc.size);
+			std::visit([=](auto& target) { target.resize(size); }, pool[best]->target);
+			pool[best]->desc.size = size;
+		}
+		taken[best] = true;
+		needed[best] = desc.size;
+		mapping[i] = best;
+	}
+
+	// Shrink targets that have been larger than needed for long enough,
+	// and free the ones that have been unused
+	for (size_t j = pool.size() - 1; j < pool.size(); j -= 1) {
+		auto& pooled = *pool[j];
+		if (taken[j] && pooled.desc.size == needed[j]) {
+			pooled.oversized = 0;
+			continue;
+		}
+		pooled.oversized += 1;
+		if (pooled.oversized < RenderTargetShrinkDelay) continue;
+
+		if (taken[j]) {
+			std::visit([&](auto& target) { target.resize(needed[j]); }, pooled.target);
+			pooled.desc.size = needed[j];
+			pooled.oversized = 0;
+		} else {
+			std::visit([](auto& target) { target.destroy(); }, pooled.target);
+			pool.erase(pool.begin() + j);
+			for (auto& m: mapping) {
+				if (m > j)
+					m -= 1;
+			}
+			poolChanged = true;
+		}
+	}
+
+	// Find the targets each pass draws into
+	auto passAttachments = vector<svector<u32, Graph::MaxPassResources>>(graph.passes.size());
+	for (size_t i = 0; i < graph.passes.size(); i += 1) {
+		auto const& pass = graph.passes[i];
+		if (!pass.alive) continue;
+		for (auto const r: pass.writes) {
+			auto const& resource = graph.resources[r];
+			if (resource.imported) {
+				ASSERT(pass.writes.size() == 1);
+				continue;
+			}
+			passAttachments[i].push_back(mapping[resource.physical]);
+		}
+	}
+
+	// Recreate framebuffers if their attachments changed. Targets that were
+	// only resized are still attached
+	if (poolChanged || passAttachments != attachments) {
+		destroyFramebuffers(*this);
+
+		framebuffers.resize(graph.passes.size());
+		for (size_t i = 0; i < graph.passes.size(); i += 1) {
+			if (passAttachments[i].empty()) continue;
+			auto& fb = framebuffers[i];
+			fb.create(graph.passes[i].name);
+			size_t colors = 0;
+			for (auto const j: passAttachments[i]) {
+				std::visit([&](auto& target) {
+					if constexpr (std::remove_reference_t<decltype(target)>::Format == PixelFmt::DepthStencil) {
+						fb.attach(target, Attachment::DepthStencil);
+					} else {
+						fb.attach(target, Attachment(+Attachment::Color0 + colors));
+						colors += 1;
+					}
+				}, pool[j]->target);
+			}
+		}
+		attachments = move(passAttachments);
+
+		auto const used = std::count_if(graph.resources.begin(), graph.resources.end(),
+			[](Graph::Resource const& r) { return !r.imported && r.physical != Graph::None; });
+		L.debug("Render graph compiled: {} of {} passes, {} targets for {} resources, {} pooled"_fmt,
+			graph.alivePasses(), graph.passes.size(), physicals.size(), used, pool.size());
+	}
+
+	// Render into the requested size of each pass's targets
+	for (size_t i = 0; i < graph.passes.size(); i += 1) {
+		auto& fb = framebuffers[i];
+		if (!fb.id) continue;
+		auto const& writes = graph.passes[i].writes;
+		fb.area = sizes[writes[0]];
+		for (auto const r: writes)
+			ASSERT(sizes[r] == fb.area);
+	}
+
+	for (size_t i = 0; i < graph.passes.size(); i += 1) {
+		if (!graph.passes[i].alive) continue;
+		L.trace(R"(Render graph pass "{}" executed)"_fmt, graph.passes[i].name);
+		auto const section = timers? timers->begin(graph.passes[i].name) : GpuTimers::None;
+		funcs[i](framebuffers[i].id? &framebuffers[i] : nullptr);
+		if (timers)
+			timers->end(section);
+	}
+}
+
+void RenderGraph::destroy()
+{
+	destroyFramebuffers(*this);
+	for (auto& pooled: pool)
+		std::visit([](auto& target) { target.destroy(); }, pooled->target);
+	pool.clear();
+	mapping.clear();
+	clear();
+}
+
+auto RenderGraph::textureScale(ResourceID const resource) -> vec2
+{
+	ASSERT(resource < graph.resources.size());
+	auto const physical = graph.resources[resource].physical;
+	ASSERT(physical < mapping.size());
+
+	return vec2(sizes[resource]) / vec2(pool[mapping[physical]]->desc.size);
+}
+
+auto RenderGraph::framebuffer(PassID const pass) -> Framebuffer&
+{
+	ASSERT(pass < framebuffers.size());
+	ASSERT(framebuffers[pass].id);
+
+	return framebuffers[pass];
+}
+
+}
@@ -0,0 +1,174 @@
+// Minote - engine/rendergraph.hpp
+// Executor of a FrameGraph with OpenGL render targets. Transient targets are
+// shared between resources with disjoint lifetimes, and come from a pool
+// that persists between frames. Pooled targets are allocated in size buckets
+// and can be larger than the image, which is then rendered into the bottom
+// left corner
+
+#pragma once
+
+#include <functional>
+#include <algorithm>
+#include <variant>
+#include <memory>
+#include <bit>
+#include "base/array.hpp"
+#include "base/math.hpp"
+#include "base/util.hpp"
+#include "sys/opengl/framebuffer.hpp"
+#include "sys/opengl/texture.hpp"
+#include "engine/framegraph.hpp"
+#include "engine/gputimers.hpp"
+
+namespace minote {
+
+// Properties of a render target. Color targets are textures that can be
+// sampled, depth-stencil targets are renderbuffers
+struct RenderTargetDesc {
+
+	PixelFmt format = PixelFmt::None;
+	uvec2 size = {0, 0};
+	Samples samples = Samples::_1;
+
+	auto operator==(RenderTargetDesc const&) const -> bool = default;
+
+};
+
+// Number of frames that a pooled target has to be larger than needed
+// (or unused) for before it is shrunk (or freed)
+constexpr u32 RenderTargetShrinkDelay = 120;
+
+// Round a render target size up to its allocation bucket. Buckets are 1/8
+// of the next power of two wide, with a minimum of 16 pixels, so that
+// a window being resized reallocates rarely, and under 25% of each dimension
+// is wasted.
+constexpr auto renderTargetBucket(uvec2 const size) -> uvec2
+{
+	auto const round = [](u32 const value) -> u32 {
+		u32 const step = std::max(std::bit_ceil(value) / 8, 16u);
+		return (value + step - 1) / step * step;
+	};
+	return {round(size.x), round(size.y)};
+}
+
+struct RenderGraph {
+
+	using Graph = FrameGraph<RenderTargetDesc>;
+	using ResourceID = Graph::ResourceID;
+	using PassID = Graph::PassID;
+
+	// Function executing a pass. The framebuffer has all of the pass's writes
+	// attached, colors in order of declaration. It is nullptr if the pass
+	// writes to the backbuffer
+	using PassFunc = std::function<void(Framebuffer*)>;
+
+	// A physical render target
+	using Target = std::variant<
+		Texture<PixelFmt::RGBA_f16>,
+		Texture<PixelFmt::RGB_f11f11f10>,
+		Texture<PixelFmt::RGBA_u8>,
+		Texture<PixelFmt::RG_u8>,
+		TextureMS<PixelFmt::RGBA_f16>,
+		Renderbuffer<PixelFmt::DepthStencil>,
+		RenderbufferMS<PixelFmt::DepthStencil>>;
+
+	// A render target of the pool
+	struct PooledTarget {
+
+		Target target;
+
+		// Properties of the target's storage
+		RenderTargetDesc desc;
+
+		// Number of consecutive frames the target was larger than needed,
+		// or unused
+		u32 oversized;
+
+	};
+
+	// Passes and resources of the frame being recorded. Resource descs
+	// are rounded up to their size bucket
+	Graph graph;
+
+	// Functions of the recorded passes, indexed by PassID
+	vector<PassFunc> funcs;
+
+	// Requested sizes of the recorded resources, indexed by ResourceID
+	vector<uvec2> sizes;
+
+	// Render targets that persist between frames. Held by pointer, because GL
+	// objects must not be relocated while they are alive
+	vector<std::unique_ptr<PooledTarget>> pool;
+
+	// Pool index of each physical resource, indexed by
+	// Graph::Resource::physical. Valid during execute()
+	vector<u32> mapping;
+
+	// Framebuffer of each pass, indexed by PassID. Empty for culled passes
+	// and passes writing to the backbuffer
+	vector<Framebuffer> framebuffers;
+
+	// Pool indices attached to each of the framebuffers
+	vector<svector<u32, Graph::MaxPassResources>> attachments;
+
+	// If set, each executed pass is timed as a section named after the pass
+	GpuTimers* timers = nullptr;
+
+	// Remove all passes and resources, to start recording a new frame.
+	// Render targets are kept in the pool.
+	void clear();
+
+	// Declare a transient render target.
+	auto create(char const* name, RenderTargetDesc const& desc) -> ResourceID;
+
+	// Declare the backbuffer. A pass writing to it can't write to any other
+	// target.
+	auto backbuffer() -> ResourceID;
+
+	// Record a pass. func is called from execute(), if the pass isn't culled.
+	auto addPass(char const* name, PassFunc func) -> PassID;
+
+	// Declare that a pass samples from or blends into a target.
+	void read(PassID pass, ResourceID resource) { graph.read(pass, resource); }
+
+	// Declare that a pass draws into a target.
+	void write(PassID pass, ResourceID resource) { graph.write(pass, resource); }
+
+	// Compile the graph, assign pooled render targets to its resources,
+	// and run the functions of all non-culled passes in order. Each pass's
+	// framebuffer has its render area set to the size of its writes.
+	void execute();
+
+	// Free all render targets of the pool.
+	void destroy();
+
+	// Retrieve the texture of a color target for sampling. Only valid during
+	// execute().
+	template<PixelFmt F>
+	auto texture(ResourceID resource) -> Texture<F>& { return target<Texture<F>>(resource); }
+
+	// Retrieve the texture of a multisampled color target for sampling. Only
+	// valid during execute().
+	template<PixelFmt F>
+	auto textureMS(ResourceID resource) -> TextureMS<F>& { return target<TextureMS<F>>(resource); }
+
+	// Retrieve the portion of a target's texture that is covered by
+	// the image, for scaling texture coordinates. Only valid during execute().
+	[[nodiscard]]
+	auto textureScale(ResourceID resource) -> vec2;
+
+	// Retrieve the framebuffer of a non-culled pass. Only valid during
+	// execute(), and only for passes that don't write to the backbuffer.
+	auto framebuffer(PassID pass) -> Framebuffer&;
+
+private:
+
+	// Retrieve the physical target of a resource, which must be of type T.
+	template<typename T>
+	auto target(ResourceID resource) -> T&;
+
+};
+
+}
+
+#include "engine/rendergraph.tpp"
@@ -0,0 +1,17 @@
+#pragma once
+
+namespace minote {
+
+template<typename T>
+auto RenderGraph::target(ResourceID const resource) -> T&
+{
+	ASSERT(resource < graph.resources.size());
+	auto const physical = graph.resources[resource].physical;
+	ASSERT(physical < mapping.size());
+	auto& result = pool[mapping[physical]]->target;
+	ASSERT(std::holds_alternative<T>(result));
+
+	return std::get<T>(result);
+}
+
+}
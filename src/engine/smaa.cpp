@@ -0,0 +1,239 @@
+#include "engine/smaa.hpp"
+
+#include <algorithm>
+#include "smaa/AreaTex.h"
+#include "smaa/SearchTex.h"
+#include "base/array.hpp"
+#include "base/log.hpp"
+
+namespace minote {
+
+// SMAA render target metrics of a texture
+static auto metrics(uvec2 const size) -> vec4
+{
+	return {1.0f / f32(size.x), 1.0f / f32(size.y), f32(size.x), f32(size.y)};
+}
+
+// Copy a lookup table with its rows in reverse order. The tables are stored
+// top to bottom, while OpenGL expects them bottom to top.
+static auto flipRows(span<u8 const> const data, size_t const pitch) -> vector<u8>
+{
+	auto result = vector<u8>(data.size());
+	size_t const rows = data.size() / pitch;
+	for (size_t i = 0; i < rows; i += 1)
+		std::copy_n(data.begin() + (rows - 1 - i) * pitch, pitch, result.begin() + i * pitch);
+	return result;
+}
+
+void Smaa::create(Shaders& shaders)
+{
+	ASSERT(!area.id);
+
+	area.create("Smaa::area", {AREATEX_WIDTH, AREATEX_HEIGHT});
+	area.upload(span<u8 const>(flipRows(areaTexBytes, AREATEX_PITCH)), 2);
+	search.create("Smaa::search", {SEARCHTEX_WIDTH, SEARCHTEX_HEIGHT});
+	search.setFilter(Filter::Nearest);
+	search.upload(span<u8 const>(flipRows(searchTexBytes, SEARCHTEX_PITCH)));
+
+	separate = {
+		.shader = &shaders.smaaSeparate,
+		.triangles = 1,
+		.params = {
+			.culling = false,
+			.depthTesting = false
+		}
+	};
+	// Mark the pixels with edges in the stencil buffer. Pooled targets can be
+	// larger than the image, and the blend pass searches along edges past it,
+	// so the edges and weights are cleared everywhere
+	edge = {
+		.shader = &shaders.smaaEdge,
+		.triangles = 1,
+		.params = {
+			.culling = false,
+			.depthTesting = false,
+			.stencilTesting = true,
+			.stencilMode = {
+				.func = Comparison::Always,
+				.ref = 1,
+				.dppass = StencilOp::Set
+			}
+		},
+		.clearColor = true,
+		.clearDepthStencil = true,
+		.clearParams = {
+			.color = {0.0f, 0.0f, 0.0f, 0.0f},
+			.wholeTarget = true
+		}
+	};
+	// Calculate weights only for the marked pixels
+	blend = {
+		.shader = &shaders.smaaBlend,
+		.triangles = 1,
+		.params = {
+			.culling = false,
+			.depthTesting = false,
+			.stencilTesting = true,
+			.stencilMode = {
+				.func = Comparison::Equal,
+				.ref = 1
+			}
+		},
+		.clearColor = true,
+		.clearParams = {
+			.color = {0.0f, 0.0f, 0.0f, 0.0f},
+			.wholeTarget = true
+		}
+	};
+	neighbor = {
+		.shader = &shaders.smaaNeighbor,
+		.triangles = 1,
+		.params = {
+			.culling = false,
+			.depthTesting = false
+		}
+	};
+
+	L.debug("SMAA lookup tables uploaded");
+}
+
+void Smaa::destroy()
+{
+	ASSERT(area.id);
+
+	area.destroy();
+	search.destroy();
+	samplesChecked = false;
+
+	L.debug("SMAA lookup tables freed");
+}
+
+auto Smaa::apply(RenderGraph& graph, ResourceID const image, uvec2 const size) -> ResourceID
+{
+	ASSERT(area.id);
+
+	auto const output = graph.create("Smaa::output", {
+		.format = PixelFmt::RGBA_f16,
+		.size = size});
+	auto const w = weights(graph, image, size, {0.0f, 0.0f, 0.0f, 0.0f});
+	resolve(graph, image, w, output, 1.0f);
+	return output;
+}
+
+auto Smaa::applyS2x(RenderGraph& graph, ResourceID const image, uvec2 const size) -> ResourceID
+{
+	ASSERT(area.id);
+
+	// Split the samples into two images
+	auto const sample0 = graph.create("Smaa::sample0", {
+		.format = PixelFmt::RGBA_f16,
+		.size = size});
+	auto const sample1 = graph.create("Smaa::sample1", {
+		.format = PixelFmt::RGBA_f16,
+		.size = size});
+	auto const pass = graph.addPass("Smaa::separate", [this, &graph, image](Framebuffer* const fb) {
+		separate.framebuffer = fb;
+		separate.shader->image = graph.textureMS<PixelFmt::RGBA_f16>(image);
+		separate.draw();
+	});
+	graph.read(pass, image);
+	graph.write(pass, sample0);
+	graph.write(pass, sample1);
+
+	// Filter each sample with its own subpixel offsets, and average them
+	auto const output = graph.create("Smaa::output", {
+		.format = PixelFmt::RGBA_f16,
+		.size = size});
+	auto const weights0 = weights(graph, sample0, size, {1.0f, 2.0f, 2.0f, 0.0f});
+	auto const weights1 = weights(graph, sample1, size, {2.0f, 1.0f, 1.0f, 0.0f});
+	resolve(graph, sample0, weights0, output, 1.0f);
+	resolve(graph, sample1, weights1, output, 0.5f);
+	return output;
+}
+
+void Smaa::checkSamples(Framebuffer& fb)
+{
+	if (samplesChecked) return;
+	samplesChecked = true;
+
+	fb.bind();
+	array<GLfloat, 4> positions = {};
+	glGetMultisamplefv(GL_SAMPLE_POSITION, 0, &positions[0]);
+	glGetMultisamplefv(GL_SAMPLE_POSITION, 1, &positions[2]);
+	if (positions[0] == 0.75f && positions[1] == 0.75f &&
+		positions[2] == 0.25f && positions[3] == 0.25f) return;
+
+	L.warn("MSAA 2x sample positions are not as expected, SMAA S2x will look wrong:");
+	L.warn("    Sample #0: ({}, {}), expected (0.75, 0.75)", positions[0], positions[1]);
+	L.warn("    Sample #1: ({}, {}), expected (0.25, 0.25)", positions[2], positions[3]);
+}
+
+auto Smaa::weights(RenderGraph& graph, ResourceID const image, uvec2 const size,
+	vec4 const subsampleIndices) -> ResourceID
+{
+	auto const edges = graph.create("Smaa::edges", {
+		.format = PixelFmt::RG_u8,
+		.size = size});
+	auto const stencil = graph.create("Smaa::stencil", {
+		.format = PixelFmt::DepthStencil,
+		.size = size});
+	auto const result = graph.create("Smaa::weights", {
+		.format = PixelFmt::RGBA_u8,
+		.size = size});
+
+	auto const edgePass = graph.addPass("Smaa::edge", [this, &graph, image](Framebuffer* const fb) {
+		auto& source = graph.texture<PixelFmt::RGBA_f16>(image);
+		source.setFilter(Filter::Nearest);
+		edge.framebuffer = fb;
+		edge.shader->image = source;
+		edge.shader->screenSize = metrics(source.size);
+		edge.shader->imageScale = graph.textureScale(image);
+		edge.draw();
+		source.setFilter(Filter::Linear);
+	});
+	graph.read(edgePass, image);
+	graph.write(edgePass, edges);
+	graph.write(edgePass, stencil);
+
+	auto const blendPass = graph.addPass("Smaa::blend", [this, &graph, edges, subsampleIndices](Framebuffer* const fb) {
+		auto& source = graph.texture<PixelFmt::RG_u8>(edges);
+		blend.framebuffer = fb;
+		blend.shader->edges = source;
+		blend.shader->area = area;
+		blend.shader->search = search;
+		blend.shader->subsampleIndices = subsampleIndices;
+		blend.shader->screenSize = metrics(source.size);
+		blend.shader->imageScale = graph.textureScale(edges);
+		blend.draw();
+	});
+	graph.read(blendPass, edges);
+	graph.read(blendPass, stencil);
+	graph.write(blendPass, result);
+	graph.write(blendPass, stencil);
+
+	return result;
+}
+
+void Smaa::resolve(RenderGraph& graph, ResourceID const image, ResourceID const weights,
+	ResourceID const output, f32 const alpha)
+{
+	bool const accumulate = (alpha < 1.0f);
+	auto const pass = graph.addPass("Smaa::neighbor", [this, &graph, image, weights, alpha, accumulate](Framebuffer* const fb) {
+		auto& source = graph.texture<PixelFmt::RGBA_f16>(image);
+		neighbor.framebuffer = fb;
+		neighbor.params.blending = accumulate;
+		neighbor.shader->image = source;
+		neighbor.shader->blend = graph.texture<PixelFmt::RGBA_u8>(weights);
+		neighbor.shader->alpha = alpha;
+		neighbor.shader->screenSize = metrics(source.size);
+		neighbor.shader->imageScale = graph.textureScale(image);
+		neighbor.draw();
+	});
+	graph.read(pass, image);
+	graph.read(pass, weights);
+	if (accumulate)
+		graph.read(pass, output);
+	graph.write(pass, output);
+}
+
+}
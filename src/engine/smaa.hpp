@@ -0,0 +1,68 @@
+// Minote - engine/smaa.hpp
+// Enhanced subpixel morphological antialiasing, recorded as passes of
+// a render graph. SMAA 1x filters a singlesampled image; SMAA S2x filters
+// both samples of a 2x multisampled image separately and averages them
+
+#pragma once
+
+#include "sys/opengl/framebuffer.hpp"
+#include "sys/opengl/texture.hpp"
+#include "sys/opengl/draw.hpp"
+#include "engine/rendergraph.hpp"
+#include "store/shaders.hpp"
+
+namespace minote {
+
+struct Smaa {
+
+	using ResourceID = RenderGraph::ResourceID;
+
+	// Precomputed lookup table of coverage areas
+	Texture<PixelFmt::RG_u8> area;
+
+	// Precomputed lookup table for searching edge ends
+	Texture<PixelFmt::R_u8> search;
+
+	// Drawcalls of the individual stages
+	Draw<Shaders::SmaaSeparate> separate;
+	Draw<Shaders::SmaaEdge> edge;
+	Draw<Shaders::SmaaBlend> blend;
+	Draw<Shaders::SmaaNeighbor> neighbor;
+
+	// Whether the multisample layout was already verified for S2x
+	bool samplesChecked = false;
+
+	// Upload the lookup tables and prepare the drawcalls.
+	void create(Shaders& shaders);
+
+	// Free the lookup tables.
+	void destroy();
+
+	// Record the passes of SMAA 1x. image must be an RGBA_f16 target
+	// of the specified size. Returns a new target with the antialiased image.
+	auto apply(RenderGraph& graph, ResourceID image, uvec2 size) -> ResourceID;
+
+	// Record the passes of SMAA S2x. image must be an RGBA_f16 target
+	// of the specified size with 2 samples. Returns a new singlesampled target
+	// with the antialiased image.
+	auto applyS2x(RenderGraph& graph, ResourceID image, uvec2 size) -> ResourceID;
+
+	// Warn if the sample positions of a 2x multisampled framebuffer are not
+	// the ones S2x expects. Only checks once.
+	void checkSamples(Framebuffer& fb);
+
+private:
+
+	// Record the edge detection and blending weight passes for an image.
+	// Returns the blending weights target.
+	auto weights(RenderGraph& graph, ResourceID image, uvec2 size,
+		vec4 subsampleIndices) -> ResourceID;
+
+	// Record a neighborhood blending pass, drawing the image with
+	// the specified opacity into output.
+	void resolve(RenderGraph& graph, ResourceID image, ResourceID weights,
+		ResourceID output, f32 alpha);
+
+};
+
+}
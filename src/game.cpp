@@ -1,20 +1,140 @@
 #include "game.hpp"
 
+#include <algorithm>
+#include <chrono>
 #include <GLFW/glfw3.h>
+#include "lodepng.h"
+#include "sys/opengl/state.hpp"
 #include "engine/engine.hpp"
 #include "engine/mapper.hpp"
 #include "engine/model.hpp"
+#include "engine/framestats.hpp"
 #include "engine/frame.hpp"
 #include "store/shaders.hpp"
+#include "base/profile.hpp"
 #include "particles.hpp"
 #include "bloom.hpp"
 #include "debug.hpp"
 #include "play.hpp"
 #include "store/fonts.hpp"
+#include "base/array.hpp"
+#include "base/io.hpp"
 #include "text.hpp"
+#include "mrs.hpp"
 
 namespace minote {
 
+// Output of the frame timing report, written on exit
+constexpr auto FrameStatsPath = "minote-framestats.txt";
+
+// Seed of the game's randomness in benchmark mode
+constexpr uint64_t BenchSeed = 1;
+
+// Inputs of benchmark mode. Every BenchInputInterval frames the previous
+// input is released, and the next one is pressed
+constexpr auto BenchScript = array{
+	Action::Type::Left, Action::Type::RotCW, Action::Type::Right,
+	Action::Type::Right, Action::Type::RotCCW, Action::Type::Drop,
+	Action::Type::Left, Action::Type::Lock};
+constexpr u32 BenchInputInterval = 8;
+
+// Stages of a frame timed in benchmark mode, in pipeline order
+constexpr auto BenchStages = array{"update", "record", "frame.end", "present"};
+
+// Timing collected over a benchmark run
+struct BenchTimings {
+
+	// Total time of a GPU timer section
+	struct Section {
+
+		char const* name;
+		u32 depth;
+		f64 ms;
+		u32 samples;
+
+	};
+
+	using Clock = std::chrono::steady_clock;
+
+	// Number of frames measured
+	u32 frames = 0;
+
+	// Total time of each of BenchStages, and of all of them
+	array<nsec, BenchStages.size()> stages = {};
+	nsec total = 0_s;
+
+	// GPU timer sections, in order of first appearance
+	vector<Section> sections;
+
+	// Start timing a new frame, or restart the current stage.
+	void begin() { lapStart = Clock::now(); }
+
+	// Finish a stage, and start the next one.
+	void lap(size_t const stage) {
+		auto const now = Clock::now();
+		stages[stage] += now - lapStart;
+		total += now - lapStart;
+		lapStart = now;
+	}
+
+	// Add the latest GPU timer results.
+	void addSections(vector<GpuTimers::Result> const& results) {
+		for (auto const& result: results) {
+			auto it = std::find_if(sections.begin(), sections.end(), [&](auto const& s) {
+				return string_view(s.name) == result.name && s.depth == result.depth;
+			});
+			if (it == sections.end())
+				it = sections.insert(sections.end(), Section{result.name, result.depth, 0.0, 0});
+			it->ms += result.ms;
+			it->samples += 1;
+		}
+	}
+
+	// Print the averages to stdout.
+	void report() const {
+		auto const toMs = [](nsec const duration) { return f64(duration.count()) / 1'000'000.0; };
+		print(cout, "Benchmark: {} frames in {:.3f} s, {:.1f} FPS\n", frames,
+			toMs(total) / 1000.0, frames? f64(frames) * 1000.0 / toMs(total) : 0.0);
+		if (!frames) return;
+
+		print(cout, "\n{:<24}{:>10}\n", "CPU stage", "ms/frame");
+		for (size_t i = 0; i < BenchStages.size(); i += 1)
+			print(cout, "{:<24}{:>10.3f}\n", BenchStages[i], toMs(stages[i]) / f64(frames));
+
+		if (sections.empty()) return;
+		print(cout, "\n{:<24}{:>10}\n", "GPU section", "ms/frame");
+		for (auto const& [name, depth, ms, samples]: sections)
+			print(cout, "{:<24}{:>10.3f}\n", format("{:{}}{}", "", depth * 2, name), ms / f64(samples));
+	}
+
+private:
+
+	Clock::time_point lapStart;
+
+};
+
+// Save the contents of the window's backbuffer as a PNG image. Throws
+// runtime_error on failure.
+static void saveFrame(uvec2 const size, string const& path)
+{
+	auto pixels = vector<u8>(size.x * size.y * 4);
+	detail::state.bindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+	glReadBuffer(GL_BACK);
+	glReadPixels(0, 0, size.x, size.y, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+
+	// OpenGL rows go bottom to top. The backbuffer has no alpha channel
+	auto image = vector<u8>(pixels.size());
+	size_t const stride = size.x * 4;
+	for (size_t y = 0; y < size.y; y += 1)
+		std::copy_n(&pixels[(size.y - 1 - y) * stride], stride, &image[y * stride]);
+	for (size_t i = 3; i < image.size(); i += 4)
+		image[i] = 0xFF;
+
+	if (auto const error = lodepng::encode(path, image, size.x, size.y))
+		throw runtime_error{format(R"(Failed to write frame to "{}": {})", path, lodepng_error_text(error))};
+	L.info(R"(Frame written to "{}")", path);
+}
+
 #ifndef NDEBUG
 // Error callback forwarding OpenGL debug context errors to the logging system.
 // See: https://www.khronos.org/opengl/wiki/Debug_Output#Message_Components
@@ -80,39 +200,51 @@ static void APIENTRY debugMessageCallback(GLenum const source,
 		}
 	}();
 
-	L.log(logLevel, "[OpenGL][{}] {}: {}", sourceStr, typeStr, message);
+	L.log(logLevel, "[OpenGL][{}] {}: {}"_fmt, sourceStr, typeStr, message);
 }
 #endif //NDEBUG
 
 // Temporary replacement for a settings menu.
 static void gameDebug(Frame& frame, bool& sync)
 {
-	if (nk_begin(nkCtx(), "Settings", nk_rect(1070, 30, 180, 220),
+	if (nk_begin(nkCtx(), "Settings", nk_rect(1070, 30, 180, 370),
 		NK_WINDOW_BORDER | NK_WINDOW_MOVABLE | NK_WINDOW_MINIMIZABLE
 			| NK_WINDOW_NO_SCROLLBAR)) {
 		nk_layout_row_dynamic(nkCtx(), 20, 1);
 		sync = nk_check_label(nkCtx(), "GPU synchronization", sync);
 		nk_label(nkCtx(), "Antialiasing:", NK_TEXT_LEFT);
-		if (nk_option_label(nkCtx(), "None", frame.aa == Samples::_1))
-			frame.changeAA(Samples::_1);
-		if (nk_option_label(nkCtx(), "MSAA 2x", frame.aa == Samples::_2))
-			frame.changeAA(Samples::_2);
-		if (nk_option_label(nkCtx(), "MSAA 4x", frame.aa == Samples::_4))
-			frame.changeAA(Samples::_4);
-		if (nk_option_label(nkCtx(), "MSAA 8x", frame.aa == Samples::_8))
-			frame.changeAA(Samples::_8);
+		if (nk_option_label(nkCtx(), "None", frame.aa == AAMode::None))
+			frame.changeAA(AAMode::None);
+		if (nk_option_label(nkCtx(), "MSAA 2x", frame.aa == AAMode::MSAA2x))
+			frame.changeAA(AAMode::MSAA2x);
+		if (nk_option_label(nkCtx(), "MSAA 4x", frame.aa == AAMode::MSAA4x))
+			frame.changeAA(AAMode::MSAA4x);
+		if (nk_option_label(nkCtx(), "MSAA 8x", frame.aa == AAMode::MSAA8x))
+			frame.changeAA(AAMode::MSAA8x);
+		if (nk_option_label(nkCtx(), "SMAA 1x", frame.aa == AAMode::SMAA))
+			frame.changeAA(AAMode::SMAA);
+		if (nk_option_label(nkCtx(), "SMAA S2x", frame.aa == AAMode::SMAAS2x))
+			frame.changeAA(AAMode::SMAAS2x);
+		nk_label(nkCtx(), "Bloom:", NK_TEXT_LEFT);
+		if (nk_option_label(nkCtx(), "Off", bloomGetQuality() == BloomQuality::Off))
+			bloomSetQuality(BloomQuality::Off);
+		if (nk_option_label(nkCtx(), "Low", bloomGetQuality() == BloomQuality::Low))
+			bloomSetQuality(BloomQuality::Low);
+		if (nk_option_label(nkCtx(), "High", bloomGetQuality() == BloomQuality::High))
+			bloomSetQuality(BloomQuality::High);
 	}
 	nk_end(nkCtx());
 }
 
-void game(Window& window) try {
+void game(Window& window, optional<BenchOptions> const& bench) try {
 	// *** OpenGL setup ***
 
+	profileNameThread("game");
 	window.activateContext();
 	defer { window.deactivateContext(); };
 	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
 		throw runtime_error{"Failed to initialize OpenGL"};
-	glfwSwapInterval(1); // Enable vsync
+	glfwSwapInterval(bench? 0 : 1); // Enable vsync, unless benchmarking
 #ifndef NDEBUG // Enable debug context features
 	glEnable(GL_DEBUG_OUTPUT);
 	glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS); // Our log handling is fast
@@ -123,20 +255,25 @@ void game(Window& window) try {
 
 	Mapper mapper;
 	Shaders shaders;
+#ifdef MINOTE_SHADER_RELOAD
+	shaders.watch(window);
+#endif //MINOTE_SHADER_RELOAD
 
 	Frame frame;
-	frame.create(window.size(), shaders);
+	frame.create(shaders);
 	defer { frame.destroy(); };
 
 	Scene scene;
 	Models models{shaders};
 	Fonts fonts;
+	JobSystem jobs;
 
 	Engine engine = {
 		.window = window,
 		.mapper = mapper,
 		.frame = frame,
 		.scene = scene,
+		.jobs = jobs,
 		.shaders = shaders,
 		.models = models,
 		.fonts = fonts
@@ -144,15 +281,16 @@ void game(Window& window) try {
 
 	textInit();
 	defer { textCleanup(); };
-	bloomInit(window);
-	defer { bloomCleanup(); };
 #ifdef MINOTE_DEBUG
 	debugInit();
 	defer { debugCleanup(); };
 #endif //MINOTE_DEBUG
-	playInit();
+	if (bench)
+		Glfw::setTime(0_s); // Start of the simulated clock
+	playInit(bench? BenchSeed : 0);
 	defer { playCleanup(); };
-	particlesInit();
+	particlesInit(bench? BenchSeed : 0);
+	defer { particlesCleanup(); };
 
 	Draw<> clear = {
 		.clearColor = true,
@@ -163,6 +301,14 @@ void game(Window& window) try {
 	};
 	engine.scene.background = engine.scene.ambientLight = {0.0185f, 0.029f, 0.0944f};
 
+	FrameStats frameStats;
+	BenchTimings benchTimings;
+	u32 benchFrame = 0;
+	if (bench) {
+		frame.timers.enabled = true;
+		L.info("Benchmarking {} frames", bench->frames);
+	}
+
 	bool hardSync = true;
 	DrawParams syncParams = {
 		.culling = false,
@@ -172,36 +318,114 @@ void game(Window& window) try {
 	// *** Main loop ***
 
 	while (!window.isClosing()) {
+		PROFILE_ZONE("frame");
+		auto const frameStart = Glfw::getTime();
+		benchTimings.begin();
+
 		// Update state
-		mapper.mapKeyInputs(window);
+		if (!bench) {
+			mapper.mapKeyInputs(window);
+		} else {
+			// Advance the clock by exactly one tick, and press the scripted inputs
+			auto const now = MrsUpdateTick * (benchFrame + 1);
+			Glfw::setTime(now);
+			if (benchFrame && benchFrame % BenchInputInterval == 0) {
+				auto const step = benchFrame / BenchInputInterval;
+				mapper.actions.push_back({BenchScript[(step - 1) % BenchScript.size()],
+					Action::State::Released, now});
+				mapper.actions.push_back({BenchScript[step % BenchScript.size()],
+					Action::State::Pressed, now});
+			}
+		}
 #ifdef MINOTE_DEBUG
 		debugUpdate();
 		gameDebug(frame, hardSync);
+		if (!bench) { // Live timings would make benchmark frames differ
+			debugFrameStats(frameStats);
+			debugProfiler();
+			debugGpuTimers(frame.timers);
+		}
 #endif //MINOTE_DEBUG
-		playUpdate(window, mapper);
-		particlesUpdate();
+		u32 ticks = 0;
+		{
+			PROFILE_ZONE("playUpdate");
+			ticks = playUpdate(window, mapper);
+		}
+		{
+			PROFILE_ZONE("particlesUpdate");
+			particlesUpdate();
+		}
+		benchTimings.lap(0);
 
 		// Draw frame
+		shaders.update();
 		frame.begin(window.size());
 		scene.updateMatrices(frame.size);
-		clear.framebuffer = frame.fb;
-		clear.draw();
-		playDraw(engine);
-		particlesDraw(engine);
+		frame.draw("scene", [&] {
+			clear.framebuffer = frame.fb;
+			clear.draw();
+			playDraw(engine);
+			particlesDraw(engine);
+		});
 		frame.resolveAA();
+		fonts.update();
 		textQueue(fonts["jost"_id], 3.0f, {6.05, 1.95, 0}, {1.0f, 1.0f, 1.0f, 0.25f}, "Text test.");
 		textQueue(fonts["jost"_id], 3.0f, {6, 2, 0}, {0.0f, 0.0f, 0.0f, 1.0f}, "Text test");
-		textDraw(engine);
-		bloomApply(engine);
+		frame.draw("text", [&] {
+			PROFILE_ZONE("textDraw");
+			textDraw(engine);
+		});
+		{
+			PROFILE_ZONE("bloomApply");
+			bloomApply(engine);
+		}
 #ifdef MINOTE_DEBUG
-		debugDraw(engine);
+		frame.draw("debug", [&] { debugDraw(engine); });
 #endif //MINOTE_DEBUG
-		frame.end();
-		window.flip();
-		if (hardSync) {
+		benchTimings.lap(1);
+		{
+			PROFILE_ZONE("frame.end");
+			frame.end();
+		}
+		benchTimings.lap(2);
+		if (bench && !bench->dumpPath.empty() && benchFrame == bench->dumpFrame) {
+			saveFrame(frame.size, bench->dumpPath);
+			benchTimings.begin(); // Don't count the readback
+		}
+		auto const cpuTime = Glfw::getTime() - frameStart;
+		{
+			PROFILE_ZONE("window.flip");
+			window.flip();
+		}
+		if (!bench)
+			frameStats.record(cpuTime, ticks);
+		L.trace("Frame presented: {} logic ticks, {} us CPU time"_fmt,
+			ticks, cpuTime.count() / 1000);
+		if (hardSync) { // Blocks until the swap is done
 			syncParams.viewport.size = frame.size;
-			models.sync.draw(*frame.fb, scene, syncParams);
+			models.sync.draw(nullptr, scene, syncParams);
 		}
+
+		if (bench) {
+			benchTimings.lap(3);
+			benchTimings.frames += 1;
+			benchTimings.addSections(frame.timers.results);
+			benchFrame += 1;
+			if (benchFrame >= bench->frames)
+				window.requestClose();
+		}
+	}
+
+	if (bench) {
+		benchTimings.report();
+		print(cout, "\nFrame arena high-water mark: {} KiB\n", frame.arena.peak() / 1024);
+		return;
+	}
+
+	try {
+		frameStats.exportReport(FrameStatsPath);
+	} catch (system_error const& e) {
+		L.warn(R"(Could not write frame statistics to "{}": {})", FrameStatsPath, e.what());
 	}
 } catch (exception const& e) {
 	L.crit("Unhandled exception on game thread: {}", e.what());
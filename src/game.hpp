@@ -6,11 +6,30 @@
 #pragma once
 
 #include "sys/window.hpp"
+#include "base/string.hpp"
+#include "base/util.hpp"
 
 namespace minote {
 
+// Settings of a benchmark run. Instead of the keyboard, the game is driven by
+// a fixed script on a simulated clock of one logic tick per frame, with vsync
+// off. Every run with the same settings renders the same frames.
+struct BenchOptions {
+
+	// Number of frames to render before exiting
+	u32 frames = 1000;
+
+	// Frame to save as a PNG image, counted from 0
+	u32 dumpFrame = 0;
+
+	// Output of the saved frame. No frame is saved if empty
+	string dumpPath;
+
+};
+
 // Entry point of the game thread. The thread will exit after window.isClosing()
-// returns true. Window context must not be active.
-void game(Window& window);
+// returns true. Window context must not be active. If bench is provided,
+// the game runs as a benchmark, and requests the window to close once done.
+void game(Window& window, optional<BenchOptions> const& bench);
 
 }
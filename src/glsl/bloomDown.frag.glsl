@@ -0,0 +1,51 @@
+// Minote - glsl/bloomDown.frag.glsl
+// Dual filter downsample of the bloom chain. Blurs the image into half its
+// resolution with 5 bilinear samples. The first pass also applies
+// the brightness threshold. Must match bloomReference() in bloomfilter.cpp.
+
+#version 330 core
+
+in vec2 fTexCoords;
+
+out vec4 outColor;
+
+uniform sampler2D image;
+uniform vec2 imageTexel; ///< Size of one texel of the input texture
+uniform vec2 imageScale; ///< Portion of the input texture covered by the image
+uniform bool prefilter; ///< Whether to apply the threshold curve
+uniform float threshold; ///< Lower limit of the input range
+uniform float softKnee; ///< Percentage of the 0,threshold range to include
+
+#include "util.glslh"
+
+vec3 sampleImage(vec2 texCoords)
+{
+    return texture(image, clampToImage(texCoords, imageScale, imageTexel)).rgb;
+}
+
+// https://community.arm.com/cfs-file/__key/communityserver-blogs-components-weblogfiles/00-00-00-20-66/siggraph2015_2D00_mmg_2D00_marius_2D00_notes.pdf
+void main()
+{
+    vec2 center = fTexCoords * imageScale;
+    vec2 diagonal = vec2(imageTexel.x, -imageTexel.y);
+    vec3 color = sampleImage(center) * 4.0;
+    color += sampleImage(center - imageTexel);
+    color += sampleImage(center + imageTexel);
+    color += sampleImage(center + diagonal);
+    color += sampleImage(center - diagonal);
+    color /= 8.0;
+
+    // https://catlikecoding.com/unity/tutorials/advanced-rendering/bloom/
+    if (prefilter) {
+        float brightness = max(color.r, max(color.g, color.b));
+        float knee = threshold * softKnee;
+        float soft = brightness - threshold + knee;
+        soft = clamp(soft, 0, 2 * knee);
+        soft = soft * soft / (4 * knee + 0.00001);
+        float contribution = max(soft, brightness - threshold);
+        contribution /= max(brightness, 0.00001);
+        color *= contribution;
+    }
+
+    outColor = vec4(color, 0.0);
+}
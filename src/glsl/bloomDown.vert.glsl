@@ -1,6 +1,6 @@
-// Minote - glsl/boxBlur.vert.glsl
-// Blurs an input image by sampling 4 points diagonally. Generates its own
-// vertices - just draw 3 triangles with no buffers attached.
+// Minote - glsl/bloomDown.vert.glsl
+// Dual filter downsample of the bloom chain. Generates its own vertices - just
+// draw 1 triangle with no buffers attached.
 
 #version 330 core
 
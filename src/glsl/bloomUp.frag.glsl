@@ -0,0 +1,43 @@
+// Minote - glsl/bloomUp.frag.glsl
+// Dual filter upsample of the bloom chain. Blurs the image into twice its
+// resolution with a tent of 8 bilinear samples, meant to be added on top
+// of the target. Must match bloomReference() in bloomfilter.cpp.
+
+#version 330 core
+
+in vec2 fTexCoords;
+
+out vec4 outColor;
+
+uniform sampler2D image;
+uniform vec2 imageTexel; ///< Size of one texel of the input texture
+uniform vec2 imageScale; ///< Portion of the input texture covered by the image
+uniform float strength; ///< Final multiplier
+
+#include "util.glslh"
+
+vec3 sampleImage(vec2 texCoords)
+{
+    return texture(image, clampToImage(texCoords, imageScale, imageTexel)).rgb;
+}
+
+// https://community.arm.com/cfs-file/__key/communityserver-blogs-components-weblogfiles/00-00-00-20-66/siggraph2015_2D00_mmg_2D00_marius_2D00_notes.pdf
+void main()
+{
+    vec2 halfTexel = imageTexel * 0.5;
+    vec2 diagonal = vec2(halfTexel.x, -halfTexel.y);
+    vec3 color = vec3(0.0);
+    vec2 center = fTexCoords * imageScale;
+    color += sampleImage(center + vec2(imageTexel.x, 0.0));
+    color += sampleImage(center - vec2(imageTexel.x, 0.0));
+    color += sampleImage(center + vec2(0.0, imageTexel.y));
+    color += sampleImage(center - vec2(0.0, imageTexel.y));
+    color += sampleImage(center + halfTexel) * 2.0;
+    color += sampleImage(center - halfTexel) * 2.0;
+    color += sampleImage(center + diagonal) * 2.0;
+    color += sampleImage(center - diagonal) * 2.0;
+    color /= 12.0;
+
+    // Alpha is left untouched by additive blending
+    outColor = vec4(color * strength, 0.0);
+}
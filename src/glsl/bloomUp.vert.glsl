@@ -0,0 +1,15 @@
+// Minote - glsl/bloomUp.vert.glsl
+// Dual filter upsample of the bloom chain. Generates its own vertices - just
+// draw 1 triangle with no buffers attached.
+
+#version 330 core
+
+out vec2 fTexCoords;
+
+#include "util.glslh"
+
+void main()
+{
+    vec2 pos = triangleVertex(gl_VertexID, fTexCoords);
+    gl_Position = vec4(pos, 0, 1);
+}
@@ -9,11 +9,12 @@ in vec2 fTexCoords;
 out vec4 outColor;
 
 uniform sampler2D image;
+uniform vec2 imageScale; ///< Portion of the texture covered by the image
 
 #include "util.glslh"
 
 void main()
 {
-    vec4 color = texture(image, fTexCoords);
+    vec4 color = texture(image, fTexCoords * imageScale);
     outColor = vec4(srgbEncode(color.rgb), color.a);
 }
@@ -10,6 +10,7 @@ layout(location = 2) in vec3 vNormal;
 layout(location = 3) in vec4 iTint;
 layout(location = 4) in vec4 iHighlight;
 layout(location = 5) in mat4 iModel;
+layout(location = 9) in mat3 iNormal; // View space normal matrix
 
 out vec3 fPosition;
 out vec4 fColor;
@@ -23,9 +24,11 @@ uniform vec3 lightPosition;
 
 void main()
 {
-    gl_Position = projection * view * iModel * vec4(vPosition, 1.0);
-    fPosition = vec3(view * iModel * vec4(vPosition, 1.0));
-    fNormal = mat3(transpose(inverse(view * iModel))) * vNormal;
+    mat4 modelView = view * iModel;
+    vec4 viewPosition = modelView * vec4(vPosition, 1.0);
+    gl_Position = projection * viewPosition;
+    fPosition = vec3(viewPosition);
+    fNormal = iNormal * vNormal;
     fColor = vColor * iTint;
     fHighlight = iHighlight;
     fLightPosition = vec3(view * vec4(lightPosition, 1.0));
@@ -8,7 +8,8 @@ out vec2 fTexCoords;
 out vec2 fPixCoords;
 out vec4 fOffset[3];
 
-uniform vec4 screenSize;
+uniform vec4 screenSize; ///< Texel size and size of the textures
+uniform vec2 imageScale; ///< Portion of the textures covered by the image
 
 #define SMAA_RT_METRICS screenSize
 #define SMAA_INCLUDE_VS 1
@@ -19,6 +20,7 @@ uniform vec4 screenSize;
 void main()
 {
     vec2 pos = triangleVertex(gl_VertexID, fTexCoords);
+    fTexCoords *= imageScale;
 
     fOffset[0] = vec4(0.0, 0.0, 0.0, 0.0);
     fOffset[1] = vec4(0.0, 0.0, 0.0, 0.0);
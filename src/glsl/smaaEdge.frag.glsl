@@ -11,13 +11,21 @@ out vec4 outColor;
 
 uniform sampler2D image;
 uniform vec4 screenSize;
+uniform vec2 imageScale;
 
 #define SMAA_RT_METRICS screenSize
 #define SMAA_INCLUDE_VS 0
 #define SMAA_INCLUDE_PS 1
 #include "smaaParams.glslh"
+#include "util.glslh"
 
 void main()
 {
-    outColor = vec4(SMAAColorEdgeDetectionPS(fTexCoords, fOffset, image), 0.0, 0.0);
+    // Neighbors past the image's edge repeat the edge, like GL_CLAMP_TO_EDGE
+    vec4 offset[3];
+    for (int i = 0; i < 3; i += 1) {
+        offset[i].xy = clampToImage(fOffset[i].xy, imageScale, screenSize.xy);
+        offset[i].zw = clampToImage(fOffset[i].zw, imageScale, screenSize.xy);
+    }
+    outColor = vec4(SMAAColorEdgeDetectionPS(fTexCoords, offset, image), 0.0, 0.0);
 }
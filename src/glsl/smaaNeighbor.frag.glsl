@@ -13,6 +13,7 @@ uniform sampler2D image;
 uniform sampler2D blend;
 uniform float alpha;
 uniform vec4 screenSize;
+uniform vec2 imageScale;
 
 #define SMAA_RT_METRICS screenSize
 #define SMAA_INCLUDE_VS 0
@@ -22,6 +23,11 @@ uniform vec4 screenSize;
 
 void main()
 {
-    vec4 color = SMAANeighborhoodBlendingPS(fTexCoords, fOffset, image, blend);
+    // Weights of neighbors past the image's edge repeat the edge,
+    // like GL_CLAMP_TO_EDGE
+    vec4 offset = vec4(
+        clampToImage(fOffset.xy, imageScale, screenSize.xy),
+        clampToImage(fOffset.zw, imageScale, screenSize.xy));
+    vec4 color = SMAANeighborhoodBlendingPS(fTexCoords, offset, image, blend);
     outColor = vec4(color.rgb, color.a * alpha);
 }
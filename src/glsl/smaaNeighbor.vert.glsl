@@ -7,7 +7,8 @@
 out vec2 fTexCoords;
 out vec4 fOffset;
 
-uniform vec4 screenSize;
+uniform vec4 screenSize; ///< Texel size and size of the textures
+uniform vec2 imageScale; ///< Portion of the textures covered by the image
 
 #define SMAA_RT_METRICS screenSize
 #define SMAA_INCLUDE_VS 1
@@ -18,6 +19,7 @@ uniform vec4 screenSize;
 void main()
 {
     vec2 pos = triangleVertex(gl_VertexID, fTexCoords);
+    fTexCoords *= imageScale;
 
     fOffset = vec4(0.0, 0.0, 0.0, 0.0);
     SMAANeighborhoodBlendingVS(fTexCoords, fOffset);
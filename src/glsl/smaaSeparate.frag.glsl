@@ -0,0 +1,17 @@
+// Minote - glsl/smaaSeparate.frag.glsl
+// SMAA S2x sample separation stage. Splits the two samples of a 2x
+// multisampled image into two separate images.
+
+#version 330 core
+
+layout(location = 0) out vec4 outSample0;
+layout(location = 1) out vec4 outSample1;
+
+uniform sampler2DMS image;
+
+void main()
+{
+    ivec2 coords = ivec2(gl_FragCoord.xy);
+    outSample0 = texelFetch(image, coords, 0);
+    outSample1 = texelFetch(image, coords, 1);
+}
@@ -0,0 +1,15 @@
+// Minote - glsl/smaaSeparate.vert.glsl
+// SMAA S2x sample separation stage. Generates its own vertices - just draw
+// 1 triangle with no buffers attached.
+
+#version 330 core
+
+out vec2 fTexCoords;
+
+#include "util.glslh"
+
+void main()
+{
+    vec2 pos = triangleVertex(gl_VertexID, fTexCoords);
+    gl_Position = vec4(pos, 1.0, 1.0);
+}
@@ -9,6 +9,10 @@
 #endif //NOMINMAX
 #include <windows.h>
 #endif //_WIN32
+#include <limits>
+#include <cstdlib>
+#include <cctype>
+#include <cerrno>
 #include "base/thread.hpp"
 #include "base/string.hpp"
 #include "base/util.hpp"
@@ -30,28 +34,82 @@ auto assertHandler(char const* expr, char const* file, int line, char const* msg
 	throw logic_error{str};
 }
 
+// Parse a decimal frame number. Returns nullopt unless the whole string
+// is a number that fits in u32.
+static auto parseFrames(char const* const str) -> optional<u32> {
+	if (!std::isdigit(static_cast<unsigned char>(str[0]))) return nullopt;
+	char* end = nullptr;
+	errno = 0;
+	auto const value = std::strtoul(str, &end, 10);
+	if (*end != '\0' || errno == ERANGE || value > std::numeric_limits<u32>::max())
+		return nullopt;
+	return u32(value);
+}
+
 // Entry point function. Initializes systems and spawns other threads. Itself
 // becomes the input handling thread. Returns EXIT_SUCCESS on successful
 // execution, EXIT_FAILURE on a handled critical error, other values
-// on unhandled error
-auto main(int, char*[]) -> int try {
+// on unhandled error. Usage:
+//     minote [--bench [frames]] [--dump <frame> <file.png>] [--headless]
+// --bench runs a scripted benchmark in a hidden window, and prints the timings.
+// --dump saves a frame of the benchmark, counted from 0, so it has to be lower
+// than the frame count. --headless runs without a display server, with
+// software rendering.
+auto main(int argc, char* argv[]) -> int try {
 	// *** Initialization ***
 
 	set_assert_handler(assertHandler);
 
+	// Command line
+	auto const usage = [&] {
+		print(cerr, "Usage: {} [--bench [frames]] [--dump <frame> <file.png>] [--headless]\n", argv[0]);
+		return EXIT_FAILURE;
+	};
+	auto bench = optional<BenchOptions>();
+	bool headless = false;
+	for (int i = 1; i < argc; i += 1) {
+		auto const arg = string_view(argv[i]);
+		if (arg == "--bench") {
+			if (!bench) bench.emplace();
+			if (i + 1 < argc && argv[i + 1][0] != '-') {
+				auto const frames = parseFrames(argv[++i]);
+				if (!frames || *frames == 0) return usage();
+				bench->frames = *frames;
+			}
+		} else if (arg == "--dump" && i + 2 < argc) {
+			if (!bench) bench.emplace();
+			auto const frame = parseFrames(argv[++i]);
+			if (!frame) return usage();
+			bench->dumpFrame = *frame;
+			bench->dumpPath = argv[++i];
+		} else if (arg == "--headless") {
+			headless = true;
+		} else {
+			return usage();
+		}
+	}
+	if (bench && !bench->dumpPath.empty() && bench->dumpFrame >= bench->frames) {
+		print(cerr, "Frame {} can't be dumped, the benchmark only runs {} frames\n",
+			bench->dumpFrame, bench->frames);
+		return usage();
+	}
+
 	// Unicode support
 #ifdef _WIN32
 	SetConsoleOutputCP(65001); // Set Windows cmd encoding to UTF-8
 #endif //_WIN32
 
-	// Global logging
+	// Global logging. Per-frame Trace messages only go to the trace file
 #ifndef NDEBUG
-	L.level = Log::Level::Trace;
+	L.level = Log::Level::Debug;
 	constexpr auto Logpath = "minote-debug.log"sv;
+	constexpr auto Tracepath = "minote-debug.trace"sv;
 #else //NDEBUG
 	L.level = Log::Level::Info;
 	constexpr auto Logpath = "minote.log"sv;
+	constexpr auto Tracepath = "minote.trace"sv;
 #endif //NDEBUG
+	L.traceLevel = Log::Level::Trace;
 	L.console = true;
 	try {
 		file logfile{Logpath, "w"};
@@ -59,19 +117,31 @@ auto main(int, char*[]) -> int try {
 	} catch (system_error const& e) {
 		L.warn("{}", Logpath, e.what());
 	}
+	// Messages with a compile-time format are also written in binary,
+	// to be decoded with minote-logdump
+	try {
+		file tracefile{Tracepath, "wb"};
+		L.enableTraceFile(move(tracefile));
+	} catch (system_error const& e) {
+		L.warn(R"(Could not open trace file "{}": {})", Tracepath, e.what());
+	}
+	L.enableAsync();
 	auto const title = format("{} {}", AppName, AppVersion);
 	L.info("Starting up {}", title);
 
-	// Window creation
-	Glfw glfw;
-	Window window{glfw, title};
+	// Window creation. Benchmarks don't need to be seen
+	Glfw glfw{headless};
+	Window window{glfw, title, false, {1280, 720}, !bench && !headless};
 
 //#ifdef MINOTE_DEBUG
 	debugInputSetup(window);
 //#endif //MINOTE_DEBUG
+#ifdef MINOTE_SHADER_RELOAD
+	window.createSharedContext(); // Used by the shader reloader
+#endif //MINOTE_SHADER_RELOAD
 
 	// Thread startup
-	thread gameThread(game, ref(window));
+	thread gameThread(game, ref(window), cref(bench));
 
 	// Signal other threads to quit if input thread terminates first
 	defer { window.requestClose(); };
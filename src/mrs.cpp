@@ -384,7 +384,7 @@ static void lock(void)
 	mrsEffectLock();
 }
 
-void mrsInit(void)
+void mrsInit(uint64_t seed)
 {
 	if (initialized) return;
 
@@ -397,7 +397,7 @@ void mrsInit(void)
 	mrsTet.player.spawnDelay = MrsSpawnDelay; // Start instantly
 	mrsTet.player.gravity = 3;
 
-	mrsTet.rng.seed((uint64_t)time(nullptr));
+	mrsTet.rng.seed(seed? seed : (uint64_t)time(nullptr));
 	for (size_t i = 0; i < MinoGarbage - 1; i += 1)
 		mrsTet.player.tokens[i] = MrsStartingTokens;
 	do {
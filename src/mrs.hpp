@@ -92,8 +92,9 @@ extern int mrsDebugInfLock; // Boolean, int for compatibility
 /**
  * Initialize the mrs sublayer. Needs to be called before the layer can be
  * used.
+ * @param seed Seed of the piece randomizer, or 0 to seed from the current time
  */
-void mrsInit(void);
+void mrsInit(uint64_t seed = 0);
 
 /**
  * Clean up the mrs sublayer. Play functions cannot be used until mrsInit() is
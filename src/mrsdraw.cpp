@@ -7,6 +7,8 @@
 
 #include "sys/glfw.hpp"
 #include "engine/engine.hpp"
+#include "base/profile.hpp"
+#include "base/arena.hpp"
 #include "particles.hpp"
 #include "mrsdef.hpp"
 #include "debug.hpp"
@@ -14,12 +16,10 @@
 
 using namespace minote;
 
-static constexpr size_t MaxBlocks = 512;
-static constexpr size_t MaxBorders = 1024;
-
-static svector<ModelPhong::Instance, MaxBlocks> opaqueBlocks{};
-static svector<ModelPhong::Instance, MaxBlocks> transparentBlocks{};
-static svector<ModelFlat::Instance, MaxBorders> borders{};
+/// Instance lists of the frame being drawn, allocated from the frame arena
+static ArenaVector<ModelPhong::Instance> opaqueBlocks{};
+static ArenaVector<ModelPhong::Instance> transparentBlocks{};
+static ArenaVector<ModelFlat::Instance> borders{};
 
 /// Last player position as seen by the drawing system
 static ivec2 lastPlayerPos = {0, 0};
@@ -35,51 +35,45 @@ static Tween playerPosX = {
 	.type = exponentialEaseOut
 };
 
-static Tween playerPosY = {
+static FixedTween<exponentialEaseOut<f32>> playerPosY = {
 	.from = 0.0f,
 	.to = 0.0f,
-	.duration = 3 * MrsUpdateTick,
-	.type = exponentialEaseOut
+	.duration = 3 * MrsUpdateTick
 };
 
 /// Tweening of player piece rotation
-static Tween playerRotation = {
+static FixedTween<exponentialEaseOut<f32>> playerRotation = {
 	.from = 0.0f,
 	.to = 0.0f,
-	.duration = 3 * MrsUpdateTick,
-	.type = exponentialEaseOut
+	.duration = 3 * MrsUpdateTick
 };
 
 /// Player piece animation after the piece locks
-static Tween lockFlash = {
+static FixedTween<linearInterpolation<f32>> lockFlash = {
 	.from = 1.0f,
 	.to = 0.0f,
-	.duration = 8 * MrsUpdateTick,
-	.type = linearInterpolation
+	.duration = 8 * MrsUpdateTick
 };
 
 /// Player piece animation as the lock delay ticks down
-static Tween lockDim = {
+static FixedTween<quadraticEaseIn<f32>> lockDim = {
 	.from = 1.0f,
 	.to = 0.1f,
-	.duration = MrsLockDelay * MrsUpdateTick,
-	.type = quadraticEaseIn
+	.duration = MrsLockDelay * MrsUpdateTick
 };
 
 /// Animation of the scene when combo counter changes
-static Tween comboFade = {
+static FixedTween<quadraticEaseOut<f32>> comboFade = {
 	.from = 1.1f,
 	.to = 1.1f,
-	.duration = 24 * MrsUpdateTick,
-	.type = quadraticEaseOut
+	.duration = 24 * MrsUpdateTick
 };
 
 /// Thump animation of a falling stack
-static Tween clearFall = {
+static FixedTween<cubicEaseIn<f32>> clearFall = {
 	.from = 0.0f,
 	.to = 1.0f,
-	.duration = MrsClearDelay * MrsUpdateTick,
-	.type = cubicEaseIn
+	.duration = MrsClearDelay * MrsUpdateTick
 };
 
 /// Sparks released on line clear
@@ -212,22 +206,33 @@ static void mrsDebug(void)
 
 void mrsDraw(Engine& engine)
 {
+	PROFILE_ZONE("mrsDraw");
+	opaqueBlocks = ArenaVector<ModelPhong::Instance>(engine.frame.arena);
+	transparentBlocks = ArenaVector<ModelPhong::Instance>(engine.frame.arena);
+	borders = ArenaVector<ModelFlat::Instance>(engine.frame.arena);
+
+	// All animations of the frame are sampled at the same moment
+	nsec const now = Glfw::getTime();
+
 	// Draw field scene
-	f32 const sceneBoost = comboFade.apply();
-	engine.models.field.draw(*engine.frame.fb, engine.scene, {
-		.blending = true
-	}, {
-		.tint = {sceneBoost, sceneBoost, sceneBoost, 1.0f}
-	});
+	f32 const sceneBoost = comboFade.applyAt(now);
+	{
+		GPU_ZONE(engine.frame.timers, "field");
+		engine.models.field.draw(engine.frame.fb, engine.scene, {
+			.blending = true
+		}, {
+			.tint = {sceneBoost, sceneBoost, sceneBoost, 1.0f}
+		});
 
-	// Draw column guide
-	engine.models.guide.draw(*engine.frame.fb, engine.scene, {
-		.blending = true
-	});
+		// Draw column guide
+		engine.models.guide.draw(engine.frame.fb, engine.scene, {
+			.blending = true
+		});
+	}
 
 	// Queue up blocks in the field
 	int linesCleared = 0;
-	f32 const fallProgress = clearFall.apply();
+	f32 const fallProgress = clearFall.applyAt(now);
 
 	for (size_t i = 0; i < FieldWidth * FieldHeight; i += 1) {
 		ivec2 const pos = {i % FieldWidth, i / FieldWidth};
@@ -261,7 +266,7 @@ void mrsDraw(Engine& engine)
 			}
 		}
 		if (playerCell) {
-			f32 const flash = lockFlash.apply();
+			f32 const flash = lockFlash.applyAt(now);
 			instance.highlight = {MrsLockFlashBrightness,
 			                       MrsLockFlashBrightness,
 			                       MrsLockFlashBrightness, flash};
@@ -282,7 +287,7 @@ void mrsDraw(Engine& engine)
 
 	// Tween the player position
 	if (mrsTet.player.pos.x != lastPlayerPos.x) {
-		playerPosX.from = playerPosX.apply();
+		playerPosX.from = playerPosX.applyAt(now);
 		playerPosX.to = mrsTet.player.pos.x;
 		if (mrsTet.player.autoshiftCharge == MrsAutoshiftCharge) {
 			playerPosX.duration = 1 * MrsUpdateTick;
@@ -291,13 +296,13 @@ void mrsDraw(Engine& engine)
 			playerPosX.duration = 3 * MrsUpdateTick;
 			playerPosX.type = exponentialEaseOut;
 		}
-		playerPosX.restart();
+		playerPosX.start = now;
 		lastPlayerPos.x = mrsTet.player.pos.x;
 	}
 	if (mrsTet.player.pos.y != lastPlayerPos.y) {
-		playerPosY.from = playerPosY.apply();
+		playerPosY.from = playerPosY.applyAt(now);
 		playerPosY.to = mrsTet.player.pos.y;
-		playerPosY.restart();
+		playerPosY.start = now;
 		lastPlayerPos.y = mrsTet.player.pos.y;
 	}
 
@@ -307,10 +312,10 @@ void mrsDraw(Engine& engine)
 			mrsTet.player.rotation - tmod(lastPlayerRotation, +SpinSize);
 		if (delta == 3) delta -= 4;
 		if (delta == -3) delta += 4;
-		playerRotation.from = playerRotation.apply();
+		playerRotation.from = playerRotation.applyAt(now);
 		lastPlayerRotation += delta;
 		playerRotation.to = lastPlayerRotation;
-		playerRotation.restart();
+		playerRotation.start = now;
 	}
 
 	// Draw the blocks if needed
@@ -322,13 +327,13 @@ void mrsDraw(Engine& engine)
 
 		// Get piece transform (piece position and rotation)
 		mat4 const pieceTranslation = make_translate({
-			playerPosX.apply() - (signed)(FieldWidth / 2),
-			playerPosY.apply(),
+			playerPosX.applyAt(now) - (signed)(FieldWidth / 2),
+			playerPosY.applyAt(now),
 			0.0f
 		});
 		mat4 const pieceRotationPre = make_translate({0.5f, 0.5f, 0.0f});
 		mat4 const pieceRotation = rotate(pieceRotationPre,
-			playerRotation.apply() * radians(90.0f), {0.0f, 0.0f, 1.0f});
+			playerRotation.applyAt(now) * radians(90.0f), {0.0f, 0.0f, 1.0f});
 		mat4 const pieceRotationPost = translate(pieceRotation,
 			{-0.5f, -0.5f, 0.0f});
 		mat4 const pieceTransform = pieceTranslation * pieceRotationPost;
@@ -346,9 +351,8 @@ void mrsDraw(Engine& engine)
 			// Insert calculated values
 			instance.tint = minoColor(mrsTet.player.type);
 			if (mrsTet.player.lockDelay != 0) {
-				lockDim.restart();
-				lockDim.start -= mrsTet.player.lockDelay * MrsUpdateTick;
-				f32 dim = lockDim.apply();
+				lockDim.start = now - mrsTet.player.lockDelay * MrsUpdateTick;
+				f32 dim = lockDim.applyAt(now);
 				instance.tint.r *= dim;
 				instance.tint.g *= dim;
 				instance.tint.b *= dim;
@@ -362,7 +366,7 @@ void mrsDraw(Engine& engine)
 		mrsTet.player.state == PlayerSpawned) &&
 		mrsTet.player.gravity < MrsSubGrid && // Don't show if the game is too fast for it to help
 			(!mrsTet.player.lockDelay ||
-			(Glfw::getTime() < playerPosY.start + playerPosY.duration)) // Don't show if player is on the ground
+			(now < playerPosY.start + playerPosY.duration)) // Don't show if player is on the ground
 		) {
 		ivec2 ghostPos = mrsTet.player.pos;
 		while (!pieceOverlapsField(&mrsTet.player.shape, {
@@ -405,14 +409,17 @@ void mrsDraw(Engine& engine)
 	}
 
 	// Draw all queued blocks
-	engine.models.block.draw(*engine.frame.fb, engine.scene, {}, opaqueBlocks);
+	{
+		GPU_ZONE(engine.frame.timers, "blocks");
+		engine.models.block.draw(engine.frame.fb, engine.scene, {}, opaqueBlocks);
+		engine.models.block.draw(engine.frame.fb, engine.scene, {
+			.colorWrite = false
+		}, transparentBlocks);
+		engine.models.block.draw(engine.frame.fb, engine.scene, {
+			.blending = true
+		}, transparentBlocks);
+	}
 	opaqueBlocks.clear();
-	engine.models.block.draw(*engine.frame.fb, engine.scene, {
-		.colorWrite = false
-	}, transparentBlocks);
-	engine.models.block.draw(*engine.frame.fb, engine.scene, {
-		.blending = true
-	}, transparentBlocks);
 	transparentBlocks.clear();
 
 	// Draw the block borders
@@ -487,9 +494,12 @@ void mrsDraw(Engine& engine)
 				{1.0f, 1.0f, 1.0f, alpha});
 	}
 
-	engine.models.border.draw(*engine.frame.fb, engine.scene, {
-		.blending = true,
-	}, borders);
+	{
+		GPU_ZONE(engine.frame.timers, "borders");
+		engine.models.border.draw(engine.frame.fb, engine.scene, {
+			.blending = true,
+		}, borders);
+	}
 	borders.clear();
 
 #ifdef MINOTE_DEBUG
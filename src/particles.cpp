@@ -8,6 +8,9 @@
 #include <time.h>
 #include "cephes/protos.h"
 #include "base/array.hpp"
+#include "base/arena.hpp"
+#include "base/tween.hpp"
+#include "base/jobs.hpp"
 #include "sys/glfw.hpp"
 #include "engine/model.hpp"
 #include "base/util.hpp"
@@ -36,22 +39,36 @@ typedef struct Particle {
 
 constexpr size_t MaxParticles{4096};
 
+/// Number of particles whose instances are computed by a single job
+constexpr size_t ParticleBatch{128};
+
 static svector<Particle, MaxParticles> particles{};
 static Rng rng{};
 
-static svector<ModelFlat::Instance, MaxParticles> particleInstances{};
+/// Instances of the frame being drawn, allocated from the frame arena
+static ArenaVector<ModelFlat::Instance> particleInstances{};
 
 static bool initialized = false;
 
-void particlesInit(void)
+void particlesInit(uint64_t seed)
 {
 	if (initialized) return;
 
-	rng.seed((uint64_t)time(nullptr));
+	rng.seed(seed? seed : (uint64_t)time(nullptr));
 
 	initialized = true;
 }
 
+void particlesCleanup(void)
+{
+	if (!initialized) return;
+
+	particles.clear();
+	particleInstances = {};
+
+	initialized = false;
+}
+
 void particlesUpdate(void)
 {
 	ASSERT(initialized);
@@ -68,71 +85,104 @@ void particlesUpdate(void)
 	}
 }
 
-void particlesDraw(Engine& engine)
+/**
+ * Compute the draw instance of a particle.
+ * @param particle Particle to draw
+ * @param progress Eased progress of the particle's lifetime, from 0 to 1
+ * @param instance Output instance
+ */
+static void particleInstance(Particle const& particle, float progress,
+	ModelFlat::Instance& instance)
 {
-	ASSERT(initialized);
-
 	double fresnelConst = sqrt(4.0 / Tau);
 
+	ASSERT(progress >= 0.0f && progress <= 1.0f);
+
+	double x;
+	double y;
+	ASSERT(particle.spin > 0.0f);
+	float distance = progress * particle.distance * particle.spin;
+	fresnl(distance * fresnelConst, &y, &x);
+	x = x / fresnelConst / particle.spin;
+	y = y / fresnelConst / particle.spin;
+	if (particle.horz == -1)
+		x *= -1.0;
+	else
+		x += 1.0;
+	if (particle.vert == -1)
+		y *= -1.0;
+	x += particle.origin.x;
+	y += particle.origin.y;
+
+	float angle = distance * distance;
+	if (particle.horz == -1)
+		angle = radians(180.0f) - angle;
+	if (particle.vert == -1)
+		angle *= -1.0f;
+
+	instance.tint = particle.color;
+
+	// Shimmer mitigation
+	if (progress > ShimmerFade) {
+		float fadeout = progress - ShimmerFade;
+		fadeout *= 1.0f / (1.0f - ShimmerFade);
+		fadeout = 1.0f - fadeout;
+		fadeout = cubicEaseIn(fadeout);
+		instance.tint.a *= fadeout;
+	}
+
+	const mat4 translated = make_translate({(float)x, (float)y, particle.origin.z});
+	const mat4 rotated = rotate(translated, angle, {0.0f, 0.0f, 1.0f});
+	instance.transform = scale(rotated, {1.0f - progress, 1.0f, 1.0f});
+}
+
+size_t particlesQueue(Arena& arena, JobSystem& jobs)
+{
+	ASSERT(initialized);
+
 	size_t const numParticles = particles.size();
-	if (!numParticles) return;
-
-	for (size_t i = 0; i < numParticles; i += 1) {
-		Particle* current = &particles[i];
-		ASSERT(current->spin > 0.0f);
-
-		Tween progressTween = {
-			.from = 0.0f,
-			.to = 1.0f,
-			.start = current->start,
-			.duration = current->duration,
-			.type = current->ease
-		};
-		float progress = progressTween.apply();
-		ASSERT(progress >= 0.0f && progress <= 1.0f);
-
-		double x;
-		double y;
-		ASSERT(current->spin > 0.0f);
-		float distance = progress * current->distance * current->spin;
-		fresnl(distance * fresnelConst, &y, &x);
-		x = x / fresnelConst / current->spin;
-		y = y / fresnelConst / current->spin;
-		if (current->horz == -1)
-			x *= -1.0;
-		else
-			x += 1.0;
-		if (current->vert == -1)
-			y *= -1.0;
-		x += current->origin.x;
-		y += current->origin.y;
-
-		float angle = distance * distance;
-		if (current->horz == -1)
-			angle = radians(180.0f) - angle;
-		if (current->vert == -1)
-			angle *= -1.0f;
-
-		auto& instance = particleInstances.emplace_back();
-		instance.tint = current->color;
-
-		// Shimmer mitigation
-		if (progress > ShimmerFade) {
-			float fadeout = progress - ShimmerFade;
-			fadeout *= 1.0f / (1.0f - ShimmerFade);
-			fadeout = 1.0f - fadeout;
-			fadeout = cubicEaseIn(fadeout);
-			instance.tint.a *= fadeout;
+	particleInstances = ArenaVector<ModelFlat::Instance>(arena);
+	particleInstances.resize(numParticles);
+
+	// Scratch space for the batch tween evaluation
+	auto progressTweens = ArenaVector<Tween<float>>(arena);
+	progressTweens.resize(numParticles);
+	auto progress = ArenaVector<float>(arena);
+	progress.resize(numParticles);
+
+	// Every particle is independent, so they are spread across workers
+	nsec const time = Glfw::getTime();
+	jobs.parallelFor(numParticles, ParticleBatch, [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i += 1) {
+			progressTweens[i] = {
+				.from = 0.0f,
+				.to = 1.0f,
+				.start = particles[i].start,
+				.duration = particles[i].duration,
+				.type = particles[i].ease
+			};
 		}
+		evaluate({progressTweens.data() + begin, end - begin}, time,
+			{progress.data() + begin, end - begin});
+		for (size_t i = begin; i < end; i += 1)
+			particleInstance(particles[i], progress[i], particleInstances[i]);
+	});
 
-		const mat4 translated = make_translate({(float)x, (float)y, current->origin.z});
-		const mat4 rotated = rotate(translated, angle, {0.0f, 0.0f, 1.0f});
-		instance.transform = scale(rotated, {1.0f - progress, 1.0f, 1.0f});
-	}
+	return particleInstances.size();
+}
 
-	engine.models.particle.draw(*engine.frame.fb, engine.scene, {
-		.blending = true
-	}, particleInstances);
+void particlesDraw(Engine& engine)
+{
+	ASSERT(initialized);
+
+	if (!particlesQueue(engine.frame.arena, engine.jobs)) return;
+
+	{
+		GPU_ZONE(engine.frame.timers, "particles");
+		engine.models.particle.draw(engine.frame.fb, engine.scene, {
+			.blending = true
+		}, particleInstances);
+	}
 	particleInstances.clear();
 }
 
@@ -11,6 +11,8 @@
 #include "base/tween.hpp"
 #include "base/ease.hpp"
 #include "base/time.hpp"
+#include "base/arena.hpp"
+#include "base/jobs.hpp"
 #include "engine/engine.hpp"
 
 /// Details of a particle effect
@@ -30,14 +32,32 @@ typedef struct ParticleParams {
 /**
  * Initialize the particles layer. This must be called before any other
  * particles functions.
+ * @param seed Seed of the particle generator, or 0 to seed from the current
+ * time
  */
-void particlesInit(void);
+void particlesInit(uint64_t seed = 0);
+
+/**
+ * Clean up the particles layer, removing all active particles. Particles
+ * functions cannot be used until particlesInit() is called again.
+ */
+void particlesCleanup(void);
 
 /**
  * Update active particles to remove expired ones.
  */
 void particlesUpdate(void);
 
+/**
+ * Compute the draw instances of all active particles at their current
+ * position, replacing the previous ones. Called by particlesDraw().
+ * @param arena Arena to allocate the instances from. They are valid until
+ * its next reset
+ * @param jobs Job system to spread the work over
+ * @return Number of instances
+ */
+size_t particlesQueue(minote::Arena& arena, minote::JobSystem& jobs);
+
 /**
  * Draw all active particles to the screen at their current position.
  */
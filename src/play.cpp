@@ -21,12 +21,12 @@ static svector<Action, 64> collectedInputs;
 
 static bool initialized = false;
 
-void playInit(void)
+void playInit(uint64_t seed)
 {
 	if (initialized) return;
 
 	nextUpdate = Glfw::getTime() + MrsUpdateTick;
-	mrsInit();
+	mrsInit(seed);
 
 	initialized = true;
 	L.debug("Play layer initialized");
@@ -42,11 +42,12 @@ void playCleanup(void)
 	L.debug("Play layer cleaned up");
 }
 
-void playUpdate(Window& window, Mapper& mapper)
+auto playUpdate(Window& window, Mapper& mapper) -> u32
 {
 	ASSERT(initialized);
 
 	// Update as many times as we need to catch up
+	u32 ticks = 0;
 	while (nextUpdate <= Glfw::getTime()) {
 		while (auto const action = mapper.peekAction()) { // Exhaust all actions...
 			if (action->timestamp <= nextUpdate) {
@@ -64,7 +65,9 @@ void playUpdate(Window& window, Mapper& mapper)
 		mrsAdvance(collectedInputs);
 		collectedInputs.clear();
 		nextUpdate += MrsUpdateTick;
+		ticks += 1;
 	}
+	return ticks;
 }
 
 void playDraw(Engine& engine)
@@ -14,8 +14,10 @@
 
 /**
  * Initialize the play layer. Needs to be called before the layer can be used.
+ * @param seed Seed of the game's randomness, or 0 to seed from the current
+ * time
  */
-void playInit(void);
+void playInit(uint64_t seed = 0);
 
 /**
  * Clean up the play layer. Play functions cannot be used until playInit() is
@@ -24,9 +26,11 @@ void playInit(void);
 void playCleanup(void);
 
 /**
- * Advance the play layer.
+ * Advance the play layer, running as many logic ticks as needed to catch up
+ * with the current time.
+ * @return Number of logic ticks that were run
  */
-void playUpdate(minote::Window& window, minote::Mapper& mapper);
+auto playUpdate(minote::Window& window, minote::Mapper& mapper) -> minote::u32;
 
 /**
  * Draw the play layer to the screen.
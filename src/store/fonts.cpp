@@ -20,4 +20,9 @@ Fonts::~Fonts() noexcept {
 	}
 }
 
+void Fonts::update() {
+	for (auto& [id, font]: fonts)
+		font.update();
+}
+
 }
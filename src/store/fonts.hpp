@@ -25,6 +25,10 @@ struct Fonts {
 	auto operator[](ID id) -> Font& { return fonts.at(id); }
 	auto operator[](ID id) const -> const Font& { return fonts.at(id); }
 
+	// Upload newly generated glyphs of all fonts. Call once per frame,
+	// before any text is drawn.
+	void update();
+
 	// Not moveable, not copyable
 	Fonts(Fonts const&) = delete;
 	auto operator=(Fonts const&) -> Fonts& = delete;
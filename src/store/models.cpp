@@ -2,267 +2,6 @@
 
 namespace minote {
 
-static constexpr auto syncMesh = array<ModelFlat::Vertex, 3> {{
-	{
-		.pos = {0.0f, 0.0f, 0.0f},
-		.color = {1.0f, 0.0f, 1.0f, 1.0f}
-	},
-	{
-		.pos = {1.0f, 0.0f, 0.0f},
-		.color = {1.0f, 0.0f, 1.0f, 1.0f}
-	},
-	{
-		.pos = {0.0f, 1.0f, 0.0f},
-		.color = {1.0f, 0.0f, 1.0f, 1.0f}
-	}
-}};
-
-static constexpr auto blockMesh = array<ModelPhong::Vertex, 18*3> {{
-/////////////////////////////////////////////
-// Top wall
-    {
-        .pos = {0.0f, 1.0f, -0.125f},
-        .color = {0.9f, 0.9f, 0.9f, 1.0f}
-    },
-    {
-        .pos = {1.0f, 1.0f, -0.125f},
-        .color = {0.9f, 0.9f, 0.9f, 1.0f}
-    },
-    {
-        .pos = {0.0f, 1.0f, -1.0f},
-        .color = {0.9f, 0.9f, 0.9f, 1.0f}
-    },
-/////////////////////////////////////////////
-    {
-        .pos = {1.0f, 1.0f, -0.125f},
-        .color = {0.9f, 0.9f, 0.9f, 1.0f}
-    },
-    {
-        .pos = {1.0f, 1.0f, -1.0f},
-        .color = {0.9f, 0.9f, 0.9f, 1.0f}
-    },
-    {
-        .pos = {0.0f, 1.0f, -1.0f},
-        .color = {0.9f, 0.9f, 0.9f, 1.0f}
-    },
-/////////////////////////////////////////////
-// Bottom wall
-    {
-        .pos = {1.0f, 0.0f, -0.125f},
-        .color = {0.9f, 0.9f, 0.9f, 1.0f}
-    },
-    {
-        .pos = {0.0f, 0.0f, -0.125f},
-        .color = {0.9f, 0.9f, 0.9f, 1.0f}
-    },
-    {
-        .pos = {0.0f, 0.0f, -1.0f},
-        .color = {0.9f, 0.9f, 0.9f, 1.0f}
-    },
-/////////////////////////////////////////////
-    {
-        .pos = {1.0f, 0.0f, -1.0f},
-        .color = {0.9f, 0.9f, 0.9f, 1.0f}
-    },
-    {
-        .pos = {1.0f, 0.0f, -0.125f},
-        .color = {0.9f, 0.9f, 0.9f, 1.0f}
-    },
-    {
-        .pos = {0.0f, 0.0f, -1.0f},
-        .color = {0.9f, 0.9f, 0.9f, 1.0f}
-    },
-/////////////////////////////////////////////
-// Left wall
-    {
-        .pos = {0.0f, 0.0f, -0.125f},
-        .color = {0.9f, 0.9f, 0.9f, 1.0f}
-    },
-    {
-        .pos = {0.0f, 1.0f, -0.125f},
-        .color = {0.9f, 0.9f, 0.9f, 1.0f}
-    },
-    {
-        .pos = {0.0f, 0.0f, -1.0f},
-        .color = {0.9f, 0.9f, 0.9f, 1.0f}
-    },
-/////////////////////////////////////////////
-    {
-        .pos = {0.0f, 1.0f, -0.125f},
-        .color = {0.9f, 0.9f, 0.9f, 1.0f}
-    },
-    {
-        .pos = {0.0f, 1.0f, -1.0f},
-        .color = {0.9f, 0.9f, 0.9f, 1.0f}
-    },
-    {
-        .pos = {0.0f, 0.0f, -1.0f},
-        .color = {0.9f, 0.9f, 0.9f, 1.0f}
-    },
-/////////////////////////////////////////////
-// Right wall
-    {
-        .pos = {1.0f, 1.0f, -0.125f},
-        .color = {0.9f, 0.9f, 0.9f, 1.0f}
-    },
-    {
-        .pos = {1.0f, 0.0f, -0.125f},
-        .color = {0.9f, 0.9f, 0.9f, 1.0f}
-    },
-    {
-        .pos = {1.0f, 0.0f, -1.0f},
-        .color = {0.9f, 0.9f, 0.9f, 1.0f}
-    },
-/////////////////////////////////////////////
-    {
-        .pos = {1.0f, 1.0f, -1.0f},
-        .color = {0.9f, 0.9f, 0.9f, 1.0f}
-    },
-    {
-        .pos = {1.0f, 1.0f, -0.125f},
-        .color = {0.9f, 0.9f, 0.9f, 1.0f}
-    },
-    {
-        .pos = {1.0f, 0.0f, -1.0f},
-        .color = {0.9f, 0.9f, 0.9f, 1.0f}
-    },
-/////////////////////////////////////////////
-// Top bevel
-    {
-        .pos = {0.125f, 0.875f, 0.0f},
-        .color = {0.9f, 0.9f, 0.9f, 1.0f}
-    },
-    {
-        .pos = {0.875f, 0.875f, 0.0f},
-        .color = {0.9f, 0.9f, 0.9f, 1.0f}
-    },
-    {
-        .pos = {0.0f, 1.0f, -0.125f},
-        .color = {0.9f, 0.9f, 0.9f, 1.0f}
-    },
-/////////////////////////////////////////////
-    {
-        .pos = {0.875f, 0.875f, 0.0f},
-        .color = {0.9f, 0.9f, 0.9f, 1.0f}
-    },
-    {
-        .pos = {1.0f, 1.0f, -0.125f},
-        .color = {0.9f, 0.9f, 0.9f, 1.0f}
-    },
-    {
-        .pos = {0.0f, 1.0f, -0.125f},
-        .color = {0.9f, 0.9f, 0.9f, 1.0f}
-    },
-/////////////////////////////////////////////
-// Bottom bevel
-    {
-        .pos = {0.875f, 0.125f, 0.0f},
-        .color = {0.9f, 0.9f, 0.9f, 1.0f}
-    },
-    {
-        .pos = {0.125f, 0.125f, 0.0f},
-        .color = {0.9f, 0.9f, 0.9f, 1.0f}
-    },
-    {
-        .pos = {0.0f, 0.0f, -0.125f},
-        .color = {0.9f, 0.9f, 0.9f, 1.0f}
-    },
-/////////////////////////////////////////////
-    {
-        .pos = {1.0f, 0.0f, -0.125f},
-        .color = {0.9f, 0.9f, 0.9f, 1.0f}
-    },
-    {
-        .pos = {0.875f, 0.125f, 0.0f},
-        .color = {0.9f, 0.9f, 0.9f, 1.0f}
-    },
-    {
-        .pos = {0.0f, 0.0f, -0.125f},
-        .color = {0.9f, 0.9f, 0.9f, 1.0f}
-    },
-/////////////////////////////////////////////
-// Left bevel
-    {
-        .pos = {0.0f, 0.0f, -0.125f},
-        .color = {0.9f, 0.9f, 0.9f, 1.0f}
-    },
-    {
-        .pos = {0.125f, 0.125f, 0.0f},
-        .color = {0.9f, 0.9f, 0.9f, 1.0f}
-    },
-    {
-        .pos = {0.0f, 1.0f, -0.125f},
-        .color = {0.9f, 0.9f, 0.9f, 1.0f}
-    },
-/////////////////////////////////////////////
-    {
-        .pos = {0.125f, 0.125f, 0.0f},
-        .color = {0.9f, 0.9f, 0.9f, 1.0f}
-    },
-    {
-        .pos = {0.125f, 0.875f, 0.0f},
-        .color = {0.9f, 0.9f, 0.9f, 1.0f}
-    },
-    {
-        .pos = {0.0f, 1.0f, -0.125f},
-        .color = {0.9f, 0.9f, 0.9f, 1.0f}
-    },
-/////////////////////////////////////////////
-// Right bevel
-    {
-        .pos = {0.875f, 0.125f, 0.0f},
-        .color = {0.9f, 0.9f, 0.9f, 1.0f}
-    },
-    {
-        .pos = {1.0f, 0.0f, -0.125f},
-        .color = {0.9f, 0.9f, 0.9f, 1.0f}
-    },
-    {
-        .pos = {1.0f, 1.0f, -0.125f},
-        .color = {0.9f, 0.9f, 0.9f, 1.0f}
-    },
-/////////////////////////////////////////////
-    {
-        .pos = {0.875f, 0.875f, 0.0f},
-        .color = {0.9f, 0.9f, 0.9f, 1.0f}
-    },
-    {
-        .pos = {0.875f, 0.125f, 0.0f},
-        .color = {0.9f, 0.9f, 0.9f, 1.0f}
-    },
-    {
-        .pos = {1.0f, 1.0f, -0.125f},
-        .color = {0.9f, 0.9f, 0.9f, 1.0f}
-    },
-/////////////////////////////////////////////
-// Center
-    {
-        .pos = {0.125f, 0.125f, 0.0f},
-        .color = {0.9f, 0.9f, 0.9f, 1.0f}
-    },
-    {
-        .pos = {0.875f, 0.125f, 0.0f},
-        .color = {0.9f, 0.9f, 0.9f, 1.0f}
-    },
-    {
-        .pos = {0.125f, 0.875f, 0.0f},
-        .color = {0.9f, 0.9f, 0.9f, 1.0f}
-    },
-/////////////////////////////////////////////
-    {
-        .pos = {0.125f, 0.875f, 0.0f},
-        .color = {0.9f, 0.9f, 0.9f, 1.0f}
-    },
-    {
-        .pos = {0.875f, 0.125f, 0.0f},
-        .color = {0.9f, 0.9f, 0.9f, 1.0f}
-    },
-    {
-        .pos = {0.875f, 0.875f, 0.0f},
-        .color = {0.9f, 0.9f, 0.9f, 1.0f}
-    }
-}};
-
 static constexpr ModelPhong::Material blockMaterial = {
 	.ambient = 0.2f,
 	.diffuse = 0.9f,
@@ -270,534 +9,13 @@ static constexpr ModelPhong::Material blockMaterial = {
 	.shine = 24.0f
 };
 
-static constexpr auto sceneMesh = array<ModelFlat::Vertex, 14*3> {{
-/////////////////////////////////////////////
-// Backplane
-	{
-		.pos = {-5.1f, -0.1f, -1.0f},
-		.color = {0.0f, 0.0f, 0.0f, 0.9f}
-	},
-	{
-		.pos = {5.1f, -0.1f, -1.0f},
-		.color = {0.0f, 0.0f, 0.0f, 0.9f}
-	},
-	{
-		.pos = {-5.1f, 20.1f,-1.0f},
-		.color = {0.0f, 0.0f, 0.0f, 0.9f}
-	},
-/////////////////////////////////////////////
-	{
-		.pos = {5.1f, -0.1f, -1.0f},
-		.color = {0.0f, 0.0f, 0.0f, 0.9f}
-	},
-	{
-		.pos = {5.1f, 20.1f, -1.0f},
-		.color = {0.0f, 0.0f, 0.0f, 0.9f}
-	},
-	{
-		.pos = {-5.1f, 20.1f, -1.0f},
-		.color = {0.0f, 0.0f, 0.0f, 0.9f}
-	},
-/////////////////////////////////////////////
-// Bottom wall
-	{
-		.pos = {-5.1f, -0.1f, 0.2f},
-		.color = {0.0f, 0.0f, 0.0f, 0.95f}
-	},
-	{
-		.pos = {5.1f, -0.1f, 0.2f},
-		.color = {0.0f, 0.0f, 0.0f, 0.95f}
-	},
-	{
-		.pos = {-5.1f, -0.1f, -1.0f},
-		.color = {0.0f, 0.0f, 0.0f, 0.95f}
-	},
-/////////////////////////////////////////////
-	{
-		.pos = {5.1f, -0.1f, 0.2f},
-		.color = {0.0f, 0.0f, 0.0f, 0.95f}
-	},
-	{
-		.pos = {5.1f, -0.1f, -1.0f},
-		.color = {0.0f, 0.0f, 0.0f, 0.95f}
-	},
-	{
-		.pos = {-5.1f, -0.1f, -1.0f},
-		.color = {0.0f, 0.0f, 0.0f, 0.95f}
-	},
-/////////////////////////////////////////////
-// Left wall
-	{
-		.pos = {-5.1f, -0.1f, 0.2f},
-		.color = {0.0f, 0.0f, 0.0f, 0.95f}
-	},
-	{
-		.pos = {-5.1f, -0.1f, -1.0f},
-		.color = {0.0f, 0.0f, 0.0f, 0.95f}
-	},
-	{
-		.pos = {-5.1f, 20.1f, 0.2f},
-		.color = {0.0f, 0.0f, 0.0f, 0.95f}
-	},
-/////////////////////////////////////////////
-	{
-		.pos = {-5.1f, -0.1f, -1.0f},
-		.color = {0.0f, 0.0f, 0.0f, 0.95f}
-	},
-	{
-		.pos = {-5.1f, 20.1f, -1.0f},
-		.color = {0.0f, 0.0f, 0.0f, 0.95f}
-	},
-	{
-		.pos = {-5.1f, 20.1f, 0.2f},
-		.color = {0.0f, 0.0f, 0.0f, 0.95f}
-	},
-/////////////////////////////////////////////
-// Right wall
-	{
-		.pos = {5.1f, -0.1f, -1.0f},
-		.color = {0.0f, 0.0f, 0.0f, 0.95f}
-	},
-	{
-		.pos = {5.1f, -0.1f, 0.2f},
-		.color = {0.0f, 0.0f, 0.0f, 0.95f}
-	},
-	{
-		.pos = {5.1f, 20.1f, 0.2f},
-		.color = {0.0f, 0.0f, 0.0f, 0.95f}
-	},
-/////////////////////////////////////////////
-	{
-		.pos = {5.1f, 20.1f, -1.0f},
-		.color = {0.0f, 0.0f, 0.0f, 0.95f}
-	},
-	{
-		.pos = {5.1f, -0.1f, -1.0f},
-		.color = {0.0f, 0.0f, 0.0f, 0.95f}
-	},
-	{
-		.pos = {5.1f, 20.1f, 0.2f},
-		.color = {0.0f, 0.0f, 0.0f, 0.95f}
-	},
-/////////////////////////////////////////////
-// Bottom wall highlight
-	{
-		.pos = {-5.2f, -0.2f, 0.2f},
-		.color = {1.0f, 1.0f, 1.0f, 1.0f}
-	},
-	{
-		.pos = {5.2f, -0.2f, 0.2f},
-		.color = {1.0f, 1.0f, 1.0f, 1.0f}
-	},
-	{
-		.pos = {-5.1f, -0.1f, 0.2f},
-		.color = {1.0f, 1.0f, 1.0f, 1.0f}
-	},
-/////////////////////////////////////////////
-	{
-		.pos = {5.2f, -0.2f, 0.2f},
-		.color = {1.0f, 1.0f, 1.0f, 1.0f}
-	},
-	{
-		.pos = {5.1f, -0.1f, 0.2f},
-		.color = {1.0f, 1.0f, 1.0f, 1.0f}
-	},
-	{
-		.pos = {-5.1f, -0.1f, 0.2f},
-		.color = {1.0f, 1.0f, 1.0f, 1.0f}
-	},
-/////////////////////////////////////////////
-// Left wall highlight
-	{
-		.pos = {-5.2f, -0.2f, 0.2f},
-		.color = {1.0f, 1.0f, 1.0f, 1.0f}
-	},
-	{
-		.pos = {-5.1f, -0.1f, 0.2f},
-		.color = {1.0f, 1.0f, 1.0f, 1.0f}
-	},
-	{
-		.pos = {-5.2f, 20.1f, 0.2f},
-		.color = {1.0f, 1.0f, 1.0f, 1.0f}
-	},
-/////////////////////////////////////////////
-	{
-		.pos = {-5.1f, -0.1f, 0.2f},
-		.color = {1.0f, 1.0f, 1.0f, 1.0f}
-	},
-	{
-		.pos = {-5.1f, 20.1f, 0.2f},
-		.color = {1.0f, 1.0f, 1.0f, 1.0f}
-	},
-	{
-		.pos = {-5.2f, 20.1f, 0.2f},
-		.color = {1.0f, 1.0f, 1.0f, 1.0f}
-	},
-/////////////////////////////////////////////
-// Right wall highlight
-	{
-		.pos = {5.1f, -0.1f, 0.2f},
-		.color = {1.0f, 1.0f, 1.0f, 1.0f}
-	},
-	{
-		.pos = {5.2f, -0.2f, 0.2f},
-		.color = {1.0f, 1.0f, 1.0f, 1.0f}
-	},
-	{
-		.pos = {5.2f, 20.1f, 0.2f},
-		.color = {1.0f, 1.0f, 1.0f, 1.0f}
-	},
-/////////////////////////////////////////////
-	{
-		.pos = {5.1f, 20.1f, 0.2f},
-		.color = {1.0f, 1.0f, 1.0f, 1.0f}
-	},
-	{
-		.pos = {5.1f, -0.1f, 0.2f},
-		.color = {1.0f, 1.0f, 1.0f, 1.0f}
-	},
-	{
-		.pos = {5.2f, 20.1f, 0.2f},
-		.color = {1.0f, 1.0f, 1.0f, 1.0f}
-	}
-}};
-
-static constexpr auto guideMesh = array<ModelFlat::Vertex, 20*3> {{
-/////////////////////////////////////////////
-// Column 1 guide
-	{
-		.pos = {-5.0f, -0.1f, -0.99f},
-		.color = {1.0f, 1.0f, 1.0f, 0.010f}
-	},
-	{
-		.pos = {-4.0f, -0.1f, -0.99f},
-		.color = {1.0f, 1.0f, 1.0f, 0.010f}
-	},
-	{
-		.pos = {-5.0f, 20.0f, -0.99f},
-		.color = {1.0f, 1.0f, 1.0f, 0.0f}
-	},
-/////////////////////////////////////////////
-	{
-		.pos = {-4.0f, -0.1f, -0.99f},
-		.color = {1.0f, 1.0f, 1.0f, 0.010f}
-	},
-	{
-		.pos = {-4.0f, 20.0f, -0.99f},
-		.color = {1.0f, 1.0f, 1.0f, 0.0f}
-	},
-	{
-		.pos = {-5.0f, 20.0f, -0.99f},
-		.color = {1.0f, 1.0f, 1.0f, 0.0f}
-	},
-/////////////////////////////////////////////
-// Column 2 guide
-	{
-		.pos = {-4.0f, -0.1f, -0.99f},
-		.color = {1.0f, 1.0f, 1.0f, 0.004f}
-	},
-	{
-		.pos = {-3.0f, -0.1f, -0.99f},
-		.color = {1.0f, 1.0f, 1.0f, 0.004f}
-	},
-	{
-		.pos = {-4.0f, 20.0f, -0.99f},
-		.color = {1.0f, 1.0f, 1.0f, 0.0f}
-	},
-/////////////////////////////////////////////
-	{
-		.pos = {-3.0f, -0.1f, -0.99f},
-		.color = {1.0f, 1.0f, 1.0f, 0.004f}
-	},
-	{
-		.pos = {-3.0f, 20.0f, -0.99f},
-		.color = {1.0f, 1.0f, 1.0f, 0.0f}
-	},
-	{
-		.pos = {-4.0f, 20.0f, -0.99f},
-		.color = {1.0f, 1.0f, 1.0f, 0.0f}
-	},
-/////////////////////////////////////////////
-// Column 3 guide
-	{
-		.pos = {-3.0f, -0.1f, -0.99f},
-		.color = {1.0f, 1.0f, 1.0f, 0.010f}
-	},
-	{
-		.pos = {-2.0f, -0.1f, -0.99f},
-		.color = {1.0f, 1.0f, 1.0f, 0.010f}
-	},
-	{
-		.pos = {-3.0f, 20.0f, -0.99f},
-		.color = {1.0f, 1.0f, 1.0f, 0.0f}
-	},
-/////////////////////////////////////////////
-	{
-		.pos = {-2.0f, -0.1f, -0.99f},
-		.color = {1.0f, 1.0f, 1.0f, 0.010f}
-	},
-	{
-		.pos = {-2.0f, 20.0f, -0.99f},
-		.color = {1.0f, 1.0f, 1.0f, 0.0f}
-	},
-	{
-		.pos = {-3.0f, 20.0f, -0.99f},
-		.color = {1.0f, 1.0f, 1.0f, 0.0f}
-	},
-/////////////////////////////////////////////
-// Column 4 guide
-	{
-		.pos = {-2.0f, -0.1f, -0.99f},
-		.color = {1.0f, 1.0f, 1.0f, 0.004f}
-	},
-	{
-		.pos = {-1.0f, -0.1f, -0.99f},
-		.color = {1.0f, 1.0f, 1.0f, 0.004f}
-	},
-	{
-		.pos = {-2.0f, 20.0f, -0.99f},
-		.color = {1.0f, 1.0f, 1.0f, 0.0f}
-	},
-/////////////////////////////////////////////
-	{
-		.pos = {-1.0f, -0.1f, -0.99f},
-		.color = {1.0f, 1.0f, 1.0f, 0.004f}
-	},
-	{
-		.pos = {-1.0f, 20.0f, -0.99f},
-		.color = {1.0f, 1.0f, 1.0f, 0.0f}
-	},
-	{
-		.pos = {-2.0f, 20.0f, -0.99f},
-		.color = {1.0f, 1.0f, 1.0f, 0.0f}
-	},
-/////////////////////////////////////////////
-// Column 5 guide
-	{
-		.pos = {-1.0f, -0.1f, -0.99f},
-		.color = {1.0f, 1.0f, 1.0f, 0.010f}
-	},
-	{
-		.pos = {0.0f, -0.1f, -0.99f},
-		.color = {1.0f, 1.0f, 1.0f, 0.010f}
-	},
-	{
-		.pos = {-1.0f, 20.0f, -0.99f},
-		.color = {1.0f, 1.0f, 1.0f, 0.0f}
-	},
-/////////////////////////////////////////////
-	{
-		.pos = {0.0f, -0.1f, -0.99f},
-		.color = {1.0f, 1.0f, 1.0f, 0.010f}
-	},
-	{
-		.pos = {0.0f, 20.0f, -0.99f},
-		.color = {1.0f, 1.0f, 1.0f, 0.0f}
-	},
-	{
-		.pos = {-1.0f, 20.0f, -0.99f},
-		.color = {1.0f, 1.0f, 1.0f, 0.0f}
-	},
-/////////////////////////////////////////////
-// Column 6 guide
-	{
-		.pos = {0.0f, -0.1f, -0.99f},
-		.color = {1.0f, 1.0f, 1.0f, 0.004f}
-	},
-	{
-		.pos = {1.0f, -0.1f, -0.99f},
-		.color = {1.0f, 1.0f, 1.0f, 0.004f}
-	},
-	{
-		.pos = {0.0f, 20.0f, -0.99f},
-		.color = {1.0f, 1.0f, 1.0f, 0.0f}
-	},
-/////////////////////////////////////////////
-	{
-		.pos = {1.0f, -0.1f, -0.99f},
-		.color = {1.0f, 1.0f, 1.0f, 0.004f}
-	},
-	{
-		.pos = {1.0f, 20.0f, -0.99f},
-		.color = {1.0f, 1.0f, 1.0f, 0.0f}
-	},
-	{
-		.pos = {0.0f, 20.0f, -0.99f},
-		.color = {1.0f, 1.0f, 1.0f, 0.0f}
-	},
-/////////////////////////////////////////////
-// Column 7 guide
-	{
-		.pos = {1.0f, -0.1f, -0.99f},
-		.color = {1.0f, 1.0f, 1.0f, 0.010f}
-	},
-	{
-		.pos = {2.0f, -0.1f, -0.99f},
-		.color = {1.0f, 1.0f, 1.0f, 0.010f}
-	},
-	{
-		.pos = {1.0f, 20.0f, -0.99f},
-		.color = {1.0f, 1.0f, 1.0f, 0.0f}
-	},
-/////////////////////////////////////////////
-	{
-		.pos = {2.0f, -0.1f, -0.99f},
-		.color = {1.0f, 1.0f, 1.0f, 0.010f}
-	},
-	{
-		.pos = {2.0f, 20.0f, -0.99f},
-		.color = {1.0f, 1.0f, 1.0f, 0.0f}
-	},
-	{
-		.pos = {1.0f, 20.0f, -0.99f},
-		.color = {1.0f, 1.0f, 1.0f, 0.0f}
-	},
-/////////////////////////////////////////////
-// Column 8 guide
-	{
-		.pos = {2.0f, -0.1f, -0.99f},
-		.color = {1.0f, 1.0f, 1.0f, 0.004f}
-	},
-	{
-		.pos = {3.0f, -0.1f, -0.99f},
-		.color = {1.0f, 1.0f, 1.0f, 0.004f}
-	},
-	{
-		.pos = {2.0f, 20.0f, -0.99f},
-		.color = {1.0f, 1.0f, 1.0f, 0.0f}
-	},
-/////////////////////////////////////////////
-	{
-		.pos = {3.0f, -0.1f, -0.99f},
-		.color = {1.0f, 1.0f, 1.0f, 0.004f}
-	},
-	{
-		.pos = {3.0f, 20.0f, -0.99f},
-		.color = {1.0f, 1.0f, 1.0f, 0.0f}
-	},
-	{
-		.pos = {2.0f, 20.0f, -0.99f},
-		.color = {1.0f, 1.0f, 1.0f, 0.0f}
-	},
-/////////////////////////////////////////////
-// Column 9 guide
-	{
-		.pos = {3.0f, -0.1f, -0.99f},
-		.color = {1.0f, 1.0f, 1.0f, 0.010f}
-	},
-	{
-		.pos = {4.0f, -0.1f, -0.99f},
-		.color = {1.0f, 1.0f, 1.0f, 0.010f}
-	},
-	{
-		.pos = {3.0f, 20.0f, -0.99f},
-		.color = {1.0f, 1.0f, 1.0f, 0.0f}
-	},
-/////////////////////////////////////////////
-	{
-		.pos = {4.0f, -0.1f, -0.99f},
-		.color = {1.0f, 1.0f, 1.0f, 0.010f}
-	},
-	{
-		.pos = {4.0f, 20.0f, -0.99f},
-		.color = {1.0f, 1.0f, 1.0f, 0.0f}
-	},
-	{
-		.pos = {3.0f, 20.0f, -0.99f},
-		.color = {1.0f, 1.0f, 1.0f, 0.0f}
-	},
-/////////////////////////////////////////////
-// Column 10 guide
-	{
-		.pos = {4.0f, -0.1f, -0.99f},
-		.color = {1.0f, 1.0f, 1.0f, 0.004f}
-	},
-	{
-		.pos = {5.0f, -0.1f, -0.99f},
-		.color = {1.0f, 1.0f, 1.0f, 0.004f}
-	},
-	{
-		.pos = {4.0f, 20.0f, -0.99f},
-		.color = {1.0f, 1.0f, 1.0f, 0.0f}
-	},
-/////////////////////////////////////////////
-	{
-		.pos = {5.0f, -0.1f, -0.99f},
-		.color = {1.0f, 1.0f, 1.0f, 0.004f}
-	},
-	{
-		.pos = {5.0f, 20.0f, -0.99f},
-		.color = {1.0f, 1.0f, 1.0f, 0.0f}
-	},
-	{
-		.pos = {4.0f, 20.0f, -0.99f},
-		.color = {1.0f, 1.0f, 1.0f, 0.0f}
-	}
-}};
-
-static constexpr auto borderMesh = array<ModelFlat::Vertex, 6> {{
-	{
-		.pos = {0.0f, 0.0f, 0.0f},
-		.color = {1.0f, 1.0f, 1.0f, 1.0f}
-	},
-	{
-		.pos = {1.0f, 0.0f, 0.0f},
-		.color = {1.0f, 1.0f, 1.0f, 1.0f}
-	},
-	{
-		.pos = {0.0f, 1.0f, 0.0f},
-		.color = {1.0f, 1.0f, 1.0f, 1.0f}
-	},
-/////////////////////////////////////////////
-	{
-		.pos = {1.0f, 0.0f, 0.0f},
-		.color = {1.0f, 1.0f, 1.0f, 1.0f}
-	},
-	{
-		.pos = {1.0f, 1.0f, 0.0f},
-		.color = {1.0f, 1.0f, 1.0f, 1.0f}
-	},
-	{
-		.pos = {0.0f, 1.0f, 0.0f},
-		.color = {1.0f, 1.0f, 1.0f, 1.0f}
-	}
-}};
-
-static constexpr auto particleMesh = array<ModelFlat::Vertex, 6> {{
-	{
-		.pos = {-1.0f, -0.0625f, 0.0f},
-		.color = {1.0f, 1.0f, 1.0f, 1.0f}
-	},
-	{
-		.pos = {0.0f, -0.0625f, 0.0f},
-		.color = {1.0f, 1.0f, 1.0f, 1.0f}
-	},
-	{
-		.pos = {-1.0f, 0.0625f, 0.0f},
-		.color = {1.0f, 1.0f, 1.0f, 1.0f}
-	},
-/////////////////////////////////////////////
-	{
-		.pos = {0.0f, -0.0625f, 0.0f},
-		.color = {1.0f, 1.0f, 1.0f, 1.0f}
-	},
-	{
-		.pos = {0.0f, 0.0625f, 0.0f},
-		.color = {1.0f, 1.0f, 1.0f, 1.0f}
-	},
-	{
-		.pos = {-1.0f, 0.0625f, 0.0f},
-		.color = {1.0f, 1.0f, 1.0f, 1.0f}
-	}
-}};
-
 Models::Models(Shaders& shaders) noexcept {
-	sync.create("sync", shaders, syncMesh);
-	block.create("block", shaders, blockMesh, blockMaterial, true);
-	field.create("scene", shaders, sceneMesh);
-	guide.create("guide", shaders, guideMesh);
-	border.create("border", shaders, borderMesh);
-	particle.create("particle", shaders, particleMesh);
+	sync.load("sync", shaders, "models/sync.mesh");
+	block.load("block", shaders, "models/block.mesh", blockMaterial);
+	field.load("scene", shaders, "models/scene.mesh");
+	guide.load("guide", shaders, "models/guide.mesh");
+	border.load("border", shaders, "models/border.mesh");
+	particle.load("particle", shaders, "models/particle.mesh");
 }
 
 Models::~Models() noexcept {
@@ -30,8 +30,8 @@ struct Models {
 	// A small particle piece to draw in great quantities
 	ModelFlat particle;
 
-	// Create all the models, uploading the vertex data to the GPU. After this call, they can
-	// be freely accessed and used for drawing.
+	// Load all the models from mesh files, uploading the vertex data to the GPU. After this
+	// call, they can be freely accessed and used for drawing.
 	explicit Models(Shaders& shaders) noexcept;
 
 	// Clean up all game models.
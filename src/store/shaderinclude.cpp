@@ -0,0 +1,72 @@
+#include "store/shaderinclude.hpp"
+
+#include <string_view>
+#include <stdexcept>
+#include <algorithm>
+#include <fstream>
+#include <cctype>
+
+namespace minote {
+
+using std::filesystem::path;
+
+// Remove leading and trailing whitespace.
+static auto trim(std::string_view str) -> std::string_view
+{
+	while (!str.empty() && std::isspace(static_cast<unsigned char>(str.front())))
+		str.remove_prefix(1);
+	while (!str.empty() && std::isspace(static_cast<unsigned char>(str.back())))
+		str.remove_suffix(1);
+	return str;
+}
+
+// Append a file to the source. stack holds the files being expanded,
+// outermost first.
+static void expandFile(path const& filename, ShaderSource& source, std::vector<path>& stack)
+{
+	auto const canonical = std::filesystem::weakly_canonical(filename);
+	if (std::find(stack.begin(), stack.end(), canonical) != stack.end())
+		throw std::runtime_error("Circular #include of " + filename.string());
+	if (std::find(source.files.begin(), source.files.end(), canonical) != source.files.end())
+		return;
+	source.files.push_back(canonical);
+	stack.push_back(canonical);
+
+	auto input = std::ifstream(canonical);
+	if (!input)
+		throw std::runtime_error("Could not open " + filename.string() + " for reading");
+
+	constexpr auto Directive = std::string_view("#include");
+	auto buffer = std::string();
+	while (std::getline(input, buffer)) {
+		auto const line = trim(buffer);
+		if (line.starts_with(Directive) && line.size() > Directive.size() &&
+			!std::isalnum(static_cast<unsigned char>(line[Directive.size()])) &&
+			line[Directive.size()] != '_') {
+			auto const open = line.find('"');
+			auto const close = line.rfind('"');
+			if (open == std::string_view::npos || close == open)
+				throw std::runtime_error("Syntax error in #include line of " +
+					filename.string() + ": " + std::string(line));
+			expandFile(canonical.parent_path() / line.substr(open + 1, close - open - 1),
+				source, stack);
+		} else {
+			source.text += line;
+			source.text += '\n';
+		}
+	}
+	if (input.bad())
+		throw std::runtime_error("Could not read " + filename.string());
+
+	stack.pop_back();
+}
+
+auto expandShaderIncludes(path const& filename) -> ShaderSource
+{
+	auto source = ShaderSource();
+	auto stack = std::vector<path>();
+	expandFile(filename, source, stack);
+	return source;
+}
+
+}
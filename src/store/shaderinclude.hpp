@@ -0,0 +1,33 @@
+// Minote - store/shaderinclude.hpp
+// Expansion of #include directives in GLSL sources, shared by the Preshade
+// tool and shader reloading. Includes are resolved relative to the including
+// file. GLSL files have no include guards, so each file is included only once;
+// files are told apart by canonical path, so that different spellings of
+// the same path count as one file. Circular includes are an error.
+// Only depends on the standard library, so that tools can use it.
+
+#pragma once
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace minote {
+
+struct ShaderSource {
+
+	// Expanded source. Every line has its leading and trailing whitespace
+	// removed, and ends with a newline
+	std::string text;
+
+	// Canonical path of every file read, in order of first inclusion
+	std::vector<std::filesystem::path> files;
+
+};
+
+// Read a GLSL source file, recursively expanding its #include directives.
+// Throws runtime_error if a file can't be read, if an #include is malformed,
+// or if files include each other in a cycle.
+auto expandShaderIncludes(std::filesystem::path const& filename) -> ShaderSource;
+
+}
@@ -1,103 +1,298 @@
 #include "store/shaders.hpp"
 
+#ifdef MINOTE_SHADER_RELOAD
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <poll.h>
+#endif //__linux__
+#include <algorithm>
+#include <cerrno>
+#include "store/shaderinclude.hpp"
+#include "base/array.hpp"
+#include "base/io.hpp"
+#endif //MINOTE_SHADER_RELOAD
+#include "base/log.hpp"
+
 namespace minote {
 
-static constexpr GLchar BlitVert[] = {
+// Directory of the program binary cache, relative to the working directory
+constexpr auto ShaderCachePath = "cache/shaders";
+
+static constexpr GLchar BlitVert[] =
 #include "blit.vert"
-	'\0'};
-static constexpr GLchar BlitFrag[] = {
+	;
+static constexpr GLchar BlitFrag[] =
 #include "blit.frag"
-	'\0'};
+	;
 
-static constexpr GLchar DelinearizeVert[] = {
+static constexpr GLchar DelinearizeVert[] =
 #include "delinearize.vert"
-	'\0'};
-static constexpr GLchar DelinearizeFrag[] = {
+	;
+static constexpr GLchar DelinearizeFrag[] =
 #include "delinearize.frag"
-	'\0'};
-
-static constexpr GLchar ThresholdVert[] = {
-#include "threshold.vert"
-	'\0'};
-static constexpr GLchar ThresholdFrag[] = {
-#include "threshold.frag"
-	'\0'};
-
-static constexpr GLchar BoxBlurVert[] = {
-#include "boxBlur.vert"
-	'\0'};
-static constexpr GLchar BoxBlurFrag[] = {
-#include "boxBlur.frag"
-	'\0'};
-
-static constexpr GLchar SmaaEdgeVert[] = {
+	;
+
+static constexpr GLchar BloomDownVert[] =
+#include "bloomDown.vert"
+	;
+static constexpr GLchar BloomDownFrag[] =
+#include "bloomDown.frag"
+	;
+
+static constexpr GLchar BloomUpVert[] =
+#include "bloomUp.vert"
+	;
+static constexpr GLchar BloomUpFrag[] =
+#include "bloomUp.frag"
+	;
+
+static constexpr GLchar SmaaSeparateVert[] =
+#include "smaaSeparate.vert"
+	;
+static constexpr GLchar SmaaSeparateFrag[] =
+#include "smaaSeparate.frag"
+	;
+
+static constexpr GLchar SmaaEdgeVert[] =
 #include "smaaEdge.vert"
-	'\0'};
-static constexpr GLchar SmaaEdgeFrag[] = {
+	;
+static constexpr GLchar SmaaEdgeFrag[] =
 #include "smaaEdge.frag"
-	'\0'};
+	;
 
-static constexpr GLchar SmaaBlendVert[] = {
+static constexpr GLchar SmaaBlendVert[] =
 #include "smaaBlend.vert"
-	'\0'};
-static constexpr GLchar SmaaBlendFrag[] = {
+	;
+static constexpr GLchar SmaaBlendFrag[] =
 #include "smaaBlend.frag"
-	'\0'};
+	;
 
-static constexpr GLchar SmaaNeighborVert[] = {
+static constexpr GLchar SmaaNeighborVert[] =
 #include "smaaNeighbor.vert"
-	'\0'};
-static constexpr GLchar SmaaNeighborFrag[] = {
+	;
+static constexpr GLchar SmaaNeighborFrag[] =
 #include "smaaNeighbor.frag"
-	'\0'};
+	;
 
-static constexpr GLchar FlatVert[] = {
+static constexpr GLchar FlatVert[] =
 #include "flat.vert"
-	'\0'};
-static constexpr GLchar FlatFrag[] = {
+	;
+static constexpr GLchar FlatFrag[] =
 #include "flat.frag"
-	'\0'};
+	;
 
-static constexpr GLchar PhongVert[] = {
+static constexpr GLchar PhongVert[] =
 #include "phong.vert"
-	'\0'};
-static constexpr GLchar PhongFrag[] = {
+	;
+static constexpr GLchar PhongFrag[] =
 #include "phong.frag"
-	'\0'};
+	;
 
-static constexpr GLchar NuklearVert[] = {
+static constexpr GLchar NuklearVert[] =
 #include "nuklear.vert"
-	'\0'};
-static constexpr GLchar NuklearFrag[] = {
+	;
+static constexpr GLchar NuklearFrag[] =
 #include "nuklear.frag"
-	'\0'};
+	;
 
-static constexpr GLchar MsdfVert[] = {
+static constexpr GLchar MsdfVert[] =
 #include "msdf.vert"
-	'\0'};
-static constexpr GLchar MsdfFrag[] = {
+	;
+static constexpr GLchar MsdfFrag[] =
 #include "msdf.frag"
-	'\0'};
+	;
+
+#ifdef MINOTE_SHADER_RELOAD
+
+struct Shaders::Reloader {
+
+	// A watched shader and the base name of its source files
+	struct Entry {
+
+		Shader* shader;
+		char const* name;
+
+	};
+
+	// A recompiled program, waiting to be swapped in
+	struct Result {
+
+		Shader* shader;
+		GLuint program;
+
+	};
+
+	Window& window;
+	vector<Entry> entries;
+
+	// Programs finished by the worker
+	mutex resultsLock;
+	vector<Result> results;
+
+	thread worker;
+
+	// Worker thread body. Waits for source changes and recompiles
+	// the affected shaders until stopped.
+	void run(stop_token stop);
+
+	// Compile a shader from its current sources. Returns 0 on failure.
+	auto rebuild(Entry const& entry) -> GLuint;
+
+};
+
+// Read a GLSL source file into a string, expanding #include directives
+// the same way Preshade does. Returns false if the source is unusable.
+static auto expandIncludes(path const& filename, string& out) -> bool try
+{
+	out = expandShaderIncludes(filename).text;
+	return true;
+} catch (runtime_error const& e) {
+	L.warn(R"(Failed to read shader source: {})", e.what());
+	return false;
+}
+
+auto Shaders::Reloader::rebuild(Entry const& entry) -> GLuint
+{
+	path const dir = MINOTE_GLSL_DIR;
+	string vertSrc;
+	string fragSrc;
+	if (!expandIncludes(dir / format("{}.vert.glsl", entry.name), vertSrc) ||
+		!expandIncludes(dir / format("{}.frag.glsl", entry.name), fragSrc))
+		return 0;
+
+	GLuint const program = Shader::compile(entry.name, vertSrc.c_str(), fragSrc.c_str());
+	if (program)
+		glFinish(); // Make the program complete before the game thread sees it
+	return program;
+}
+
+#ifdef __linux__
+
+void Shaders::Reloader::run(stop_token const stop)
+{
+	int const fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (fd == -1) {
+		L.error(R"(Failed to watch shader sources: {})", std::strerror(errno));
+		return;
+	}
+	defer { close(fd); };
+	if (inotify_add_watch(fd, MINOTE_GLSL_DIR, IN_CLOSE_WRITE | IN_MOVED_TO) == -1) {
+		L.error(R"(Failed to watch shader sources in "{}": {})",
+			MINOTE_GLSL_DIR, std::strerror(errno));
+		return;
+	}
+
+	window.activateSharedContext();
+	defer { window.deactivateSharedContext(); };
+
+	L.info(R"(Watching shader sources in "{}")", MINOTE_GLSL_DIR);
+
+	alignas(inotify_event) array<char, 4096> events = {};
+	vector<string> changed;
+	while (!stop.stop_requested()) {
+		pollfd pending = {.fd = fd, .events = POLLIN, .revents = 0};
+		if (poll(&pending, 1, 100) <= 0) continue;
+
+		// Editors often save a file in several steps, let them finish
+		sleepFor(50_ms);
+
+		changed.clear();
+		while (true) {
+			auto const length = read(fd, events.data(), events.size());
+			if (length <= 0) break;
+			for (ssize_t i = 0; i < length;) {
+				auto const* const event = reinterpret_cast<inotify_event const*>(&events[i]);
+				if (event->len)
+					changed.emplace_back(event->name);
+				i += sizeof(inotify_event) + event->len;
+			}
+		}
+
+		// An include file can be used by any shader
+		bool const includeChanged = std::any_of(changed.begin(), changed.end(),
+			[](auto const& name) { return name.ends_with(".glslh"); });
+
+		for (auto const& entry: entries) {
+			if (!includeChanged) {
+				auto const vertName = format("{}.vert.glsl", entry.name);
+				auto const fragName = format("{}.frag.glsl", entry.name);
+				if (std::find(changed.begin(), changed.end(), vertName) == changed.end() &&
+					std::find(changed.begin(), changed.end(), fragName) == changed.end())
+					continue;
+			}
+
+			L.info(R"(Recompiling shader "{}")", entry.name);
+			GLuint const program = rebuild(entry);
+			if (!program) continue;
+
+			scoped_lock lock{resultsLock};
+			results.push_back({entry.shader, program});
+		}
+	}
+}
+
+#else //__linux__
+
+void Shaders::Reloader::run(stop_token)
+{
+	L.warn("Shader reloading is only supported on Linux");
+}
+
+#endif //__linux__
+
+#endif //MINOTE_SHADER_RELOAD
 
 Shaders::Shaders() noexcept {
-	blit.create("blit", BlitVert, BlitFrag);
-	delinearize.create("delinearize", DelinearizeVert, DelinearizeFrag);
-	threshold.create("threshold", ThresholdVert, ThresholdFrag);
-	boxBlur.create("boxBlur", BoxBlurVert, BoxBlurFrag);
-	smaaEdge.create("smaaEdge", SmaaEdgeVert, SmaaEdgeFrag);
-	smaaBlend.create("smaaBlend", SmaaBlendVert, SmaaBlendFrag);
-	smaaNeighbor.create("smaaNeighbor", SmaaNeighborVert, SmaaNeighborFrag);
-	flat.create("flat", FlatVert, FlatFrag);
-	phong.create("phong", PhongVert, PhongFrag);
-	nuklear.create("nuklear", NuklearVert, NuklearFrag);
-	msdf.create("msdf", MsdfVert, MsdfFrag);
+	cache.create(ShaderCachePath);
+
+	// All programs are started before any is finished, so that the driver
+	// can compile them in parallel
+	blit.start("blit", BlitVert, BlitFrag, &cache);
+	delinearize.start("delinearize", DelinearizeVert, DelinearizeFrag, &cache);
+	bloomDown.start("bloomDown", BloomDownVert, BloomDownFrag, &cache);
+	bloomUp.start("bloomUp", BloomUpVert, BloomUpFrag, &cache);
+	smaaSeparate.start("smaaSeparate", SmaaSeparateVert, SmaaSeparateFrag, &cache);
+	smaaEdge.start("smaaEdge", SmaaEdgeVert, SmaaEdgeFrag, &cache);
+	smaaBlend.start("smaaBlend", SmaaBlendVert, SmaaBlendFrag, &cache);
+	smaaNeighbor.start("smaaNeighbor", SmaaNeighborVert, SmaaNeighborFrag, &cache);
+	flat.start("flat", FlatVert, FlatFrag, &cache);
+	phong.start("phong", PhongVert, PhongFrag, &cache);
+	nuklear.start("nuklear", NuklearVert, NuklearFrag, &cache);
+	msdf.start("msdf", MsdfVert, MsdfFrag, &cache);
+
+	blit.finish();
+	delinearize.finish();
+	bloomDown.finish();
+	bloomUp.finish();
+	smaaSeparate.finish();
+	smaaEdge.finish();
+	smaaBlend.finish();
+	smaaNeighbor.finish();
+	flat.finish();
+	phong.finish();
+	nuklear.finish();
+	msdf.finish();
+
+	L.info(R"(Shaders ready: {} loaded from cache, {} compiled)",
+		cache.hits, cache.misses);
 }
 
 Shaders::~Shaders() noexcept {
+	if (reloader) {
+		reloader->worker.request_stop();
+		reloader->worker.join();
+		for (auto const& result: reloader->results)
+			glDeleteProgram(result.program);
+		delete reloader;
+		reloader = nullptr;
+	}
+
 	blit.destroy();
 	delinearize.destroy();
-	threshold.destroy();
-	boxBlur.destroy();
+	bloomDown.destroy();
+	bloomUp.destroy();
+	smaaSeparate.destroy();
 	smaaEdge.destroy();
 	smaaBlend.destroy();
 	smaaNeighbor.destroy();
@@ -105,6 +300,63 @@ Shaders::~Shaders() noexcept {
 	phong.destroy();
 	nuklear.destroy();
 	msdf.destroy();
+	cache.destroy();
+}
+
+void Shaders::watch(Window& window)
+{
+#ifdef MINOTE_SHADER_RELOAD
+	if (reloader) return;
+	if (!window.hasSharedContext()) {
+		L.warn("Shader reloading requires a shared OpenGL context");
+		return;
+	}
+
+	reloader = new Reloader{.window = window};
+	reloader->entries = {
+		{&blit, "blit"},
+		{&delinearize, "delinearize"},
+		{&bloomDown, "bloomDown"},
+		{&bloomUp, "bloomUp"},
+		{&smaaSeparate, "smaaSeparate"},
+		{&smaaEdge, "smaaEdge"},
+		{&smaaBlend, "smaaBlend"},
+		{&smaaNeighbor, "smaaNeighbor"},
+		{&flat, "flat"},
+		{&phong, "phong"},
+		{&nuklear, "nuklear"},
+		{&msdf, "msdf"}};
+	reloader->worker = thread([r = reloader](stop_token stop) {
+		r->run(stop);
+	});
+#else //MINOTE_SHADER_RELOAD
+	(void)window;
+	L.warn("Shader reloading is not available in this build");
+#endif //MINOTE_SHADER_RELOAD
+}
+
+void Shaders::update()
+{
+#ifdef MINOTE_SHADER_RELOAD
+	if (!reloader) return;
+
+	vector<Reloader::Result> finished;
+	{
+		std::unique_lock lock{reloader->resultsLock, std::try_to_lock};
+		if (!lock.owns_lock()) return;
+		std::swap(finished, reloader->results);
+	}
+
+	for (auto const& result: finished) {
+		if (!result.shader->id) {
+			// Shaders that failed at startup have no uniforms to relocate
+			L.warn("Recompiled shader was not loaded at startup, restart to use it");
+			glDeleteProgram(result.program);
+			continue;
+		}
+		result.shader->replace(result.program);
+	}
+#endif //MINOTE_SHADER_RELOAD
 }
 
 }
@@ -5,6 +5,7 @@
 #pragma once
 
 #include "sys/opengl/shader.hpp"
+#include "sys/window.hpp"
 
 namespace minote {
 
@@ -25,55 +26,76 @@ struct Shaders {
 	struct Delinearize : Shader {
 
 		Sampler<Texture> image;
+		Uniform<vec2> imageScale;
 
 		void setLocations() override
 		{
 			image.setLocation(*this, "image");
+			imageScale.setLocation(*this, "imageScale");
 		}
 
 	} delinearize;
 
-	struct Threshold : Shader {
+	struct BloomDown : Shader {
 
 		Sampler<Texture> image;
+		Uniform<vec2> imageTexel;
+		Uniform<vec2> imageScale;
+		Uniform<i32> prefilter;
 		Uniform<float> threshold;
 		Uniform<float> softKnee;
-		Uniform<float> strength;
 
 		void setLocations() override
 		{
 			image.setLocation(*this, "image");
+			imageTexel.setLocation(*this, "imageTexel");
+			imageScale.setLocation(*this, "imageScale");
+			prefilter.setLocation(*this, "prefilter");
 			threshold.setLocation(*this, "threshold");
 			softKnee.setLocation(*this, "softKnee");
-			strength.setLocation(*this, "strength");
 		}
 
-	} threshold;
+	} bloomDown;
 
-	struct BoxBlur : Shader {
+	struct BloomUp : Shader {
 
 		Sampler<Texture> image;
-		Uniform<float> step;
 		Uniform<vec2> imageTexel;
+		Uniform<vec2> imageScale;
+		Uniform<float> strength;
 
 		void setLocations() override
 		{
 			image.setLocation(*this, "image");
-			step.setLocation(*this, "step");
 			imageTexel.setLocation(*this, "imageTexel");
+			imageScale.setLocation(*this, "imageScale");
+			strength.setLocation(*this, "strength");
+		}
+
+	} bloomUp;
+
+	struct SmaaSeparate : Shader {
+
+		Sampler<TextureMS> image;
+
+		void setLocations() override
+		{
+			image.setLocation(*this, "image");
 		}
 
-	} boxBlur;
+	} smaaSeparate;
 
 	struct SmaaEdge : Shader {
 
 		Sampler<Texture> image;
 		Uniform<vec4> screenSize;
+		Uniform<vec2> imageScale;
 
 		void setLocations() override
 		{
 			image.setLocation(*this, "image");
 			screenSize.setLocation(*this, "screenSize");
+			imageScale.setLocation(*this, "imageScale");
 		}
 
 	} smaaEdge;
@@ -85,6 +107,7 @@ struct Shaders {
 		Sampler<Texture> search;
 		Uniform<vec4> subsampleIndices;
 		Uniform<vec4> screenSize;
+		Uniform<vec2> imageScale;
 
 		void setLocations() override
 		{
@@ -93,6 +116,7 @@ struct Shaders {
 			search.setLocation(*this, "search", TextureUnit::_2);
 			subsampleIndices.setLocation(*this, "subsampleIndices");
 			screenSize.setLocation(*this, "screenSize");
+			imageScale.setLocation(*this, "imageScale");
 		}
 
 	} smaaBlend;
@@ -103,6 +127,7 @@ struct Shaders {
 		Sampler<Texture> blend;
 		Uniform<float> alpha;
 		Uniform<vec4> screenSize;
+		Uniform<vec2> imageScale;
 
 		void setLocations() override
 		{
@@ -110,6 +135,7 @@ struct Shaders {
 			blend.setLocation(*this, "blend", TextureUnit::_2);
 			alpha.setLocation(*this, "alpha");
 			screenSize.setLocation(*this, "screenSize");
+			imageScale.setLocation(*this, "imageScale");
 		}
 
 	} smaaNeighbor;
@@ -184,13 +210,38 @@ struct Shaders {
 
 	} msdf;
 
-	// Create the shader objects. The shaders are compiled and uniforms located.
-	// After this call, they are ready for use in any Draw.
+	// Cache of program binaries, to skip compilation on later launches
+	ProgramCache cache;
+
+	// Create the shader objects. The shaders are loaded from cache or compiled,
+	// and uniforms located. After this call, they are ready for use in any Draw.
 	Shaders() noexcept;
 
 	// Clean up all shader objects.
 	~Shaders() noexcept;
 
+	// Start recompiling shaders whenever their GLSL sources in the source tree
+	// change. Compilation happens on a worker thread, using the window's
+	// shared context (see Window::createSharedContext()). Only available
+	// in development builds on Linux.
+	void watch(Window& window);
+
+	// Swap in the shaders recompiled since the last call. Call once per frame,
+	// before any draws.
+	void update();
+
+	// Not moveable, not copyable
+	Shaders(Shaders const&) = delete;
+	auto operator=(Shaders const&) -> Shaders& = delete;
+	Shaders(Shaders&&) = delete;
+	auto operator=(Shaders&&) -> Shaders& = delete;
+
+private:
+
+	// Source watcher and compilation worker
+	struct Reloader;
+	Reloader* reloader = nullptr;
+
 };
 
 }
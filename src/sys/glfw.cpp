@@ -15,9 +15,16 @@
 
 namespace minote {
 
-Glfw::Glfw() {
+Glfw::Glfw(bool const _headless): headless{_headless} {
 	ASSERT(!exists);
 
+	if (headless) {
+#ifdef GLFW_PLATFORM_NULL
+		glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+#else //GLFW_PLATFORM_NULL
+		throw runtime_error{"Headless mode requires GLFW 3.4 or newer"};
+#endif //GLFW_PLATFORM_NULL
+	}
 	if (glfwInit() == GLFW_FALSE)
 		throw runtime_error{format("Failed to initialize GLFW: {}", getError())};
 #ifdef _WIN32
@@ -26,7 +33,7 @@ Glfw::Glfw() {
 #endif //_WIN32
 
 	exists = true;
-	L.info("GLFW initialized");
+	L.info("GLFW initialized{}", headless? " without a display" : "");
 }
 
 Glfw::~Glfw() {
@@ -56,6 +63,10 @@ auto Glfw::getTime() -> nsec {
 	return seconds(glfwGetTime());
 }
 
+void Glfw::setTime(nsec const time) {
+	glfwSetTime(f64(time.count()) / 1'000'000'000.0);
+}
+
 auto Glfw::getKeyName(Keycode const keycode, Scancode const scancode) const -> string_view {
 	return glfwGetKeyName(+keycode, +scancode)?: "Unknown";
 }
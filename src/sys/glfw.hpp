@@ -12,8 +12,13 @@ namespace minote {
 
 struct Glfw {
 
-	// Initialize the windowing system and relevant OS-specific bits.
-	Glfw();
+	// Whether there is no display. Windows are never shown, and their OpenGL
+	// contexts are rendered in software with OSMesa
+	bool headless;
+
+	// Initialize the windowing system and relevant OS-specific bits. If headless
+	// is true, no display server is used, which requires GLFW 3.4 or newer.
+	explicit Glfw(bool headless = false);
 
 	// Clean up the windowing system.
 	~Glfw();
@@ -33,6 +38,10 @@ struct Glfw {
 	[[nodiscard]]
 	static auto getTime() -> nsec;
 
+	// Change the current value of getTime(). Later values continue from it.
+	// This function can be used from any thread.
+	static void setTime(nsec time);
+
 	[[nodiscard]]
 	auto getKeyName(Keycode, Scancode) const -> string_view;
 
@@ -22,6 +22,7 @@ concept GLSLType =
 	std::is_same_v<T, ivec2> ||
 	std::is_same_v<T, ivec3> ||
 	std::is_same_v<T, ivec4> ||
+	std::is_same_v<T, mat3> ||
 	std::is_same_v<T, mat4>;
 
 // Common fields of all OpenGL object types
@@ -165,6 +165,10 @@ struct Draw {
 
 		// Stencil value to fill the DS buffer with
 		u8 stencil = 0;
+
+		// Whether to clear the whole attachments instead of the framebuffer's
+		// render area, for targets that are later sampled outside of it
+		bool wholeTarget = false;
 	} clearParams;
 
 	// Execute the drawcall according to values set in the object.
@@ -11,6 +11,13 @@ void Draw<T>::draw()
 		Framebuffer::unbind();
 
 	if (clearColor || clearDepthStencil) {
+		// Keep the clear within the framebuffer's render area
+		bool const partial = (framebuffer && framebuffer->area != uvec2{0, 0} &&
+			!clearParams.wholeTarget);
+		detail::state.setFeature(GL_SCISSOR_TEST, partial);
+		if (partial)
+			detail::state.setScissorBox({.pos = {0, 0}, .size = framebuffer->area});
+
 		GLbitfield mask = 0u;
 		if (clearColor) {
 			detail::state.setClearColor(clearParams.color);
@@ -70,10 +77,10 @@ void Draw<T>::draw()
 			}();
 			if (!instanced)
 				glDrawElements(+mode, vertices, indexType,
-					reinterpret_cast<GLvoid*>(offset * sizeof(u32)));
+					reinterpret_cast<GLvoid*>(offset * vertexarray->elementBits / 8));
 			else
 				glDrawElementsInstanced(+mode, vertices, indexType,
-					reinterpret_cast<GLvoid*>(offset * sizeof(u32)), instances);
+					reinterpret_cast<GLvoid*>(offset * vertexarray->elementBits / 8), instances);
 
 		}
 	}
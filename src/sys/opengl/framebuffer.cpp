@@ -29,6 +29,7 @@ void Framebuffer::destroy()
 	samples = Samples::None;
 	dirty = true;
 	attachments.fill(nullptr);
+	area = {0, 0};
 
 	L.debug(R"(Framebuffer "{}" destroyed)", name);
 	name = nullptr;
@@ -36,6 +37,9 @@ void Framebuffer::destroy()
 
 auto Framebuffer::size() -> uvec2
 {
+	if (area != uvec2{0, 0})
+		return area;
+
 	uvec2 result = {0, 0};
 	for (auto const* const attachment : attachments) {
 		if (!attachment) continue;
@@ -102,7 +106,8 @@ void Framebuffer::blit(Framebuffer& dst, Framebuffer const& src,
 	dst.bind();
 	glReadBuffer(+srcBuffer);
 
-	uvec2 const blitSize = src.attachments[detail::attachmentIndex(srcBuffer)]->size;
+	uvec2 const blitSize = (src.area != uvec2{0, 0})?
+		src.area : src.attachments[detail::attachmentIndex(srcBuffer)]->size;
 	GLbitfield const mask = GL_COLOR_BUFFER_BIT |
 		(depthStencil? GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT : 0);
 
@@ -48,6 +48,11 @@ struct Framebuffer : GLObject {
 	// with an internal method.
 	array<TextureBase const*, 17> attachments = {};
 
+	// Size of the region that is rendered into, starting at the bottom left
+	// corner. Set it if the attachments are larger than the image, such as
+	// with pooled render targets. {0, 0} means the whole attachment size
+	uvec2 area = {0, 0};
+
 	// Initialize the framebuffer object. The object has no textures attached
 	// by default, and needs to have at least one color attachment attached
 	// to satisfy completeness requirements.
@@ -85,7 +90,8 @@ struct Framebuffer : GLObject {
 	template<PixelFmt F>
 	void attach(RenderbufferMS<F>& r, Attachment attachment);
 
-	// Return the size of the biggest attached texture.
+	// Return the render area if set, or the size of the biggest attached
+	// texture otherwise.
 	auto size() -> uvec2;
 
 	// Bind this framebuffer to the OpenGL context, causing all future draw
@@ -102,8 +108,8 @@ struct Framebuffer : GLObject {
 	static void unbind();
 
 	// Copy the contents of one framebuffer to another. MSAA resolve
-	// is performed if required. If depthStencil is true, the DS contents
-	// will also be copied.
+	// is performed if required. The render area of src is copied if set.
+	// If depthStencil is true, the DS contents will also be copied.
 	static void blit(Framebuffer& dst, Framebuffer const& src,
 		Attachment srcBuffer = Attachment::Color0, bool depthStencil = false);
 
@@ -1,19 +1,193 @@
 #include "sys/opengl/shader.hpp"
 
+#include <filesystem>
+#include <cstring>
+#include <GLFW/glfw3.h>
+#include "base/array.hpp"
 #include "base/log.hpp"
 
 namespace minote {
 
-// Compile a single shader stage. Returns false if compilation failed.
-static auto compileShaderStage(GLuint const id, char const* const name,
-	char const* const source) -> bool
+// Constants and entry points of ARB_get_program_binary and
+// KHR_parallel_shader_compile. The glad loader is generated for core 3.3
+// without extensions, so these are loaded by hand.
+constexpr GLenum PROGRAM_BINARY_RETRIEVABLE_HINT = 0x8257;
+constexpr GLenum PROGRAM_BINARY_LENGTH = 0x8741;
+constexpr GLenum NUM_PROGRAM_BINARY_FORMATS = 0x87FE;
+
+using GetProgramBinaryProc = void (APIENTRYP)(GLuint program, GLsizei bufSize,
+	GLsizei* length, GLenum* binaryFormat, void* binary);
+using ProgramBinaryProc = void (APIENTRYP)(GLuint program, GLenum binaryFormat,
+	void const* binary, GLsizei length);
+using ProgramParameteriProc = void (APIENTRYP)(GLuint program, GLenum pname, GLint value);
+using MaxShaderCompilerThreadsProc = void (APIENTRYP)(GLuint count);
+
+static GetProgramBinaryProc getProgramBinary = nullptr;
+static ProgramBinaryProc programBinary = nullptr;
+static ProgramParameteriProc programParameteri = nullptr;
+
+// Header of a program cache file, followed by the program binary
+struct ProgramCacheHeader {
+
+	u32 magic;
+	u32 format; // Driver-specific binary format
+	u64 hash; // Hash of the source and driver strings
+	u32 length; // Length of the binary in bytes
+	u32 padding;
+
+};
+
+constexpr u32 ProgramCacheMagic = 0x50475250; // "PRGP"
+
+// Extend a 64-bit FNV-1a hash with a string.
+static auto hashString(u64 hash, string_view const str) -> u64
+{
+	for (char const ch: str) {
+		hash ^= u8(ch);
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+// Check if the current OpenGL context supports an extension.
+static auto hasExtension(char const* const ext) -> bool
+{
+	GLint count = 0;
+	glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+	for (GLint i = 0; i < count; i += 1) {
+		auto const* const name = reinterpret_cast<char const*>(glGetStringi(GL_EXTENSIONS, i));
+		if (name && std::strcmp(name, ext) == 0)
+			return true;
+	}
+	return false;
+}
+
+void ProgramCache::create(path const& _dir)
+{
+	auto const* const renderer = reinterpret_cast<char const*>(glGetString(GL_RENDERER));
+	auto const* const version = reinterpret_cast<char const*>(glGetString(GL_VERSION));
+	driverHash = hashString(14695981039346656037ull, renderer? renderer : "");
+	driverHash = hashString(driverHash, version? version : "");
+	hits = 0;
+	misses = 0;
+
+	// *** Parallel compilation ***
+
+	auto maxThreads = MaxShaderCompilerThreadsProc(nullptr);
+	if (hasExtension("GL_KHR_parallel_shader_compile"))
+		maxThreads = reinterpret_cast<MaxShaderCompilerThreadsProc>(
+			glfwGetProcAddress("glMaxShaderCompilerThreadsKHR"));
+	else if (hasExtension("GL_ARB_parallel_shader_compile"))
+		maxThreads = reinterpret_cast<MaxShaderCompilerThreadsProc>(
+			glfwGetProcAddress("glMaxShaderCompilerThreadsARB"));
+	if (maxThreads) {
+		maxThreads(0xFFFFFFFF); // Let the driver decide
+		parallel = true;
+	}
+
+	// *** Program binaries ***
+
+	if (!hasExtension("GL_ARB_get_program_binary")) {
+		L.info("Program binaries not supported, shader cache disabled");
+		return;
+	}
+	GLint formats = 0;
+	glGetIntegerv(NUM_PROGRAM_BINARY_FORMATS, &formats);
+	if (formats == 0) {
+		L.info("Driver has no program binary formats, shader cache disabled");
+		return;
+	}
+	getProgramBinary = reinterpret_cast<GetProgramBinaryProc>(
+		glfwGetProcAddress("glGetProgramBinary"));
+	programBinary = reinterpret_cast<ProgramBinaryProc>(
+		glfwGetProcAddress("glProgramBinary"));
+	programParameteri = reinterpret_cast<ProgramParameteriProc>(
+		glfwGetProcAddress("glProgramParameteri"));
+	if (!getProgramBinary || !programBinary || !programParameteri) {
+		L.warn("Failed to load program binary functions, shader cache disabled");
+		return;
+	}
+
+	std::error_code err;
+	std::filesystem::create_directories(_dir, err);
+	if (err) {
+		L.warn(R"(Failed to create shader cache directory "{}": {})",
+			_dir.string(), err.message());
+		return;
+	}
+
+	dir = _dir;
+	enabled = true;
+	L.info(R"(Shader cache opened at "{}"{})", dir.string(),
+		parallel? ", parallel compilation enabled" : "");
+}
+
+void ProgramCache::destroy()
+{
+	enabled = false;
+	parallel = false;
+	dir.clear();
+}
+
+// Load a program binary from the cache into an existing program object.
+// Returns false if the binary is missing, stale or rejected by the driver.
+static auto loadProgramBinary(GLuint const id, path const& file, u64 const hash) -> bool
+{
+	mapped_file cached;
+	try {
+		cached.open(file);
+	} catch (system_error const&) {
+		return false;
+	}
+	auto const bytes = cached.bytes();
+
+	ProgramCacheHeader header = {};
+	if (bytes.size() < sizeof(header))
+		return false;
+	std::memcpy(&header, bytes.data(), sizeof(header));
+	if (header.magic != ProgramCacheMagic || header.hash != hash ||
+		sizeof(header) + header.length > bytes.size())
+		return false;
+
+	programBinary(id, header.format, bytes.data() + sizeof(header), header.length);
+	GLint status = GL_FALSE;
+	glGetProgramiv(id, GL_LINK_STATUS, &status);
+	return status == GL_TRUE;
+}
+
+// Store a linked program's binary into the cache.
+static void storeProgramBinary(GLuint const id, path const& filePath, u64 const hash)
+{
+	GLint length = 0;
+	glGetProgramiv(id, PROGRAM_BINARY_LENGTH, &length);
+	if (length <= 0) return;
+
+	vector<u8> binary(length);
+	ProgramCacheHeader header = {
+		.magic = ProgramCacheMagic,
+		.hash = hash,
+		.length = u32(length)
+	};
+	getProgramBinary(id, length, nullptr, &header.format, binary.data());
+
+	try {
+		file out{filePath, "wb"};
+		if (std::fwrite(&header, sizeof(header), 1, out) != 1 ||
+			std::fwrite(binary.data(), binary.size(), 1, out) != 1)
+			throw system_error{errno, std::generic_category(),
+				format(R"(Failed to write "{}")", filePath.string())};
+		out.close();
+	} catch (system_error const& e) {
+		L.warn(R"(Failed to store program binary: {})", e.what());
+	}
+}
+
+// Check the compilation result of a shader stage. Returns false if
+// compilation failed.
+static auto checkShaderStage(GLuint const id, char const* const name) -> bool
 {
 	ASSERT(id);
 	ASSERT(name);
-	ASSERT(source);
-
-	glShaderSource(id, 1, &source, nullptr);
-	glCompileShader(id);
 
 	GLint const compileStatus = [=] {
 		GLint status = 0;
@@ -32,59 +206,125 @@ static auto compileShaderStage(GLuint const id, char const* const name,
 	return true;
 }
 
-void Shader::create(char const* _name, char const* vertSrc, char const* fragSrc)
+// Check the link result of a program. Returns false if linking failed.
+static auto checkProgramLink(GLuint const id, char const* const name) -> bool
+{
+	ASSERT(id);
+	ASSERT(name);
+
+	GLint const linkStatus = [=] {
+		GLint status = 0;
+		glGetProgramiv(id, GL_LINK_STATUS, &status);
+		return status;
+	}();
+	if (linkStatus == GL_FALSE) {
+		auto const infoLog = [=] {
+			array<GLchar, 2048> log = {};
+			glGetProgramInfoLog(id, log.size(), nullptr, log.data());
+			return log;
+		}();
+		L.error(R"(Shader "{}" failed to link: {})", name, infoLog.data());
+		return false;
+	}
+	return true;
+}
+
+void Shader::create(char const* _name, char const* vertSrc, char const* fragSrc,
+	ProgramCache* _cache)
+{
+	start(_name, vertSrc, fragSrc, _cache);
+	finish();
+}
+
+void Shader::start(char const* _name, char const* vertSrc, char const* fragSrc,
+	ProgramCache* _cache)
 {
 	ASSERT(!id);
 	ASSERT(_name);
 	ASSERT(vertSrc);
 	ASSERT(fragSrc);
 
-	GLuint const vert = glCreateShader(GL_VERTEX_SHADER);
+	name = _name;
+	cache = _cache;
+	cached = false;
+
+	id = glCreateProgram();
 #ifndef NDEBUG
-	glObjectLabel(GL_SHADER, vert, std::strlen(_name), _name);
+	glObjectLabel(GL_PROGRAM, id, std::strlen(_name), _name);
 #endif //NDEBUG
-	defer { glDeleteShader(vert); };
-	GLuint const frag = glCreateShader(GL_FRAGMENT_SHADER);
+
+	// *** Cached binary ***
+
+	if (cache && cache->enabled) {
+		sourceHash = hashString(cache->driverHash, vertSrc);
+		sourceHash = hashString(sourceHash, fragSrc);
+		if (loadProgramBinary(id, cache->dir / format("{}.bin", name), sourceHash)) {
+			cached = true;
+			return;
+		}
+		// A rejected binary can leave the program in an unspecified state
+		glDeleteProgram(id);
+		id = glCreateProgram();
 #ifndef NDEBUG
-	glObjectLabel(GL_SHADER, frag, std::strlen(_name), _name);
+		glObjectLabel(GL_PROGRAM, id, std::strlen(_name), _name);
 #endif //NDEBUG
-	defer { glDeleteShader(frag); };
+		programParameteri(id, PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+	}
 
-	if (!compileShaderStage(vert, _name, vertSrc))
-		return;
-	if (!compileShaderStage(frag, _name, fragSrc))
-		return;
+	// *** Compilation from source ***
 
-	id = glCreateProgram();
+	// Compile and link status are not queried here, so that the driver can
+	// process other programs in the meantime
+	vert = glCreateShader(GL_VERTEX_SHADER);
 #ifndef NDEBUG
-	glObjectLabel(GL_PROGRAM, id, std::strlen(_name), _name);
+	glObjectLabel(GL_SHADER, vert, std::strlen(_name), _name);
 #endif //NDEBUG
+	frag = glCreateShader(GL_FRAGMENT_SHADER);
+#ifndef NDEBUG
+	glObjectLabel(GL_SHADER, frag, std::strlen(_name), _name);
+#endif //NDEBUG
+
+	glShaderSource(vert, 1, &vertSrc, nullptr);
+	glCompileShader(vert);
+	glShaderSource(frag, 1, &fragSrc, nullptr);
+	glCompileShader(frag);
+
 	glAttachShader(id, vert);
 	glAttachShader(id, frag);
-
 	glLinkProgram(id);
-	GLint const linkStatus = [this] {
-		GLint status = 0;
-		glGetProgramiv(id, GL_LINK_STATUS, &status);
-		return status;
-	}();
-	if (linkStatus == GL_FALSE) {
-		auto const infoLog = [this] {
-			array<GLchar, 2048> log = {};
-			glGetProgramInfoLog(id, log.size(), nullptr, log.data());
-			return log;
-		}();
-		L.error(R"(Shader "{}" failed to link: {})", _name, infoLog.data());
-		glDeleteProgram(id);
-		id = 0;
-		return;
-	}
+}
 
-	name = _name;
+void Shader::finish()
+{
+	ASSERT(id);
+
+	if (cached) {
+		cache->hits += 1;
+	} else {
+		defer {
+			glDeleteShader(vert);
+			glDeleteShader(frag);
+			vert = 0;
+			frag = 0;
+		};
+		if (cache)
+			cache->misses += 1;
+
+		if (!checkShaderStage(vert, name) || !checkShaderStage(frag, name) ||
+			!checkProgramLink(id, name)) {
+			glDeleteProgram(id);
+			id = 0;
+			name = nullptr;
+			return;
+		}
+
+		if (cache && cache->enabled)
+			storeProgramBinary(id, cache->dir / format("{}.bin", name), sourceHash);
+	}
 
 	setLocations();
 
-	L.info(R"(Shader "{}" created)", name);
+	L.info(R"(Shader "{}" created{})", name, cached? " from cache" : "");
 }
 
 void Shader::destroy()
@@ -97,6 +337,54 @@ void Shader::destroy()
 	name = nullptr;
 }
 
+void Shader::replace(GLuint const program)
+{
+	ASSERT(id);
+	ASSERT(program);
+
+	// Unbind first, in case the old ID gets reused by the driver
+	detail::state.bindShader(0);
+	glDeleteProgram(id);
+	id = program;
+#ifndef NDEBUG
+	glObjectLabel(GL_PROGRAM, id, std::strlen(name), name);
+#endif //NDEBUG
+
+	setLocations();
+
+	L.info(R"(Shader "{}" replaced)", name);
+}
+
+auto Shader::compile(char const* const name, char const* vertSrc,
+	char const* fragSrc) -> GLuint
+{
+	ASSERT(name);
+	ASSERT(vertSrc);
+	ASSERT(fragSrc);
+
+	GLuint const vert = glCreateShader(GL_VERTEX_SHADER);
+	defer { glDeleteShader(vert); };
+	GLuint const frag = glCreateShader(GL_FRAGMENT_SHADER);
+	defer { glDeleteShader(frag); };
+
+	glShaderSource(vert, 1, &vertSrc, nullptr);
+	glCompileShader(vert);
+	glShaderSource(frag, 1, &fragSrc, nullptr);
+	glCompileShader(frag);
+	if (!checkShaderStage(vert, name) || !checkShaderStage(frag, name))
+		return 0;
+
+	GLuint const program = glCreateProgram();
+	glAttachShader(program, vert);
+	glAttachShader(program, frag);
+	glLinkProgram(program);
+	if (!checkProgramLink(program, name)) {
+		glDeleteProgram(program);
+		return 0;
+	}
+	return program;
+}
+
 void Shader::bind() const
 {
 	ASSERT(id);
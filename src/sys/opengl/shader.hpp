@@ -5,22 +5,86 @@
 
 #include "glad/glad.h"
 #include "base/util.hpp"
+#include "base/io.hpp"
 #include "sys/opengl/base.hpp"
 #include "sys/opengl/texture.hpp"
 #include "sys/opengl/buffer.hpp"
 
 namespace minote {
 
+// On-disk cache of linked program binaries. Programs are keyed by a hash
+// of their source and the driver's renderer and version strings, so a driver
+// update or a GPU change invalidates the cache automatically. If the driver
+// supports parallel shader compilation, it is enabled here as well.
+struct ProgramCache {
+
+	// Number of programs loaded from the cache and compiled from source
+	// since create()
+	u32 hits = 0;
+	u32 misses = 0;
+
+	// Open the cache in the specified directory, creating it if needed.
+	// If the driver cannot save program binaries, the cache stays disabled
+	// and all programs are compiled from source.
+	void create(path const& dir);
+
+	// Close the cache.
+	void destroy();
+
+	// True if program binaries can be loaded and stored.
+	[[nodiscard]]
+	auto isEnabled() const { return enabled; }
+
+	// True if the driver compiles programs in the background.
+	[[nodiscard]]
+	auto isParallel() const { return parallel; }
+
+private:
+
+	friend struct Shader;
+
+	path dir;
+	u64 driverHash = 0;
+	bool enabled = false;
+	bool parallel = false;
+
+};
+
 // Shader program wrapper. To use, derive from the struct and add the shader's
 // Uniforms and Samplers
 struct Shader : GLObject {
 
 	// Create, compile and link the shader program from source strings.
-	void create(char const* name, char const* vertSrc, char const* fragSrc);
+	// If a cache is provided, the program binary is loaded from it if possible,
+	// and stored into it otherwise.
+	void create(char const* name, char const* vertSrc, char const* fragSrc,
+		ProgramCache* cache = nullptr);
+
+	// First half of create(). The program is retrieved from the cache or
+	// submitted for compilation, without waiting for the result. Start all
+	// programs first and then finish() them to let the driver compile them
+	// in parallel.
+	void start(char const* name, char const* vertSrc, char const* fragSrc,
+		ProgramCache* cache = nullptr);
+
+	// Second half of create(). Wait for compilation to finish, report errors
+	// and store the binary into the cache.
+	void finish();
 
 	// Destroy the shader program to free the resources.
 	void destroy();
 
+	// Replace the program with a different, already linked one, and locate
+	// Uniforms and Samplers again. The previous program is destroyed, and
+	// cached uniform values are reset.
+	void replace(GLuint program);
+
+	// Compile and link a standalone program, waiting for the result. Returns
+	// the program ID, or 0 on failure. Used to build a program without
+	// touching any Shader, such as on a worker thread.
+	[[nodiscard]]
+	static auto compile(char const* name, char const* vertSrc, char const* fragSrc) -> GLuint;
+
 	// Bind the shader program to OpenGL state, causing all future draws
 	// to invoke this shader.
 	void bind() const;
@@ -29,6 +93,15 @@ struct Shader : GLObject {
 	// Uniforms and Samplers with setLocation() calls.
 	virtual void setLocations() = 0;
 
+private:
+
+	// State of a program between start() and finish()
+	GLuint vert = 0;
+	GLuint frag = 0;
+	ProgramCache* cache = nullptr;
+	u64 sourceHash = 0;
+	bool cached = false;
+
 };
 
 // Any type that is a Shader
@@ -53,6 +126,8 @@ struct Uniform {
 
 	// Initialize the uniform from a compiled shader. If the uniform location
 	// is not found, the error is logged and all later use will silently fail.
+	// The cached value is reset, since a newly linked program starts out
+	// with all uniforms zeroed.
 	void setLocation(Shader const& shader, char const* name);
 
 	// Set the uniform to a new value.
@@ -12,6 +12,7 @@ void Uniform<T>::setLocation(Shader const& shader, char const* const name)
 
 	location = glGetUniformLocation(shader.id, name);
 	shaderId = shader.id;
+	value = {};
 
 	if (location == -1)
 		L.warn(R"(Failed to get location for uniform "{}")", name);
@@ -39,6 +40,8 @@ void Uniform<T>::set(Type const _value)
 		glUniform3i(location, _value.x, _value.y, _value.z);
 	else if constexpr (std::is_same_v<Type, ivec4>)
 		glUniform4i(location, _value.x, _value.y, _value.z, _value.w);
+	else if constexpr (std::is_same_v<Type, mat3>)
+		glUniformMatrix3fv(location, 1, false, value_ptr(_value));
 	else if constexpr (std::is_same_v<Type, mat4>)
 		glUniformMatrix4fv(location, 1, false, value_ptr(_value));
 	else
@@ -145,6 +145,9 @@ void GLState::bindVertexArray(GLuint const id)
 
 	glBindVertexArray(id);
 	vertexarray = id;
+	// The element buffer binding is part of VAO state; make sure the next
+	// bindBuffer() call is not skipped
+	elementbuffer = 0;
 }
 
 void GLState::setTextureUnit(GLenum const unit)
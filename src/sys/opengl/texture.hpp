@@ -35,6 +35,7 @@ enum struct PixelFmt : GLint {
 	R_f16 = GL_R16F,
 	RG_f16 = GL_RG16F,
 	RGBA_f16 = GL_RGBA16F,
+	RGB_f11f11f10 = GL_R11F_G11F_B10F,
 	DepthStencil = GL_DEPTH24_STENCIL8
 };
 
@@ -107,6 +108,13 @@ struct Texture : TextureBase {
 	template<UploadFmt T>
 	void upload(span<T const> data, int channels = 0);
 
+	// Upload pixel data to a rectangular region of the texture storage,
+	// leaving the rest of the contents intact. Data is tightly packed rows
+	// of regionSize.x pixels. Channels are detected the same way as above.
+	template<UploadFmt T>
+	void upload(span<T const> data, uvec2 offset, uvec2 regionSize,
+		int channels = 0);
+
 	// Bind the texture to the specified texture unit. This allows it to be used
 	// in a shader for reading and/or writing. Unit None binds to the previously
 	// selected unit.
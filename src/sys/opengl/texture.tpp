@@ -71,10 +71,19 @@ void Texture<F>::resize(uvec2 const _size)
 
 template<PixelFmt F>
 template<UploadFmt T>
-void Texture<F>::upload(span<T const> const data, int channels)
+void Texture<F>::upload(span<T const> const data, int const channels)
+{
+	upload(data, {0, 0}, size, channels);
+}
+
+template<PixelFmt F>
+template<UploadFmt T>
+void Texture<F>::upload(span<T const> const data, uvec2 const offset,
+	uvec2 const regionSize, int channels)
 {
 	ASSERT(id);
 	ASSERT(size.x > 0 && size.y > 0);
+	ASSERT(offset.x + regionSize.x <= size.x && offset.y + regionSize.y <= size.y);
 	ASSERT(Format != PixelFmt::DepthStencil);
 
 	if (!channels) {
@@ -100,11 +109,14 @@ void Texture<F>::upload(span<T const> const data, int channels)
 			return GL_NONE;
 		}
 	}();
-	ASSERT(data.size_bytes() == size.x * size.y * channels);
+	ASSERT(data.size_bytes() == regionSize.x * regionSize.y * channels);
 
 	bind();
-	glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, size.x, size.y,
+	// Rows of odd-sized regions are not 4-byte aligned
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glTexSubImage2D(GL_TEXTURE_2D, 0, offset.x, offset.y, regionSize.x, regionSize.y,
 		glchannels, GL_UNSIGNED_BYTE, data.data());
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
 }
 
 template<PixelFmt F>
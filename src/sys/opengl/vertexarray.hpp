@@ -29,17 +29,26 @@ struct VertexArray : GLObject {
 
 	// Set an attribute to a VBO pointer. The VBO must be storing a GLSL type.
 	// Set instanced to true to advance the pointer per instance instead of
-	// per vertex. mat4 attributes take up 4 indexes, from index to index+3.
+	// per vertex. Matrix attributes take up an index per column, such as
+	// index to index+3 for mat4.
 	template<GLSLType T>
 	void setAttribute(GLuint index, VertexBuffer<T>& buffer, bool instanced = false);
 
 	// Set an attribute to a VBO field pointer. The VBO must be storing a struct
 	// of GLSL types. Set instanced to true to advance the pointer per instance
-	// instead of per vertex. mat4 attributes take up 4 indexes,
-	// from index to index+3.
+	// instead of per vertex. Matrix attributes take up an index per column,
+	// such as index to index+3 for mat4.
 	template<copy_constructible T, GLSLType U>
 	void setAttribute(GLuint index, VertexBuffer<T>& buffer, U T::*field, bool instanced = false);
 
+	// Set an attribute to a VBO field pointer holding packed data, which is
+	// converted to floats for the shader. type is the OpenGL type of the
+	// field's components, such as GL_HALF_FLOAT or GL_UNSIGNED_BYTE. If
+	// normalized is true, integers are mapped to the [0, 1] or [-1, 1] range.
+	template<copy_constructible T, typename U>
+	void setAttribute(GLuint index, VertexBuffer<T>& buffer, U T::*field,
+		GLint components, GLenum type, bool normalized, bool instanced = false);
+
 	// Set the element buffer binding.
 	template<ElementType T>
 	void setElements(ElementBuffer<T>& buffer);
@@ -20,7 +20,8 @@ auto setVaoAttribute(VertexArray& vao, GLuint const index,
 			return 2;
 		if constexpr (std::is_same_v<Component, vec3> ||
 			std::is_same_v<Component, ivec3> ||
-			std::is_same_v<Component, uvec3>)
+			std::is_same_v<Component, uvec3> ||
+			std::is_same_v<Component, mat3>)
 			return 3;
 		if constexpr (std::is_same_v<Component, vec4> ||
 			std::is_same_v<Component, ivec4> ||
@@ -34,6 +35,7 @@ auto setVaoAttribute(VertexArray& vao, GLuint const index,
 			std::is_same_v<Component, vec2> ||
 			std::is_same_v<Component, vec3> ||
 			std::is_same_v<Component, vec4> ||
+			std::is_same_v<Component, mat3> ||
 			std::is_same_v<Component, mat4>)
 			return GL_FLOAT;
 		if constexpr (std::is_same_v<Component, u32> ||
@@ -52,13 +54,14 @@ auto setVaoAttribute(VertexArray& vao, GLuint const index,
 	vao.bind();
 	buffer.bind();
 	if constexpr (type == GL_FLOAT) {
-		if constexpr (std::is_same_v<Component, mat4>) {
+		if constexpr (std::is_same_v<Component, mat3> ||
+			std::is_same_v<Component, mat4>) {
 
-			// Matrix version
-			for (GLuint i = 0; i < 4; i += 1) {
+			// Matrix version, one attribute per column
+			for (GLuint i = 0; i < GLuint(components); i += 1) {
 				glEnableVertexAttribArray(index + i);
-				glVertexAttribPointer(index + i, components, type, GL_FALSE,
-					sizeof(T), reinterpret_cast<void*>(offset + sizeof(vec4) * i));
+				glVertexAttribPointer(index + i, components, type, GL_FALSE, sizeof(T),
+					reinterpret_cast<void*>(offset + sizeof(typename Component::col_type) * i));
 				if (instanced)
 					glVertexAttribDivisor(index + i, 1);
 				vao.attributes[index + i] = true;
@@ -98,6 +101,8 @@ void VertexArray::setAttribute(GLuint const index, VertexBuffer<T>& buffer,
 	bool const instanced)
 {
 	ASSERT(index > 0 || index < attributes.size());
+	if constexpr (std::is_same_v<T, mat3>)
+		ASSERT (index + 2 < attributes.size());
 	if constexpr (std::is_same_v<T, mat4>)
 		ASSERT (index + 3 < attributes.size());
 	ASSERT(id);
@@ -110,6 +115,8 @@ void VertexArray::setAttribute(GLuint const index, VertexBuffer<T>& buffer,
 	U T::*field, bool const instanced)
 {
 	ASSERT(index > 0 || index < attributes.size());
+	if constexpr (std::is_same_v<U, mat3>)
+		ASSERT (index + 2 < attributes.size());
 	if constexpr (std::is_same_v<U, mat4>)
 		ASSERT (index + 3 < attributes.size());
 	ASSERT(id);
@@ -118,6 +125,27 @@ void VertexArray::setAttribute(GLuint const index, VertexBuffer<T>& buffer,
 		instanced);
 }
 
+template<copy_constructible T, typename U>
+void VertexArray::setAttribute(GLuint const index, VertexBuffer<T>& buffer,
+	U T::*field, GLint const components, GLenum const type,
+	bool const normalized, bool const instanced)
+{
+	ASSERT(index < attributes.size());
+	ASSERT(id);
+
+	bind();
+	buffer.bind();
+	glEnableVertexAttribArray(index);
+	glVertexAttribPointer(index, components, type, normalized, sizeof(T),
+		reinterpret_cast<void*>(offset_of(field)));
+	if (instanced)
+		glVertexAttribDivisor(index, 1);
+	attributes[index] = true;
+
+	L.debug(R"(Buffer "{}" bound to attribute {} of VAO "{}")",
+		buffer.name, index, name);
+}
+
 template<ElementType T>
 void VertexArray::setElements(ElementBuffer<T>& buffer)
 {
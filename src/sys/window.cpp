@@ -39,7 +39,7 @@ void Window::keyCallback(GLFWwindow* const handle,
 	try {
 		window.inputs.push_back(input);
 	} catch (...) {
-		L.warn(R"(Window "{}" input queue full, key "{}" {} event dropped)",
+		L.warn(R"(Window "{}" input queue full, key "{}" {} event dropped)"_fmt,
 			window.title(), name, state == State::Pressed? "press" : "release");
 	}
 }
@@ -52,7 +52,7 @@ void Window::framebufferResizeCallback(GLFWwindow* const handle, int const width
 
 	uvec2 const newSize{width, height};
 	window.m_size = newSize;
-	L.info(R"(Window "{}" resized to {})", window.title(), newSize);
+	L.info(R"(Window "{}" resized to {}x{})"_fmt, window.title(), width, height);
 }
 
 // Function to run when the window is rescaled. This might happen when dragging
@@ -68,7 +68,8 @@ void Window::windowScaleCallback(GLFWwindow* const handle, float const xScale, f
 	L.info(R"(Window "{}" DPI scaling changed to {})", window.title(), xScale);
 }
 
-Window::Window(Glfw const& _glfw, string_view _title, bool const fullscreen, uvec2 _size):
+Window::Window(Glfw const& _glfw, string_view _title, bool const fullscreen, uvec2 _size,
+	bool const visible):
 	glfw{_glfw}, m_title{_title}, isContextActive{false} {
 	ASSERT(_size.x > 0 && _size.y > 0);
 
@@ -87,6 +88,9 @@ Window::Window(Glfw const& _glfw, string_view _title, bool const fullscreen, uve
 	glfwWindowHint(GLFW_DEPTH_BITS, 0); // Handled by an internal FB
 	glfwWindowHint(GLFW_STENCIL_BITS, 0); // As above
 	glfwWindowHint(GLFW_SCALE_TO_MONITOR, GLFW_TRUE); // Declare DPI awareness
+	glfwWindowHint(GLFW_VISIBLE, visible? GLFW_TRUE : GLFW_FALSE);
+	if (glfw.headless)
+		glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_OSMESA_CONTEXT_API);
 
 	// *** Create the window handle ***
 
@@ -135,6 +139,8 @@ Window::Window(Glfw const& _glfw, string_view _title, bool const fullscreen, uve
 Window::~Window() {
 	ASSERT(!isContextActive);
 
+	if (sharedHandle)
+		glfwDestroyWindow(sharedHandle);
 	glfwDestroyWindow(handle);
 
 	L.info(R"(Window "{}" closed)", title());
@@ -180,6 +186,35 @@ void Window::deactivateContext() {
 	L.debug(R"(Window "{}" OpenGL context deactivated)", title());
 }
 
+void Window::createSharedContext() {
+	if (sharedHandle) return;
+
+	// Context hints are still the same as for the main window
+	glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+	sharedHandle = glfwCreateWindow(1, 1, m_title.c_str(), nullptr, handle);
+	glfwWindowHint(GLFW_VISIBLE, GLFW_TRUE);
+	if (!sharedHandle)
+		throw runtime_error{format(R"(Failed to create shared context for window "{}": {})", title(), Glfw::getError())};
+
+	L.debug(R"(Window "{}" shared OpenGL context created)", title());
+}
+
+void Window::activateSharedContext() {
+	ASSERT(sharedHandle);
+
+	glfwMakeContextCurrent(sharedHandle);
+
+	L.debug(R"(Window "{}" shared OpenGL context activated)", title());
+}
+
+void Window::deactivateSharedContext() {
+	ASSERT(sharedHandle);
+
+	glfwMakeContextCurrent(nullptr);
+
+	L.debug(R"(Window "{}" shared OpenGL context deactivated)", title());
+}
+
 void Window::popInput() {
 	scoped_lock const lock{inputsMutex};
 	if (!inputs.empty())
@@ -41,8 +41,10 @@ struct Window {
 
 	// Open a window with specified parameters on the screen. The OpenGL context is
 	// not activated by default. Size of the window is in logical units. If fullscreen is true,
-	// size is ignored and the window is created at desktop resolution.
-	Window(Glfw const& glfw, string_view title, bool fullscreen = false, uvec2 size = {1280, 720});
+	// size is ignored and the window is created at desktop resolution. A window that isn't
+	// visible is never shown, and is only useful for its OpenGL context.
+	Window(Glfw const& glfw, string_view title, bool fullscreen = false, uvec2 size = {1280, 720},
+		bool visible = true);
 
 	// Close the window. The OpenGL context must be already deactivated.
 	~Window();
@@ -80,6 +82,27 @@ struct Window {
 	// activateContext() call.
 	void deactivateContext();
 
+	// Create a hidden OpenGL context that shares objects with the window's context,
+	// so that a worker thread can create shaders, textures and buffers for it.
+	// Does nothing if the shared context already exists.
+	// This function must be used on the main thread.
+	void createSharedContext();
+
+	// Activate the shared OpenGL context on current thread. createSharedContext() must
+	// have been called first. Objects created with it need to be finished (glFinish())
+	// before they are used by the window's context.
+	// This function can be used from any thread.
+	void activateSharedContext();
+
+	// Deactivate the shared OpenGL context on current thread.
+	// This function must be used on the same thread as the previous
+	// activateSharedContext() call.
+	void deactivateSharedContext();
+
+	// Whether createSharedContext() has been called.
+	[[nodiscard]]
+	auto hasSharedContext() const -> bool { return sharedHandle; }
+
 	// Return the oldest keyboard input from the window's input queue. If the queue is empty,
 	// nullopt is returned instead.
 	// This function can be used from any thread.
@@ -106,6 +129,9 @@ private:
 
 	mutable mutex handleMutex;
 
+	// Hidden window holding the shared context, if created
+	GLFWwindow* sharedHandle{nullptr};
+
 	// Parent library instance
 	Glfw const& glfw;
 
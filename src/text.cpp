@@ -7,6 +7,7 @@
 
 #include <stdarg.h>
 #include <stdio.h>
+#include <deque>
 #include "sys/opengl/vertexarray.hpp"
 #include "sys/opengl/texture.hpp"
 #include "sys/opengl/shader.hpp"
@@ -28,15 +29,20 @@ struct MsdfGlyph {
 	int transformIndex; ///< Index of the string transform from the "transforms" buffer texture
 };
 
-static constexpr size_t MaxGlyphs{1024};
-static constexpr size_t MaxStrings{64};
+/// All glyphs queued this frame that sample from the same atlas
+struct MsdfBatch {
+	Texture<PixelFmt::RGBA_u8>* atlas; ///< Atlas used by all glyphs of the batch
+	VertexArray vao; ///< Glyph instance layout
+	VertexBuffer<MsdfGlyph> vbo; ///< GPU copy of #glyphs
+	vector<MsdfGlyph> glyphs; ///< Glyph instances, cleared every frame
+};
 
-static VertexArray msdfVao = {};
-static VertexBuffer<MsdfGlyph> msdfGlyphsVbo;
-static svector<MsdfGlyph, MaxGlyphs> msdfGlyphs;
+/// One batch per atlas seen so far. Batches persist between frames so that
+/// their GL objects and vector capacity are reused. A deque, because GL objects
+/// must not be relocated while they are alive.
+static std::deque<MsdfBatch> msdfBatches;
 static BufferTexture<mat4> msdfTransformsTex = {};
-static svector<mat4, MaxStrings> msdfTransforms;
-static Font* msdfFont = nullptr;
+static vector<mat4> msdfTransforms; ///< Shared by all batches
 
 static Draw<Shaders::Msdf> msdf = {
 	.mode = DrawMode::TriangleStrip,
@@ -48,6 +54,28 @@ static Draw<Shaders::Msdf> msdf = {
 
 static bool initialized = false;
 
+/**
+ * Find the batch drawing with a given atlas, creating it on first use.
+ * @param atlas Atlas texture to look up
+ * @return Batch that glyphs using the atlas can be appended to
+ */
+static auto msdfBatchFor(Texture<PixelFmt::RGBA_u8>& atlas) -> MsdfBatch&
+{
+	for (auto& batch: msdfBatches)
+		if (batch.atlas == &atlas) return batch;
+
+	auto& batch = msdfBatches.emplace_back();
+	batch.atlas = &atlas;
+	batch.vbo.create("msdfGlyphVbo", true);
+	batch.vao.create("msdfVao");
+	batch.vao.setAttribute(0, batch.vbo, &MsdfGlyph::position, true);
+	batch.vao.setAttribute(1, batch.vbo, &MsdfGlyph::size, true);
+	batch.vao.setAttribute(2, batch.vbo, &MsdfGlyph::texBounds, true);
+	batch.vao.setAttribute(3, batch.vbo, &MsdfGlyph::color, true);
+	batch.vao.setAttribute(4, batch.vbo, &MsdfGlyph::transformIndex, true);
+	return batch;
+}
+
 static void textQueueV(Font& font, float size, vec3 pos, vec3 dir, vec3 up,
 	color4 color, const char* fmt, va_list args)
 {
@@ -82,11 +110,8 @@ static void textQueueV(Font& font, float size, vec3 pos, vec3 dir, vec3 up,
 			&glyphCount);
 		vec2 cursor {0};
 		for (size_t i = 0; i < glyphCount; i += 1) {
-			auto& glyph = msdfGlyphs.emplace_back();
-
 			// Calculate glyph information
 			size_t id = glyphInfo[i].codepoint;
-			Font::Glyph* atlasChar = &font.metrics[id];
 			vec2 offset = {
 				glyphPos[i].x_offset / 1024.0f,
 				glyphPos[i].y_offset / 1024.0f
@@ -94,19 +119,25 @@ static void textQueueV(Font& font, float size, vec3 pos, vec3 dir, vec3 up,
 			float xAdvance = glyphPos[i].x_advance / 1024.0f;
 			float yAdvance = glyphPos[i].y_advance / 1024.0f;
 
-			// Fill in draw data
-			glyph.position = cursor + offset + atlasChar->glyph.pos;
-			glyph.size = atlasChar->glyph.size;
-			glyph.texBounds.x =
-				atlasChar->msdf.pos.x / (float)font.atlas.size.x;
-			glyph.texBounds.y =
-				atlasChar->msdf.pos.y / (float)font.atlas.size.y;
-			glyph.texBounds.z =
-				atlasChar->msdf.size.x / (float)font.atlas.size.x;
-			glyph.texBounds.w =
-				atlasChar->msdf.size.y / (float)font.atlas.size.y;
-			glyph.color = color;
-			glyph.transformIndex = msdfTransforms.size() - 1;
+			// Glyphs still being generated are skipped, but keep their space
+			if (Font::Glyph const* atlasChar = font.getGlyph(id)) {
+				auto& atlas = font.atlasOf(*atlasChar);
+				auto& glyph = msdfBatchFor(atlas).glyphs.emplace_back();
+
+				// Fill in draw data
+				glyph.position = cursor + offset + atlasChar->glyph.pos;
+				glyph.size = atlasChar->glyph.size;
+				glyph.texBounds.x =
+					atlasChar->msdf.pos.x / (float)atlas.size.x;
+				glyph.texBounds.y =
+					atlasChar->msdf.pos.y / (float)atlas.size.y;
+				glyph.texBounds.z =
+					atlasChar->msdf.size.x / (float)atlas.size.x;
+				glyph.texBounds.w =
+					atlasChar->msdf.size.y / (float)atlas.size.y;
+				glyph.color = color;
+				glyph.transformIndex = msdfTransforms.size() - 1;
+			}
 
 			// Advance position
 			cursor.x += xAdvance;
@@ -115,24 +146,14 @@ static void textQueueV(Font& font, float size, vec3 pos, vec3 dir, vec3 up,
 	} while(false);
 
 	hb_buffer_destroy(text);
-
-	msdfFont = &font;
 }
 
 void textInit(void)
 {
 	if (initialized) return;
 
-	msdfGlyphsVbo.create("msdfGlyphVbo", true);
-	msdfVao.create("msdfVao");
 	msdfTransformsTex.create("msdfTransformTex", true);
 
-	msdfVao.setAttribute(0, msdfGlyphsVbo, &MsdfGlyph::position, true);
-	msdfVao.setAttribute(1, msdfGlyphsVbo, &MsdfGlyph::size, true);
-	msdfVao.setAttribute(2, msdfGlyphsVbo, &MsdfGlyph::texBounds, true);
-	msdfVao.setAttribute(3, msdfGlyphsVbo, &MsdfGlyph::color, true);
-	msdfVao.setAttribute(4, msdfGlyphsVbo, &MsdfGlyph::transformIndex, true);
-
 	initialized = true;
 }
 
@@ -141,8 +162,12 @@ void textCleanup(void)
 	if (!initialized) return;
 
 	msdfTransformsTex.destroy();
-	msdfGlyphsVbo.destroy();
-	msdfVao.destroy();
+	for (auto& batch: msdfBatches) {
+		batch.vbo.destroy();
+		batch.vao.destroy();
+	}
+	msdfBatches.clear();
+	msdfTransforms.clear();
 
 	initialized = false;
 }
@@ -175,21 +200,28 @@ void textDraw(Engine& engine)
 {
 	ASSERT(initialized);
 
-	if (!msdfGlyphs.size()) return;
+	if (msdfTransforms.empty()) return;
 
-	msdfGlyphsVbo.upload(msdfGlyphs);
 	msdfTransformsTex.upload(msdfTransforms);
 
 	msdf.shader = &engine.shaders.msdf;
-	msdf.vertexarray = &msdfVao;
 	msdf.framebuffer = engine.frame.fb;
-	msdf.instances = msdfGlyphs.size();
-	msdf.shader->atlas = msdfFont->atlas;
 	msdf.shader->transforms = msdfTransformsTex;
 	msdf.shader->projection = engine.scene.projection;
 	msdf.shader->view = engine.scene.view;
-	msdf.draw();
 
-	msdfGlyphs.clear();
+	// One instanced draw per atlas; the transform buffer is shared
+	for (auto& batch: msdfBatches) {
+		if (batch.glyphs.empty()) continue;
+
+		batch.vbo.upload(batch.glyphs);
+		msdf.vertexarray = &batch.vao;
+		msdf.instances = batch.glyphs.size();
+		msdf.shader->atlas = *batch.atlas;
+		msdf.draw();
+
+		batch.glyphs.clear();
+	}
+
 	msdfTransforms.clear();
 }
@@ -51,7 +51,8 @@ void textQueueDir(minote::Font& font, float size, minote::vec3 pos, minote::vec3
 	minote::color4 color, const char* fmt, ...);
 
 /**
- * Render all queued strings on the screen, with as few draw calls as possible.
+ * Render all queued strings on the screen, with one draw call per font atlas
+ * in use. Strings of different fonts can be freely mixed within a frame.
  */
 void textDraw(minote::Engine& engine);
 
@@ -0,0 +1,114 @@
+/**
+ * External tool that packs an msdf-atlas-gen atlas and its metrics into
+ * a single binary file, to be memory-mapped by the game
+ * @file
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include <cstdio>
+#include <vector>
+#include "stb/stb_image.h"
+#include "engine/fontpack.hpp"
+
+using namespace minote;
+
+auto alignUp(size_t const offset) -> size_t
+{
+	return (offset + FontpackAlignment - 1) / FontpackAlignment * FontpackAlignment;
+}
+
+void writeAt(std::FILE* const output, size_t const offset,
+	void const* const data, size_t const size, char const* const filename)
+{
+	if (std::fseek(output, offset, SEEK_SET) != 0 ||
+		std::fwrite(data, 1, size, output) != size) {
+		std::fprintf(stderr, "Could not write to %s: %s\n",
+			filename, std::strerror(errno));
+		std::exit(EXIT_FAILURE);
+	}
+}
+
+auto main(int argc, char* argv[]) -> int
+{
+	if (argc != 4) {
+		std::puts("fontpack - packs an MSDF atlas and its metrics into a binary font file");
+		std::puts("Usage: fontpack atlas.png metrics.csv outputFile");
+		std::exit(EXIT_SUCCESS);
+	}
+
+	// Load the atlas, flipped to match OpenGL's bottom-up rows
+	int width = 0;
+	int height = 0;
+	int channels = 0;
+	stbi_set_flip_vertically_on_load(true);
+	u8* const atlas = stbi_load(argv[1], &width, &height, &channels, 0);
+	if (!atlas) {
+		std::fprintf(stderr, "Could not load atlas %s: %s\n",
+			argv[1], stbi_failure_reason());
+		std::exit(EXIT_FAILURE);
+	}
+
+	// Parse the metrics, converting bounds to position and size
+	std::FILE* const metricsFile{std::fopen(argv[2], "r")};
+	if (!metricsFile) {
+		std::fprintf(stderr, "Could not open %s for reading: %s\n",
+			argv[2], std::strerror(errno));
+		std::exit(EXIT_FAILURE);
+	}
+	std::vector<FontpackGlyph> glyphs;
+	while (true) {
+		int index = 0;
+		FontpackGlyph glyph = {};
+		int parsed = std::fscanf(metricsFile, "%d,%*f,%f,%f,%f,%f,%f,%f,%f,%f\n",
+			&index,
+			&glyph.glyph[0], &glyph.glyph[1], &glyph.glyph[2], &glyph.glyph[3],
+			&glyph.msdf[0], &glyph.msdf[1], &glyph.msdf[2], &glyph.msdf[3]);
+		if (parsed == 0 || parsed == EOF) break;
+		if (parsed != 9 || index < 0) {
+			std::fprintf(stderr, "Syntax error in %s\n", argv[2]);
+			std::exit(EXIT_FAILURE);
+		}
+		glyph.glyph[2] -= glyph.glyph[0];
+		glyph.glyph[3] -= glyph.glyph[1];
+		glyph.msdf[2] -= glyph.msdf[0];
+		glyph.msdf[3] -= glyph.msdf[1];
+		glyph.baked = 1;
+
+		if (static_cast<size_t>(index) >= glyphs.size())
+			glyphs.resize(index + 1);
+		glyphs[index] = glyph;
+	}
+	std::fclose(metricsFile);
+
+	// Write out the sections
+	FontpackHeader header = {};
+	header.magic = FontpackMagic;
+	header.version = FontpackVersion;
+	header.glyphCount = glyphs.size();
+	header.atlasWidth = width;
+	header.atlasHeight = height;
+	header.atlasChannels = channels;
+	header.metricsOffset = alignUp(sizeof(header));
+	header.atlasOffset = alignUp(header.metricsOffset +
+		glyphs.size() * sizeof(FontpackGlyph));
+
+	std::FILE* const output{std::fopen(argv[3], "wb")};
+	if (!output) {
+		std::fprintf(stderr, "Could not open %s for writing: %s\n",
+			argv[3], std::strerror(errno));
+		std::exit(EXIT_FAILURE);
+	}
+	writeAt(output, 0, &header, sizeof(header), argv[3]);
+	writeAt(output, header.metricsOffset, glyphs.data(),
+		glyphs.size() * sizeof(FontpackGlyph), argv[3]);
+	writeAt(output, header.atlasOffset, atlas,
+		size_t(width) * height * channels, argv[3]);
+
+	if (std::fclose(output) != 0) {
+		std::fprintf(stderr, "Could not write to %s: %s\n",
+			argv[3], std::strerror(errno));
+		std::exit(EXIT_FAILURE);
+	}
+	stbi_image_free(atlas);
+}
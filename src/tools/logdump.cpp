@@ -0,0 +1,211 @@
+/**
+ * External tool that converts a binary trace file written by the logger
+ * into readable text, in the same format as the regular logfile
+ * @file
+ */
+
+#include <unordered_map>
+#include <string_view>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <ctime>
+#include <fmt/format.h>
+#include <fmt/chrono.h>
+#include <fmt/args.h>
+#include "base/tracelog.hpp"
+
+using namespace minote;
+
+/// Names of log levels, aligned to 5 characters. Must match Log::Level
+constexpr char const* LevelNames[] = {
+	"", "TRACE", "DEBUG", " INFO", " WARN", "ERROR", " CRIT"
+};
+
+/// A format defined in the trace file
+struct Format {
+	std::string str;
+	std::vector<TracelogArg> args;
+};
+
+/**
+ * Read an entire file into a string. Exits on error.
+ */
+auto readFile(char const* const filename) -> std::string
+{
+	std::FILE* const input{std::fopen(filename, "rb")};
+	if (!input) {
+		std::fprintf(stderr, "Could not open %s for reading: %s\n",
+			filename, std::strerror(errno));
+		std::exit(EXIT_FAILURE);
+	}
+
+	std::string result;
+	char buffer[4096];
+	size_t read;
+	while ((read = std::fread(buffer, 1, sizeof(buffer), input)))
+		result.append(buffer, read);
+	if (std::ferror(input)) {
+		std::fprintf(stderr, "Could not read %s: %s\n",
+			filename, std::strerror(errno));
+		std::exit(EXIT_FAILURE);
+	}
+	std::fclose(input);
+	return result;
+}
+
+/**
+ * Remove a value of type T from the front of a byte range.
+ * @return false if there are not enough bytes left
+ */
+template<typename T>
+auto take(std::string_view& bytes, T& value) -> bool
+{
+	if (bytes.size() < sizeof(T)) return false;
+	std::memcpy(&value, bytes.data(), sizeof(T));
+	bytes.remove_prefix(sizeof(T));
+	return true;
+}
+
+/**
+ * Parse the payload of a definition record.
+ * @return false if the payload is malformed
+ */
+auto parseDefinition(std::string_view payload, u32& id, Format& format) -> bool
+{
+	u8 count;
+	if (!take(payload, id) || !take(payload, count) || payload.size() < count)
+		return false;
+	format.args.resize(count);
+	for (size_t i = 0; i < count; i += 1)
+		format.args[i] = TracelogArg(payload[i]);
+	payload.remove_prefix(count);
+	format.str = payload;
+	return true;
+}
+
+/**
+ * Format a message from its arguments.
+ * @return false if the arguments are malformed
+ */
+auto formatMessage(std::string_view payload, Format const& format, std::string& result) -> bool
+{
+	fmt::dynamic_format_arg_store<fmt::format_context> store;
+	for (auto const type: format.args) {
+		bool valid = false;
+		auto const push = [&]<typename T>(T value) {
+			valid = take(payload, value);
+			if (valid)
+				store.push_back(value);
+		};
+
+		switch (type) {
+		case TracelogArg::Bool: push(bool()); break;
+		case TracelogArg::Char: push(char()); break;
+		case TracelogArg::I32: push(i32()); break;
+		case TracelogArg::U32: push(u32()); break;
+		case TracelogArg::I64: push(i64()); break;
+		case TracelogArg::U64: push(u64()); break;
+		case TracelogArg::F32: push(f32()); break;
+		case TracelogArg::F64: push(f64()); break;
+		case TracelogArg::String: {
+			u16 length;
+			if (!take(payload, length) || payload.size() < length) break;
+			store.push_back(std::string(payload.substr(0, length)));
+			payload.remove_prefix(length);
+			valid = true;
+			break;
+		}
+		default:
+			break;
+		}
+		if (!valid) return false;
+	}
+
+	try {
+		result = fmt::vformat(format.str, store);
+	} catch (fmt::format_error const& e) {
+		result = fmt::format("<{}: \"{}\">", e.what(), format.str);
+	}
+	return true;
+}
+
+auto main(int argc, char* argv[]) -> int
+{
+	if (argc != 2 && argc != 3) {
+		std::puts("minote-logdump - converts a binary trace file into a readable log");
+		std::puts("Usage: minote-logdump input.trace [outputFile]");
+		std::puts("Without an output file, the log is printed to stdout.");
+		std::exit(EXIT_SUCCESS);
+	}
+	char const* const inputPath{argv[1]};
+	char const* const outputPath{argc == 3? argv[2] : nullptr};
+
+	auto const source{readFile(inputPath)};
+	std::string_view bytes{source};
+	TracelogHeader header;
+	if (!take(bytes, header) || header.magic != TracelogMagic) {
+		std::fprintf(stderr, "%s is not a trace file\n", inputPath);
+		std::exit(EXIT_FAILURE);
+	}
+	if (header.version != TracelogVersion) {
+		std::fprintf(stderr, "%s is of version %u, expected %u\n",
+			inputPath, header.version, TracelogVersion);
+		std::exit(EXIT_FAILURE);
+	}
+
+	std::FILE* const output{outputPath? std::fopen(outputPath, "w") : stdout};
+	if (!output) {
+		std::fprintf(stderr, "Could not open %s for writing: %s\n",
+			outputPath, std::strerror(errno));
+		std::exit(EXIT_FAILURE);
+	}
+
+	std::unordered_map<u32, Format> formats;
+	std::string message;
+	size_t messages = 0;
+	while (!bytes.empty()) {
+		TracelogRecord record;
+		if (!take(bytes, record) || bytes.size() < record.size) {
+			std::fprintf(stderr, "Warning: %s is truncated\n", inputPath);
+			break;
+		}
+		auto const payload{bytes.substr(0, record.size)};
+		bytes.remove_prefix(record.size);
+
+		if (record.format == TracelogDefinition) {
+			u32 id;
+			Format format;
+			if (!parseDefinition(payload, id, format)) {
+				std::fprintf(stderr, "Warning: malformed format definition\n");
+				continue;
+			}
+			formats.insert_or_assign(id, std::move(format));
+			continue;
+		}
+
+		auto const format{formats.find(record.format)};
+		if (format == formats.end()) {
+			message = fmt::format("<undefined format {:08x}>", record.format);
+		} else if (!formatMessage(payload, format->second, message)) {
+			message = fmt::format("<malformed arguments: \"{}\">", format->second.str);
+		}
+
+		auto const seconds{std::time_t(record.time / 1'000'000'000)};
+		auto const millis{(record.time / 1'000'000) % 1000};
+		auto const level{record.level < std::size(LevelNames)? LevelNames[record.level] : "?????"};
+		fmt::print(output, "{:%H:%M:%S}.{:03} [{}] {}\n",
+			fmt::localtime(seconds), millis, level, message);
+		messages += 1;
+	}
+
+	if (outputPath && std::fclose(output) != 0) {
+		std::fprintf(stderr, "Could not write to %s: %s\n",
+			outputPath, std::strerror(errno));
+		std::exit(EXIT_FAILURE);
+	}
+	std::fprintf(stderr, "Decoded %zu messages with %zu formats\n", messages, formats.size());
+}
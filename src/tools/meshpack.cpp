@@ -0,0 +1,238 @@
+/**
+ * External tool that converts a Wavefront OBJ model into the binary mesh
+ * format, with vertices deduplicated and triangles ordered for the vertex
+ * cache, to be memory-mapped by the game
+ * @file
+ */
+
+#include <string_view>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "engine/meshpack.hpp"
+#include "engine/mesh.hpp"
+
+using namespace minote;
+
+/// Position and color of an OBJ vertex
+struct ObjVertex {
+	f32 pos[3];
+	f32 color[4];
+};
+
+/// A normal of an OBJ vertex
+struct ObjNormal {
+	f32 dir[3];
+};
+
+auto alignUp(size_t const offset) -> size_t
+{
+	return (offset + MeshpackAlignment - 1) / MeshpackAlignment * MeshpackAlignment;
+}
+
+void writeAt(std::FILE* const output, size_t const offset,
+	void const* const data, size_t const size, char const* const filename)
+{
+	if (std::fseek(output, offset, SEEK_SET) != 0 ||
+		std::fwrite(data, 1, size, output) != size) {
+		std::fprintf(stderr, "Could not write to %s: %s\n",
+			filename, std::strerror(errno));
+		std::exit(EXIT_FAILURE);
+	}
+}
+
+/**
+ * Read an entire file into a string. Exits on error.
+ */
+auto readFile(char const* const filename) -> std::string
+{
+	std::FILE* const input{std::fopen(filename, "rb")};
+	if (!input) {
+		std::fprintf(stderr, "Could not open %s for reading: %s\n",
+			filename, std::strerror(errno));
+		std::exit(EXIT_FAILURE);
+	}
+
+	std::string result;
+	char buffer[4096];
+	size_t read;
+	while ((read = std::fread(buffer, 1, sizeof(buffer), input)))
+		result.append(buffer, read);
+	if (std::ferror(input)) {
+		std::fprintf(stderr, "Could not read %s: %s\n",
+			filename, std::strerror(errno));
+		std::exit(EXIT_FAILURE);
+	}
+	std::fclose(input);
+	return result;
+}
+
+/**
+ * Resolve a 1-based or negative (relative to the end) OBJ index.
+ * @return 0-based index, or -1 if out of range
+ */
+auto resolveIndex(long const index, size_t const count) -> long
+{
+	if (index > 0 && size_t(index) <= count)
+		return index - 1;
+	if (index < 0 && size_t(-index) <= count)
+		return long(count) + index;
+	return -1;
+}
+
+auto main(int argc, char* argv[]) -> int
+{
+	if (argc != 3) {
+		std::puts("meshpack - converts a Wavefront OBJ model into a binary mesh file");
+		std::puts("Usage: meshpack input.obj outputFile");
+		std::puts("Vertex colors are read from \"v x y z r g b [a]\" lines. Faces without");
+		std::puts("normals are stored with a zero normal, for unlit models. At most 65536");
+		std::puts("unique vertices are supported.");
+		std::exit(EXIT_SUCCESS);
+	}
+	char const* const inputPath{argv[1]};
+	char const* const outputPath{argv[2]};
+
+	auto const syntaxError = [=](size_t const line) {
+		std::fprintf(stderr, "Syntax error in %s on line %zu\n", inputPath, line);
+		std::exit(EXIT_FAILURE);
+	};
+
+	// Parse the OBJ into a triangle list
+	std::string const source{readFile(inputPath)};
+	std::vector<ObjVertex> positions;
+	std::vector<ObjNormal> normals;
+	std::vector<MeshpackVertex> triangles;
+	std::vector<MeshpackVertex> polygon;
+	std::string_view remaining{source};
+	for (size_t lineNum = 1; !remaining.empty(); lineNum += 1) {
+		auto const lineEnd{remaining.find('\n')};
+		std::string const line{remaining.substr(0, lineEnd)};
+		remaining.remove_prefix(lineEnd == std::string_view::npos?
+			remaining.size() : lineEnd + 1);
+
+		char const* cursor{line.c_str()};
+		char* end{nullptr};
+		auto const parseFloats = [&](f32* const out, int const max) -> int {
+			int parsed = 0;
+			while (parsed < max) {
+				f32 const value = std::strtof(cursor, &end);
+				if (end == cursor) break;
+				out[parsed] = value;
+				parsed += 1;
+				cursor = end;
+			}
+			return parsed;
+		};
+
+		if (line.starts_with("v ")) {
+			cursor += 2;
+			ObjVertex vertex = {.pos = {}, .color = {1.0f, 1.0f, 1.0f, 1.0f}};
+			f32 values[7];
+			int const parsed = parseFloats(values, 7);
+			if (parsed != 3 && parsed != 6 && parsed != 7)
+				syntaxError(lineNum);
+			std::memcpy(vertex.pos, values, sizeof(vertex.pos));
+			if (parsed > 3)
+				std::memcpy(vertex.color, values + 3, sizeof(f32) * (parsed - 3));
+			positions.push_back(vertex);
+		} else if (line.starts_with("vn ")) {
+			cursor += 3;
+			ObjNormal normal = {};
+			if (parseFloats(normal.dir, 3) != 3)
+				syntaxError(lineNum);
+			normals.push_back(normal);
+		} else if (line.starts_with("f ")) {
+			cursor += 2;
+			polygon.clear();
+			while (true) {
+				long const v = std::strtol(cursor, &end, 10);
+				if (end == cursor) break;
+				cursor = end;
+				long vn = 0;
+				if (*cursor == '/') {
+					cursor += 1;
+					std::strtol(cursor, &end, 10); // Texture coordinates are ignored
+					cursor = end;
+					if (*cursor == '/') {
+						cursor += 1;
+						vn = std::strtol(cursor, &end, 10);
+						if (end == cursor)
+							syntaxError(lineNum);
+						cursor = end;
+					}
+				}
+
+				long const position = resolveIndex(v, positions.size());
+				long const normal = vn? resolveIndex(vn, normals.size()) : 0;
+				if (position < 0 || normal < 0)
+					syntaxError(lineNum);
+				auto const& pos = positions[position];
+				MeshpackVertex vertex = {
+					.pos = {packHalf(pos.pos[0]), packHalf(pos.pos[1]),
+						packHalf(pos.pos[2]), packHalf(1.0f)},
+					.normal = 0,
+					.color = {packUnorm8(pos.color[0]), packUnorm8(pos.color[1]),
+						packUnorm8(pos.color[2]), packUnorm8(pos.color[3])}};
+				if (vn) {
+					auto const& dir = normals[normal].dir;
+					vertex.normal = packNormal(dir[0], dir[1], dir[2]);
+				}
+				polygon.push_back(vertex);
+			}
+			if (polygon.size() < 3)
+				syntaxError(lineNum);
+
+			// Triangulate as a fan
+			for (size_t i = 2; i < polygon.size(); i += 1) {
+				triangles.push_back(polygon[0]);
+				triangles.push_back(polygon[i - 1]);
+				triangles.push_back(polygon[i]);
+			}
+		}
+		// Other statements (comments, groups, materials, texture coordinates)
+		// are ignored
+	}
+
+	// Convert to an optimized indexed mesh
+	std::vector<MeshpackVertex> vertices;
+	std::vector<MeshIndex> indices;
+	weldVertices<MeshpackVertex>(triangles, vertices, indices);
+	f32 const acmrBefore = vertexCacheACMR(indices);
+	optimizeVertexCache(indices, vertices.size());
+	f32 const acmrAfter = vertexCacheACMR(indices);
+	std::printf("%s: %zu triangles, %zu vertices welded into %zu, ACMR %.3f -> %.3f\n",
+		inputPath, indices.size() / 3, triangles.size(), vertices.size(),
+		acmrBefore, acmrAfter);
+
+	// Write out the sections
+	MeshpackHeader header = {};
+	header.magic = MeshpackMagic;
+	header.version = MeshpackVersion;
+	header.vertexCount = vertices.size();
+	header.indexCount = indices.size();
+	header.vertexOffset = alignUp(sizeof(header));
+	header.indexOffset = alignUp(header.vertexOffset +
+		vertices.size() * sizeof(MeshpackVertex));
+
+	std::FILE* const output{std::fopen(outputPath, "wb")};
+	if (!output) {
+		std::fprintf(stderr, "Could not open %s for writing: %s\n",
+			outputPath, std::strerror(errno));
+		std::exit(EXIT_FAILURE);
+	}
+	writeAt(output, 0, &header, sizeof(header), outputPath);
+	writeAt(output, header.vertexOffset, vertices.data(),
+		vertices.size() * sizeof(MeshpackVertex), outputPath);
+	writeAt(output, header.indexOffset, indices.data(),
+		indices.size() * sizeof(MeshIndex), outputPath);
+
+	if (std::fclose(output) != 0) {
+		std::fprintf(stderr, "Could not write to %s: %s\n",
+			outputPath, std::strerror(errno));
+		std::exit(EXIT_FAILURE);
+	}
+}
@@ -6,131 +6,219 @@
 
 #include <algorithm>
 #include <cstdlib>
+#include <cerrno>
 #include <cstring>
 #include <cstdio>
 #include <cctype>
+#include <string_view>
+#include <exception>
+#include <string>
+#include "store/shaderinclude.hpp"
+
+/// Raw string delimiter of the output. The shader source must not contain
+/// the closing sequence )glsl"
+#define DELIMITER "glsl"
+
+/// Maximum length of a single string literal piece. MSVC refuses literals
+/// longer than 16k, so the output is split into adjacent literals
+constexpr std::size_t ChunkSize{4096};
+
+/// Run options
+struct Options {
+	bool strip{false}; ///< Remove comments and redundant whitespace
+	char const* depfile{nullptr}; ///< Path to write the dependency list to
+	char const* input{nullptr};
+	char const* output{nullptr};
+};
+
+/// State of preprocessing a single shader
+struct Context {
+	Options const* options{nullptr};
+	minote::ShaderSource source; ///< Expanded shader source and every file read
+	bool inComment{false}; ///< Inside a /* */ comment, for strip mode
+};
 
-// https://stackoverflow.com/a/122974
-auto trim(char* str) -> char*
+/**
+ * Remove comments from a line and collapse runs of whitespace into single
+ * spaces. GLSL has no string literals, so this is safe to do blindly.
+ * @param ctx Preprocessing context, tracks multiline comments
+ * @param line Trimmed input line
+ * @return Minified line, possibly empty
+ */
+auto stripLine(Context& ctx, std::string_view const line) -> std::string
 {
-	if (!str) { return nullptr; }
-	if (!str[0]) { return str; }
-
-	size_t len{std::strlen(str)};
-	char* frontp{str};
-	char* endp{str + len};
-
-	/* Move the front and back pointers to address the first non-whitespace
-	 * characters from each end. */
-	while (std::isspace(static_cast<unsigned char>(*frontp))) { ++frontp; }
-	if (endp != frontp)
-		while (std::isspace(static_cast<unsigned char>(*(--endp)))
-			&& endp != frontp) {}
-
-	if (frontp != str && endp == frontp)
-		*str = '\0';
-	else if (str + len - 1 != endp)
-		*(endp + 1) = '\0';
-
-	/* Shift the string so that it starts at str so that if it's dynamically
-	 * allocated, we can still free it on the returned pointer.  Note the reuse
-	 * of endp to mean the front of the string buffer now.
-	 */
-	endp = str;
-	if (frontp != str) {
-		while (*frontp) { *endp++ = *frontp++; }
-		*endp = '\0';
+	std::string result;
+	bool pendingSpace{false};
+	for (std::size_t i = 0; i < line.size(); i += 1) {
+		if (ctx.inComment) {
+			if (line.substr(i, 2) == "*/") {
+				ctx.inComment = false;
+				pendingSpace = true;
+				i += 1;
+			}
+			continue;
+		}
+		if (line.substr(i, 2) == "//")
+			break;
+		if (line.substr(i, 2) == "/*") {
+			ctx.inComment = true;
+			i += 1;
+			continue;
+		}
+		if (std::isspace(static_cast<unsigned char>(line[i]))) {
+			pendingSpace = true;
+			continue;
+		}
+		if (pendingSpace && !result.empty())
+			result += ' ';
+		pendingSpace = false;
+		result += line[i];
 	}
+	return result;
+}
 
-	return str;
+/**
+ * Remove comments and redundant whitespace from the whole expanded source.
+ * @param ctx Preprocessing context
+ */
+void stripSource(Context& ctx)
+{
+	std::string result;
+	std::string_view remaining{ctx.source.text};
+	while (!remaining.empty()) {
+		auto const lineEnd{remaining.find('\n')};
+		auto const line{remaining.substr(0, lineEnd)};
+		remaining.remove_prefix(lineEnd == std::string_view::npos?
+			remaining.size() : lineEnd + 1);
+
+		auto const stripped{stripLine(ctx, line)};
+		if (stripped.empty()) continue;
+		result += stripped;
+		result += '\n';
+	}
+	ctx.source.text = std::move(result);
 }
 
-void fileProcess(const char* const filename, const char* const basedir,
-	FILE* const output)
+/**
+ * Write the shader source as a sequence of adjacent raw string literals,
+ * split on line boundaries.
+ * @return true on success, false on write error
+ */
+auto writeSource(Context const& ctx, std::FILE* const output) -> bool
 {
-	std::FILE* input{std::fopen(filename, "r")};
-	if (!input) {
-		std::fprintf(stderr, "Could not open %s for reading: %s\n",
-			filename, std::strerror(errno));
-		std::exit(EXIT_FAILURE);
+	std::string_view remaining{ctx.source.text};
+	while (!remaining.empty()) {
+		auto length{std::min(remaining.size(), ChunkSize)};
+		if (length < remaining.size()) {
+			auto const lineEnd{remaining.rfind('\n', length - 1)};
+			if (lineEnd != std::string_view::npos)
+				length = lineEnd + 1;
+		}
+		if (std::fprintf(output, "R\"" DELIMITER "(%.*s)" DELIMITER "\"\n",
+			int(length), remaining.data()) < 0)
+			return false;
+		remaining.remove_prefix(length);
 	}
+	return true;
+}
 
-	char line[256]{""};
-	while (std::fgets(line, 256, input)) {
-		if (line[std::strlen(line) - 1] != '\n') {
-			std::fprintf(stderr, "Line longer than 256 chars, aborting\n");
-			std::exit(EXIT_FAILURE);
+/**
+ * Write a Makefile-style depfile listing every file the output depends on.
+ * @return true on success, false on write error
+ */
+auto writeDepfile(Context const& ctx) -> bool
+{
+	std::FILE* depfile{std::fopen(ctx.options->depfile, "w")};
+	if (!depfile) return false;
+
+	auto const escaped = [](std::string const& path) {
+		std::string result;
+		for (char const ch: path) {
+			if (ch == ' ' || ch == '#') result += '\\';
+			if (ch == '$') result += '$';
+			result += ch;
 		}
-		trim(line);
-		if (std::strncmp(line, "#include", std::strlen("#include")) == 0 &&
-			!std::isalnum(line[std::strlen("#include")]) &&
-			line[std::strlen("#include")] != '_') {
-			// Is an #include directive
-			char includeFile[256]{""};
-			if (!std::sscanf(line, "#include \"%s", includeFile)) {
-				std::fprintf(stderr, "Syntax error in #include line: %s", line);
-				std::exit(EXIT_FAILURE);
-			}
-			if (includeFile[std::strlen(includeFile) - 1] != '"') {
-				std::fprintf(stderr, "Syntax error in #include line: %s", line);
-				std::exit(EXIT_FAILURE);
-			}
-			includeFile[std::strlen(includeFile) - 1] = '\0';
+		return result;
+	};
 
-			char includePath[256]{""};
-			std::snprintf(includePath, 256, "%s/%s", basedir, includeFile);
+	std::fprintf(depfile, "%s:", escaped(ctx.options->output).c_str());
+	for (auto const& file: ctx.source.files)
+		std::fprintf(depfile, " \\\n  %s", escaped(file.string()).c_str());
+	std::fprintf(depfile, "\n");
+
+	bool const failed{std::ferror(depfile) != 0};
+	return !(std::fclose(depfile) || failed);
+}
 
-			fileProcess(includePath, basedir, output);
+/**
+ * Parse the command line. Exits on error.
+ */
+auto parseOptions(int argc, char* argv[]) -> Options
+{
+	Options options;
+	for (int i = 1; i < argc; i += 1) {
+		if (std::strcmp(argv[i], "--strip") == 0) {
+			options.strip = true;
+		} else if (std::strcmp(argv[i], "--depfile") == 0 && i + 1 < argc) {
+			i += 1;
+			options.depfile = argv[i];
+		} else if (!options.input) {
+			options.input = argv[i];
+		} else if (!options.output) {
+			options.output = argv[i];
 		} else {
-			// Is a normal line
-			std::size_t chCount = 0;
-			for (std::size_t i = 0; i < std::strlen(line); i += 1) {
-				// Go to a new line after 8 chars
-				if (chCount == 8) {
-					std::fprintf(output, "\n");
-					chCount = 0;
-				}
-				chCount += 1;
-
-				// Do the thing
-				std::fprintf(output, "0x%02hhx, ",
-					static_cast<unsigned char>(line[i]));
-			}
-			std::fprintf(output, "0x%02x,\n", '\n');
+			options.input = nullptr; // Too many arguments, show usage
+			break;
 		}
 	}
 
-	std::fclose(input);
-}
-
-void dirname(const char* const path, const std::size_t dstsize, char* const dst)
-{
-	char* slashPtr{std::strrchr(path, '/')};
-	if (!slashPtr) return;
-	std::ptrdiff_t slashIndex{slashPtr - path};
-	std::strncpy(dst, path,
-		std::min(static_cast<std::size_t>(slashIndex), dstsize));
+	if (!options.input || !options.output) {
+		std::puts("preshade - preprocesses shaders so that they can be included in the source");
+		std::puts("Usage: preshade [--strip] [--depfile depFile] inputFile outputFile");
+		std::puts("  --strip    remove comments and redundant whitespace");
+		std::puts("  --depfile  write the list of included files to depFile");
+		std::exit(EXIT_SUCCESS);
+	}
+	return options;
 }
 
 auto main(int argc, char* argv[]) -> int
 {
-	if (argc != 3) {
-		std::puts("preshade - preprocesses shaders so that they can be included in the source");
-		std::puts("Usage: preshade inputFile outputFile");
-		std::exit(EXIT_SUCCESS);
+	Options const options{parseOptions(argc, argv)};
+
+	Context ctx;
+	ctx.options = &options;
+	try {
+		ctx.source = minote::expandShaderIncludes(options.input);
+	} catch (std::exception const& e) {
+		std::fprintf(stderr, "%s\n", e.what());
+		std::exit(EXIT_FAILURE);
+	}
+	if (options.strip)
+		stripSource(ctx);
+
+	if (ctx.source.text.find(")" DELIMITER "\"") != std::string::npos) {
+		std::fprintf(stderr, "%s contains the raw string delimiter )" DELIMITER "\"\n",
+			options.input);
+		std::exit(EXIT_FAILURE);
 	}
 
-	FILE* output{std::fopen(argv[2], "w")};
+	FILE* output{std::fopen(options.output, "w")};
 	if (!output) {
 		std::fprintf(stderr, "Could not open %s for writing: %s\n",
-			argv[2], std::strerror(errno));
+			options.output, std::strerror(errno));
+		std::exit(EXIT_FAILURE);
+	}
+	bool const written{writeSource(ctx, output)};
+	if (std::fclose(output) || !written) {
+		std::fprintf(stderr, "Could not write %s: %s\n",
+			options.output, std::strerror(errno));
 		std::exit(EXIT_FAILURE);
 	}
 
-	char basedir[256]{'\0'};
-	dirname(argv[1], 256, basedir);
-
-	fileProcess(argv[1], basedir, output);
-
-	std::fclose(output);
+	if (options.depfile && !writeDepfile(ctx)) {
+		std::fprintf(stderr, "Could not write %s: %s\n",
+			options.depfile, std::strerror(errno));
+		std::exit(EXIT_FAILURE);
+	}
 }